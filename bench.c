@@ -0,0 +1,1303 @@
+/**
+ * @file bench.c
+ * @brief struct_print.h 性能测试程序（Linux）
+ * @author xingleixu@gmail.com
+ * @date 2025-10-18
+ *
+ * 测试内容：
+ *   字段格式化：内置格式化层 vs 旧的逐 token vsnprintf 路径（每字段周期数）
+ *   专用打印函数：STRUCT_DESC_SPECIALIZED 展开的打印函数 vs 通用描述符解释器
+ *   JSON 输出：NDJSON 记录吞吐量（记录/秒）
+ *   CBOR 编码：每条记录的字节数（对比文本/JSON）与编码耗时
+ *   描述符注册表：数千个类型时按名称/ID 查找（哈希表 vs 线性扫描）
+ *   描述符套件：test_structs.h 中的每个结构体及合成的大描述符（1000 字段、8 层嵌套），
+ *               分别输出到空 sink、内存 sink 和 FILE sink，统计每个结构体的耗时/字节数/sink 调用次数
+ *   批量打印：struct_print_batch_to vs 逐个 struct_print_to（每结构体耗时与 sink 调用次数）
+ *   模板缓存：STRUCT_PRINT_TEMPLATE_CACHE 开/关时每个描述符的耗时，并比较输出是否相同
+ *   性能统计（定义 BENCH_STATS 编译）：逐个打印与批量打印记入统计表的字节数是否等于实际输出
+ *
+ * 编译运行：
+ *   make bench
+ *   ./struct_bench results.json    （描述符套件结果另写为 NDJSON，每行一条，便于跨版本对比）
+ *   make bench-stats               （打开 STRUCT_PRINT_STATS_TABLE，只运行统计检查）
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+
+/* 模板缓存在运行时切换（NULL 表示不使用），见"模板缓存测试" */
+struct StructPrintTemplateCache_t;
+static struct StructPrintTemplateCache_t* g_bench_templates;
+
+#ifdef BENCH_STATS
+/* 性能统计版本：统计表见"性能统计检查" */
+extern struct StructPrintStatsTable_t g_bench_stats;
+static unsigned int bench_stats_time(void);
+#define STRUCT_PRINT_STATS_TABLE (&g_bench_stats)
+#define STRUCT_PRINT_STATS_TIME() bench_stats_time()
+#endif
+
+#define STRUCT_PRINT_ENABLE
+#define STRUCT_PRINT_TEMPLATE_CACHE g_bench_templates
+#include "struct_print.h"
+
+#include "test_structs.h"
+#include "test_structs_desc.h"
+
+/* ============================================================================
+ *                          计时工具
+ * ============================================================================ */
+
+/**
+ * @brief 读取单调时钟（纳秒）
+ */
+static double bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+#ifdef BENCH_STATS
+/**
+ * @brief 性能统计的时间戳（纳秒，按无符号差值计算间隔）
+ */
+static unsigned int bench_stats_time(void)
+{
+    return (unsigned int)(uint64_t)bench_now_ns();
+}
+#endif
+
+/**
+ * @brief 读取 CPU 周期计数器（x86 使用 rdtsc，其他平台返回 0）
+ * @note 在 Cortex-M 上可替换为 DWT->CYCCNT
+ */
+static uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* 防止编译器优化掉输出 */
+static volatile size_t g_bench_bytes;
+
+/**
+ * @brief 空输出回调：只统计字节数
+ */
+static void bench_null_flush(void* ctx, const char* data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    g_bench_bytes += len;
+}
+
+
+/* ============================================================================
+ *                    旧路径：每个 token 一次 vsnprintf
+ * ============================================================================ */
+
+/**
+ * @brief 模拟旧版 STRUCT_PRINT_PRINTF（典型 uart_printf 实现去掉发送部分）
+ */
+static void legacy_printf(const char* format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    g_bench_bytes += (size_t)vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+}
+
+/**
+ * @brief 旧版 print_hex_memory：每个字节一次 printf
+ */
+static void legacy_hex_memory(const u8* data, size_t length)
+{
+    size_t i;
+    size_t bytes_to_show = (length < STRUCT_PRINT_HEX_BYTES) ? length : STRUCT_PRINT_HEX_BYTES;
+
+    legacy_printf("        └─ Memory: ");
+    for (i = 0; i < bytes_to_show; i++) {
+        legacy_printf("%02X ", data[i]);
+    }
+    if (length > STRUCT_PRINT_HEX_BYTES) {
+        legacy_printf("...");
+    }
+    legacy_printf("\n");
+}
+
+/**
+ * @brief 旧版单字段打印路径（前缀 + 数值 + 十六进制内存）
+ */
+static void legacy_field(const FieldDescriptor* field, const void* base)
+{
+    const u8* addr = (const u8*)base + field->offset;
+
+    legacy_printf("  [+0x%04X] ", (unsigned int)field->offset);
+    legacy_printf("%s: ", field->name);
+
+    if (field->type == FIELD_TYPE_STRING) {
+        legacy_printf("\"%s\"\n", (const char*)addr);
+        legacy_hex_memory(addr, field->array_count);
+        return;
+    }
+
+    switch (field->type) {
+        case FIELD_TYPE_U8:
+            legacy_printf("%u (0x%02X)\n", *(const u8*)addr, *(const u8*)addr);
+            break;
+        case FIELD_TYPE_U16:
+            legacy_printf("%u (0x%04X)\n", *(const u16*)addr, *(const u16*)addr);
+            break;
+        case FIELD_TYPE_U32:
+            legacy_printf("%u (0x%08X)\n", (unsigned int)*(const u32*)addr, (unsigned int)*(const u32*)addr);
+            break;
+        case FIELD_TYPE_S16:
+            legacy_printf("%d (0x%04X)\n", *(const s16*)addr, *(const u16*)addr);
+            break;
+        case FIELD_TYPE_S32:
+            legacy_printf("%d (0x%08X)\n", (int)*(const s32*)addr, (unsigned int)*(const u32*)addr);
+            break;
+        case FIELD_TYPE_FLOAT:
+            legacy_printf("%.6f\n", *(const float*)addr);
+            break;
+        case FIELD_TYPE_DOUBLE:
+            legacy_printf("%.6f\n", *(const double*)addr);
+            break;
+        default:
+            break;
+    }
+    legacy_hex_memory(addr, field->size);
+}
+
+/**
+ * @brief 新路径单字段打印（与 struct_print_internal 中的字段循环一致）
+ */
+static void builtin_field(StructPrintContext* ctx, const FieldDescriptor* field, const void* base)
+{
+    sink_puts(ctx->sink, "  [+0x");
+    sink_put_hex(ctx->sink, (u32)field->offset, 4);
+    sink_puts(ctx->sink, "] ");
+    sink_puts(ctx->sink, field->name);
+    sink_puts(ctx->sink, ": ");
+    print_field_value(ctx, field, base, 0);
+}
+
+
+/* ============================================================================
+ *                          测试结构体
+ * ============================================================================ */
+
+typedef struct
+{
+    u8 u8_val;
+    u16 u16_val;
+    u32 u32_val;
+    s16 s16_val;
+    s32 s32_val;
+    float float_val;
+    double double_val;
+    u8 string_val[16];
+} BenchFields;
+
+BEGIN_STRUCT_DESC(BenchFields, BenchFields_desc)
+    FIELD_U8(BenchFields, u8_val),
+    FIELD_U16(BenchFields, u16_val),
+    FIELD_U32(BenchFields, u32_val),
+    FIELD_S16(BenchFields, s16_val),
+    FIELD_S32(BenchFields, s32_val),
+    FIELD_FLOAT(BenchFields, float_val),
+    FIELD_DOUBLE(BenchFields, double_val),
+    FIELD_STRING(BenchFields, string_val)
+END_STRUCT_DESC(BenchFields, BenchFields_desc)
+
+/* 同一结构体的专用打印版本 */
+#define BENCH_FIELDS_LIST(X, T) \
+    X(T, U8, u8_val) \
+    X(T, U16, u16_val) \
+    X(T, U32, u32_val) \
+    X(T, S16, s16_val) \
+    X(T, S32, s32_val) \
+    X(T, FLOAT, float_val) \
+    X(T, DOUBLE, double_val) \
+    X(T, STRING, string_val)
+
+STRUCT_DESC_SPECIALIZED(BenchFields, BenchFields_fast_desc, BENCH_FIELDS_LIST)
+
+
+/* ============================================================================
+ *                          字段格式化测试
+ * ============================================================================ */
+
+#define BENCH_FIELD_ITERATIONS  200000
+
+/**
+ * @brief 对比每种字段类型在新旧两条路径上的耗时
+ */
+static void bench_field_formatting(void)
+{
+    BenchFields data;
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    StructPrintSink sink;
+    StructPrintContext ctx;
+    size_t f;
+
+    data.u8_val = 200;
+    data.u16_val = 54321;
+    data.u32_val = 3000000000u;
+    data.s16_val = -12345;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    memset(data.string_val, 0, sizeof(data.string_val));
+    strcpy((char*)data.string_val, "862123456789012");
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_null_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+    struct_print_context_init(&ctx, &sink);
+
+    printf("字段格式化（每字段，含前缀与十六进制内存行，%d 次迭代）\n", BENCH_FIELD_ITERATIONS);
+    printf("%-12s %14s %14s %14s %14s %8s\n",
+           "field", "printf ns", "builtin ns", "printf cyc", "builtin cyc", "speedup");
+
+    for (f = 0; f < BenchFields_desc.field_count; f++) {
+        const FieldDescriptor* field = &BenchFields_desc.fields[f];
+        double t0, t1, t2;
+        uint64_t c0, c1, c2;
+        int i;
+
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        for (i = 0; i < BENCH_FIELD_ITERATIONS; i++) {
+            legacy_field(field, &data);
+        }
+        t1 = bench_now_ns();
+        c1 = bench_cycles();
+        for (i = 0; i < BENCH_FIELD_ITERATIONS; i++) {
+            builtin_field(&ctx, field, &data);
+        }
+        struct_print_sink_flush(&sink);
+        t2 = bench_now_ns();
+        c2 = bench_cycles();
+
+        printf("%-12s %14.1f %14.1f %14.1f %14.1f %7.2fx\n",
+               field->name,
+               (t1 - t0) / BENCH_FIELD_ITERATIONS,
+               (t2 - t1) / BENCH_FIELD_ITERATIONS,
+               (double)(c1 - c0) / BENCH_FIELD_ITERATIONS,
+               (double)(c2 - c1) / BENCH_FIELD_ITERATIONS,
+               (t1 - t0) / (t2 - t1));
+    }
+    printf("\n");
+}
+
+
+/* ============================================================================
+ *                          专用打印函数测试
+ * ============================================================================ */
+
+#define BENCH_STRUCT_ITERATIONS 50000
+#define BENCH_ROUNDS            10
+
+/* 捕获一次完整输出，用于校验两条路径结果一致 */
+static char g_capture[4096];
+static size_t g_capture_len;
+
+static void bench_capture_flush(void* ctx, const char* data, size_t len)
+{
+    (void)ctx;
+    if (g_capture_len + len <= sizeof(g_capture)) {
+        memcpy(g_capture + g_capture_len, data, len);
+        g_capture_len += len;
+    }
+}
+
+/**
+ * @brief 打印一次并返回输出长度（输出保存在 g_capture 中）
+ */
+static size_t bench_capture(const BenchFields* data, const StructDescriptor* desc)
+{
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    StructPrintSink sink;
+
+    g_capture_len = 0;
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_capture_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+    struct_print_to(&sink, "data", data, desc);
+    return g_capture_len;
+}
+
+/**
+ * @brief 对比整个结构体在通用解释器和专用打印函数上的耗时
+ */
+static void bench_specialized(void)
+{
+    static char expected[sizeof(g_capture)];
+    BenchFields data;
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    StructPrintSink sink;
+    const StructDescriptor* descs[2];
+    double ns[2];
+    double cyc[2];
+    size_t expected_len;
+    double c;
+    int round;
+    int d;
+
+    data.u8_val = 200;
+    data.u16_val = 54321;
+    data.u32_val = 3000000000u;
+    data.s16_val = -12345;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    memset(data.string_val, 0, sizeof(data.string_val));
+    strcpy((char*)data.string_val, "862123456789012");
+
+    descs[0] = &BenchFields_desc;
+    descs[1] = &BenchFields_fast_desc;
+
+    /* 输出必须逐字节一致 */
+    expected_len = bench_capture(&data, descs[0]);
+    memcpy(expected, g_capture, expected_len);
+    if (bench_capture(&data, descs[1]) != expected_len || memcmp(expected, g_capture, expected_len) != 0) {
+        printf("专用打印函数输出与通用解释器不一致！\n");
+        return;
+    }
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_null_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+
+    /* 两条路径交替运行，各取最快的一轮，减少调度抖动的影响 */
+    ns[0] = ns[1] = cyc[0] = cyc[1] = 1e30;
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (d = 0; d < 2; d++) {
+            double t0, t;
+            uint64_t c0;
+            int i;
+
+            t0 = bench_now_ns();
+            c0 = bench_cycles();
+            for (i = 0; i < BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS; i++) {
+                struct_print_to(&sink, "data", &data, descs[d]);
+            }
+            c = (double)(bench_cycles() - c0) / (BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS);
+            t = (bench_now_ns() - t0) / (BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS);
+            if (t < ns[d]) ns[d] = t;
+            if (c < cyc[d]) cyc[d] = c;
+        }
+    }
+
+    printf("专用打印函数（整个结构体 %u 字段，%lu 字节输出，%d 次迭代取 %d 轮最快，输出已校验一致）\n",
+           (unsigned)BenchFields_desc.field_count, (unsigned long)expected_len, BENCH_STRUCT_ITERATIONS, BENCH_ROUNDS);
+    printf("%-12s %14s %14s %14s %14s %8s\n",
+           "struct", "interp ns", "special ns", "interp cyc", "special cyc", "speedup");
+    printf("%-12s %14.1f %14.1f %14.1f %14.1f %7.2fx\n",
+           "BenchFields", ns[0], ns[1], cyc[0], cyc[1], ns[0] / ns[1]);
+    printf("\n");
+}
+
+/* ============================================================================
+ *                          运行时输出选项测试
+ * ============================================================================ */
+
+#define BENCH_OPTIONS_COUNT 4
+
+/**
+ * @brief 默认输出经过运行时选项判断后的耗时，以及各预设的输出量
+ */
+static void bench_options(void)
+{
+    static const char* const names[BENCH_OPTIONS_COUNT] = { "default", "options=default", "no hex", "terse" };
+    StructPrintOptions options[BENCH_OPTIONS_COUNT - 1] = {
+        STRUCT_PRINT_OPTIONS_DEFAULT, STRUCT_PRINT_OPTIONS_DEFAULT, STRUCT_PRINT_OPTIONS_TERSE
+    };
+    BenchFields data;
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    StructPrintSink sink;
+    double ns[BENCH_OPTIONS_COUNT];
+    size_t bytes[BENCH_OPTIONS_COUNT];
+    int round;
+    int d;
+
+    memset(&data, 0, sizeof(data));
+    data.u32_val = 3000000000u;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    strcpy((char*)data.string_val, "862123456789012");
+    options[1].show_hex_memory = 0;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_null_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+
+    for (d = 0; d < BENCH_OPTIONS_COUNT; d++) {
+        ns[d] = 1e30;
+        g_bench_bytes = 0;
+        if (d == 0) {
+            struct_print_to(&sink, "data", &data, &BenchFields_desc);
+        } else {
+            struct_print_options_to(&sink, "data", &data, &BenchFields_desc, &options[d - 1]);
+        }
+        bytes[d] = g_bench_bytes;
+    }
+
+    /* 各配置交替运行，各取最快的一轮 */
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (d = 0; d < BENCH_OPTIONS_COUNT; d++) {
+            double t0, t;
+            int i;
+
+            t0 = bench_now_ns();
+            for (i = 0; i < BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS; i++) {
+                if (d == 0) {
+                    struct_print_to(&sink, "data", &data, &BenchFields_desc);
+                } else {
+                    struct_print_options_to(&sink, "data", &data, &BenchFields_desc, &options[d - 1]);
+                }
+            }
+            t = (bench_now_ns() - t0) / (BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS);
+            if (t < ns[d]) ns[d] = t;
+        }
+    }
+
+    printf("运行时输出选项（BenchFields 通用解释器，%d 次迭代取 %d 轮最快）\n", BENCH_STRUCT_ITERATIONS, BENCH_ROUNDS);
+    printf("%-16s %14s %14s\n", "options", "bytes", "ns/struct");
+    for (d = 0; d < BENCH_OPTIONS_COUNT; d++) {
+        printf("%-16s %14lu %14.1f\n", names[d], (unsigned long)bytes[d], ns[d]);
+    }
+    printf("\n");
+}
+
+/* ============================================================================
+ *                          紧凑格式测试
+ * ============================================================================ */
+
+static volatile size_t g_bench_flushes;
+
+/**
+ * @brief 空输出回调：统计字节数和调用次数
+ */
+static void bench_count_flush(void* ctx, const char* data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    g_bench_bytes += len;
+    g_bench_flushes++;
+}
+
+/**
+ * @brief 多行默认格式 vs 单行紧凑格式（STRUCT_PRINT 与 STRUCT_PRINT_COMPACT 的缓冲区大小）
+ */
+static void bench_compact(void)
+{
+    BenchFields data;
+    char line_buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    char compact_buf[STRUCT_PRINT_COMPACT_BUF_SIZE];
+    StructPrintSink sink[2];
+    double ns[2];
+    size_t bytes[2], flushes[2];
+    int round;
+    int d;
+
+    memset(&data, 0, sizeof(data));
+    data.u32_val = 3000000000u;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    strcpy((char*)data.string_val, "862123456789012");
+
+    struct_print_sink_init(&sink[0], line_buf, sizeof(line_buf), bench_count_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+    struct_print_sink_init(&sink[1], compact_buf, sizeof(compact_buf), bench_count_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+
+    for (d = 0; d < 2; d++) {
+        g_bench_bytes = 0;
+        g_bench_flushes = 0;
+        if (d == 0) {
+            struct_print_to(&sink[d], "data", &data, &BenchFields_desc);
+        } else {
+            struct_print_compact_to(&sink[d], &data, &BenchFields_desc);
+        }
+        bytes[d] = g_bench_bytes;
+        flushes[d] = g_bench_flushes;
+        ns[d] = 1e30;
+    }
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (d = 0; d < 2; d++) {
+            double t0, t;
+            int i;
+
+            t0 = bench_now_ns();
+            for (i = 0; i < BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS; i++) {
+                if (d == 0) {
+                    struct_print_to(&sink[d], "data", &data, &BenchFields_desc);
+                } else {
+                    struct_print_compact_to(&sink[d], &data, &BenchFields_desc);
+                }
+            }
+            t = (bench_now_ns() - t0) / (BENCH_STRUCT_ITERATIONS / BENCH_ROUNDS);
+            if (t < ns[d]) ns[d] = t;
+        }
+    }
+
+    printf("紧凑格式（BenchFields，%d 次迭代取 %d 轮最快）\n", BENCH_STRUCT_ITERATIONS, BENCH_ROUNDS);
+    printf("%-12s %14s %14s %14s\n", "format", "bytes", "sink calls", "ns/struct");
+    printf("%-12s %14lu %14lu %14.1f\n", "default", (unsigned long)bytes[0], (unsigned long)flushes[0], ns[0]);
+    printf("%-12s %14lu %14lu %14.1f\n", "compact", (unsigned long)bytes[1], (unsigned long)flushes[1], ns[1]);
+    printf("\n");
+}
+
+
+/* ============================================================================
+ *                          JSON 输出测试
+ * ============================================================================ */
+
+#define BENCH_JSON_ITERATIONS   200000
+#define BENCH_JSON_BUF_SIZE     4096
+
+/**
+ * @brief NDJSON 记录吞吐量（整缓冲区刷新，模拟写入文件/套接字的日志采集场景）
+ */
+static void bench_json(void)
+{
+    BenchFields data;
+    char buf[BENCH_JSON_BUF_SIZE];
+    StructPrintSink sink;
+    size_t record_len;
+    double best = 1e30;
+    double best_cyc = 1e30;
+    int round;
+
+    data.u8_val = 200;
+    data.u16_val = 54321;
+    data.u32_val = 3000000000u;
+    data.s16_val = -12345;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    memset(data.string_val, 0, sizeof(data.string_val));
+    strcpy((char*)data.string_val, "862123456789012");
+
+    g_capture_len = 0;
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_capture_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+    struct_json_record(&sink, "data", &data, &BenchFields_desc);
+    struct_print_sink_flush(&sink);
+    record_len = g_capture_len;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_null_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        double t0, t, c;
+        uint64_t c0;
+        int i;
+
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        for (i = 0; i < BENCH_JSON_ITERATIONS / BENCH_ROUNDS; i++) {
+            struct_json_record(&sink, "data", &data, &BenchFields_desc);
+        }
+        struct_print_sink_flush(&sink);
+        c = (double)(bench_cycles() - c0) / (BENCH_JSON_ITERATIONS / BENCH_ROUNDS);
+        t = (bench_now_ns() - t0) / (BENCH_JSON_ITERATIONS / BENCH_ROUNDS);
+        if (t < best) best = t;
+        if (c < best_cyc) best_cyc = c;
+    }
+
+    printf("JSON 输出（NDJSON，%u 字段，每条 %lu 字节，%d 次迭代取 %d 轮最快）\n",
+           (unsigned)BenchFields_desc.field_count, (unsigned long)record_len, BENCH_JSON_ITERATIONS, BENCH_ROUNDS);
+    printf("%-12s %14s %14s %14s %14s\n", "struct", "ns/record", "cyc/record", "records/s", "MB/s");
+    printf("%-12s %14.1f %14.1f %14.0f %14.1f\n",
+           "BenchFields", best, best_cyc, 1e9 / best, (double)record_len * 1e3 / best);
+    printf("  %.*s\n", (int)record_len - 1, g_capture);
+    printf("\n");
+}
+
+
+/* ============================================================================
+ *                          CBOR 编码测试
+ * ============================================================================ */
+
+#define BENCH_CBOR_ITERATIONS   200000
+
+/**
+ * @brief 对比同一结构体的文本、JSON、CBOR 输出大小，并测量 CBOR 编码耗时
+ */
+static void bench_cbor(void)
+{
+    BenchFields data;
+    char buf[BENCH_JSON_BUF_SIZE];
+    StructPrintSink sink;
+    StructCborSession session = STRUCT_CBOR_SESSION_INIT;
+    size_t text_len, json_len, schema_len, cbor_len;
+    double best = 1e30;
+    double best_cyc = 1e30;
+    int round;
+
+    data.u8_val = 200;
+    data.u16_val = 54321;
+    data.u32_val = 3000000000u;
+    data.s16_val = -12345;
+    data.s32_val = -2000000000;
+    data.float_val = 25.6f;
+    data.double_val = 3.3;
+    memset(data.string_val, 0, sizeof(data.string_val));
+    strcpy((char*)data.string_val, "862123456789012");
+
+    text_len = bench_capture(&data, &BenchFields_desc);
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_capture_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+    g_capture_len = 0;
+    struct_json_record(&sink, "data", &data, &BenchFields_desc);
+    struct_print_sink_flush(&sink);
+    json_len = g_capture_len;
+
+    /* 第一条记录附带名称表，之后的记录只有数据 */
+    g_capture_len = 0;
+    struct_cbor_record(&session, &sink, &BenchFields_desc, &data, 1000);
+    struct_print_sink_flush(&sink);
+    schema_len = g_capture_len;
+    g_capture_len = 0;
+    struct_cbor_record(&session, &sink, &BenchFields_desc, &data, 1000);
+    struct_print_sink_flush(&sink);
+    cbor_len = g_capture_len;
+    schema_len -= cbor_len;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), bench_null_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        double t0, t, c;
+        uint64_t c0;
+        int i;
+
+        t0 = bench_now_ns();
+        c0 = bench_cycles();
+        for (i = 0; i < BENCH_CBOR_ITERATIONS / BENCH_ROUNDS; i++) {
+            struct_cbor_record(&session, &sink, &BenchFields_desc, &data, 1000);
+        }
+        struct_print_sink_flush(&sink);
+        c = (double)(bench_cycles() - c0) / (BENCH_CBOR_ITERATIONS / BENCH_ROUNDS);
+        t = (bench_now_ns() - t0) / (BENCH_CBOR_ITERATIONS / BENCH_ROUNDS);
+        if (t < best) best = t;
+        if (c < best_cyc) best_cyc = c;
+    }
+
+    printf("CBOR 编码（%u 字段，名称表 %lu 字节只发送一次，%d 次迭代取 %d 轮最快）\n",
+           (unsigned)BenchFields_desc.field_count, (unsigned long)schema_len, BENCH_CBOR_ITERATIONS, BENCH_ROUNDS);
+    printf("%-12s %14s %14s %14s %14s %14s\n",
+           "struct", "text bytes", "json bytes", "cbor bytes", "ns/record", "cyc/record");
+    printf("%-12s %14lu %14lu %14lu %14.1f %14.1f\n",
+           "BenchFields", (unsigned long)text_len, (unsigned long)json_len, (unsigned long)cbor_len, best, best_cyc);
+    printf("  CBOR 大小：文本的 1/%.1f，JSON 的 1/%.1f\n",
+           (double)text_len / (double)cbor_len, (double)json_len / (double)cbor_len);
+    printf("\n");
+}
+
+
+/* ============================================================================
+ *                          描述符注册表测试
+ * ============================================================================ */
+
+#define BENCH_REGISTRY_TYPES    4096
+#define BENCH_REGISTRY_SLOTS    8192
+#define BENCH_REGISTRY_LOOKUPS  1000000
+#define BENCH_LINEAR_LOOKUPS    2000
+
+static char g_registry_names[BENCH_REGISTRY_TYPES][16];
+static StructDescriptor g_registry_descs[BENCH_REGISTRY_TYPES];
+STRUCT_REGISTRY_DEFINE(g_bench_registry, BENCH_REGISTRY_SLOTS);
+
+/**
+ * @brief 线性扫描（没有注册表时按名称查找的做法）
+ */
+static const StructDescriptor* linear_find_name(const char* name)
+{
+    size_t i;
+    for (i = 0; i < BENCH_REGISTRY_TYPES; i++) {
+        if (strcmp(g_registry_descs[i].struct_name, name) == 0) return &g_registry_descs[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 注册数千个类型后的查找耗时
+ */
+static void bench_registry(void)
+{
+    u32 ids[BENCH_REGISTRY_TYPES];
+    size_t found = 0;
+    double t0, t_name, t_id, t_linear;
+    int i;
+
+    for (i = 0; i < BENCH_REGISTRY_TYPES; i++) {
+        snprintf(g_registry_names[i], sizeof(g_registry_names[i]), "Type%04d", i);
+        g_registry_descs[i].struct_name = g_registry_names[i];
+        g_registry_descs[i].struct_size = BenchFields_desc.struct_size;
+        g_registry_descs[i].field_count = BenchFields_desc.field_count;
+        g_registry_descs[i].fields = BenchFields_desc.fields;
+        struct_registry_add(&g_bench_registry, &g_registry_descs[i]);
+        ids[i] = struct_desc_id(&g_registry_descs[i]);
+    }
+
+    /* 步长与类型数互质，使访问顺序与散列顺序无关 */
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_REGISTRY_LOOKUPS; i++) {
+        found += struct_registry_find_name(&g_bench_registry, g_registry_names[(i * 2654435761u) % BENCH_REGISTRY_TYPES]) != NULL;
+    }
+    t_name = (bench_now_ns() - t0) / BENCH_REGISTRY_LOOKUPS;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_REGISTRY_LOOKUPS; i++) {
+        found += struct_registry_find_id(&g_bench_registry, ids[(i * 2654435761u) % BENCH_REGISTRY_TYPES]) != NULL;
+    }
+    t_id = (bench_now_ns() - t0) / BENCH_REGISTRY_LOOKUPS;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_LINEAR_LOOKUPS; i++) {
+        found += linear_find_name(g_registry_names[(i * 2654435761u) % BENCH_REGISTRY_TYPES]) != NULL;
+    }
+    t_linear = (bench_now_ns() - t0) / BENCH_LINEAR_LOOKUPS;
+
+    g_bench_bytes += found;
+    printf("描述符注册表（%d 个类型，%d 槽）\n", BENCH_REGISTRY_TYPES, BENCH_REGISTRY_SLOTS);
+    printf("%-24s %14s\n", "lookup", "ns/lookup");
+    printf("%-24s %14.1f\n", "registry by name", t_name);
+    printf("%-24s %14.1f\n", "registry by id", t_id);
+    printf("%-24s %14.1f\n", "linear scan by name", t_linear);
+    printf("  按名称查找：%.0fx\n", t_linear / t_name);
+    printf("\n");
+}
+
+/* ============================================================================
+ *                          字段路径查询测试
+ * ============================================================================ */
+
+#define BENCH_FIELD_GET_ITERATIONS 2000000
+
+typedef struct {
+    u32 seq;
+    BenchFields inner;
+} BenchOuter;
+
+BEGIN_STRUCT_DESC(BenchOuter, BenchOuter_desc)
+    FIELD_U32(BenchOuter, seq),
+    FIELD_STRUCT(BenchOuter, inner, BenchFields_desc)
+END_STRUCT_DESC(BenchOuter, BenchOuter_desc)
+
+/**
+ * @brief 每次解析路径 vs 缓存句柄 vs 直接访问
+ */
+static void bench_field_get(void)
+{
+    static BenchOuter outer;
+    StructFieldRef ref = struct_field_ref(&BenchOuter_desc, "inner.float_val");
+    volatile double sink = 0.0;
+    double t0, t_path, t_ref, t_at;
+    int i;
+
+    outer.inner.float_val = 1.5f;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_FIELD_GET_ITERATIONS; i++) {
+        sink += struct_get(&outer, &BenchOuter_desc, "inner.float_val");
+    }
+    t_path = (bench_now_ns() - t0) / BENCH_FIELD_GET_ITERATIONS;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_FIELD_GET_ITERATIONS; i++) {
+        sink += struct_field_get(&outer, &ref);
+    }
+    t_ref = (bench_now_ns() - t0) / BENCH_FIELD_GET_ITERATIONS;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_FIELD_GET_ITERATIONS; i++) {
+        sink += STRUCT_FIELD_AT(outer, ref, float);
+    }
+    t_at = (bench_now_ns() - t0) / BENCH_FIELD_GET_ITERATIONS;
+
+    (void)sink;
+    printf("字段路径查询（\"inner.float_val\"，%d 次）\n", BENCH_FIELD_GET_ITERATIONS);
+    printf("%-24s %14s\n", "access", "ns/read");
+    printf("%-24s %14.1f\n", "struct_get (path)", t_path);
+    printf("%-24s %14.1f\n", "struct_field_get (ref)", t_ref);
+    printf("%-24s %14.1f\n", "STRUCT_FIELD_AT (ref)", t_at);
+    printf("\n");
+}
+
+
+/* ============================================================================
+ *                          描述符套件测试
+ * ============================================================================ */
+
+#define BENCH_SUITE_BYTES       (4u * 1024u * 1024u)   /* 每轮输出量，决定迭代次数 */
+#define BENCH_SUITE_MAX_ITERS   50000
+#define BENCH_SUITE_MEM_SIZE    (1u << 20)
+#define BENCH_SUITE_SINKS       3
+
+#define BENCH_WIDE_FIELDS       1000
+#define BENCH_DEEP_LEVELS       8
+#define BENCH_DEEP_LEVEL_SIZE   16
+
+/* 合成描述符：1000 个字段的宽结构体 */
+static char g_wide_names[BENCH_WIDE_FIELDS][8];
+static FieldDescriptor g_wide_fields[BENCH_WIDE_FIELDS];
+static StructDescriptor g_wide_desc;
+
+/* 合成描述符：8 层嵌套，每层 { u32 id; float value; u8 tag[8]; 下一层 } */
+static FieldDescriptor g_deep_fields[BENCH_DEEP_LEVELS][4];
+static StructDescriptor g_deep_descs[BENCH_DEEP_LEVELS];
+
+/* 被打印的数据（足够容纳所有测试结构体） */
+static u8 g_suite_data[BENCH_WIDE_FIELDS * sizeof(double)];
+
+/* 内存 sink：回绕写入固定大小的区域 */
+static char g_suite_mem[BENCH_SUITE_MEM_SIZE];
+static size_t g_suite_mem_pos;
+
+static void bench_memory_flush(void* ctx, const char* data, size_t len)
+{
+    (void)ctx;
+    if (g_suite_mem_pos + len > sizeof(g_suite_mem)) g_suite_mem_pos = 0;
+    memcpy(g_suite_mem + g_suite_mem_pos, data, len);
+    g_suite_mem_pos += len;
+    g_bench_bytes += len;
+    g_bench_flushes++;
+}
+
+static void bench_file_flush(void* ctx, const char* data, size_t len)
+{
+    fwrite(data, 1, len, (FILE*)ctx);
+    g_bench_bytes += len;
+    g_bench_flushes++;
+}
+
+/**
+ * @brief 构造合成描述符：字段类型循环覆盖所有标量，每 16 个字段插入一个字符串
+ */
+static void bench_build_synthetic(void)
+{
+    static const FieldType scalar_types[] = {
+        FIELD_TYPE_U8, FIELD_TYPE_U16, FIELD_TYPE_U32, FIELD_TYPE_S8,
+        FIELD_TYPE_S16, FIELD_TYPE_S32, FIELD_TYPE_FLOAT, FIELD_TYPE_DOUBLE,
+    };
+    static const size_t scalar_sizes[] = { 1, 2, 4, 1, 2, 4, sizeof(float), sizeof(double) };
+    size_t offset = 0;
+    int i;
+
+    for (i = 0; i < BENCH_WIDE_FIELDS; i++) {
+        FieldDescriptor* f = &g_wide_fields[i];
+
+        snprintf(g_wide_names[i], sizeof(g_wide_names[i]), "f%04d", i);
+        f->name = g_wide_names[i];
+        if (i % 16 == 15) {
+            f->type = FIELD_TYPE_STRING;
+            f->size = 1;
+            f->array_count = 16;
+        } else {
+            f->type = scalar_types[i % 8];
+            f->size = scalar_sizes[i % 8];
+            f->array_count = 0;
+        }
+        offset = (offset + f->size - 1) / f->size * f->size;   /* 自然对齐 */
+        f->offset = offset;
+        f->nested_desc = NULL;
+        offset += f->size * (f->array_count ? f->array_count : 1);
+    }
+    g_wide_desc.struct_name = "BenchWide";
+    g_wide_desc.struct_size = offset;
+    g_wide_desc.field_count = BENCH_WIDE_FIELDS;
+    g_wide_desc.fields = g_wide_fields;
+
+    /* 从最内层向外构造，每层的 child 字段指向下一层 */
+    for (i = BENCH_DEEP_LEVELS - 1; i >= 0; i--) {
+        FieldDescriptor* f = g_deep_fields[i];
+        size_t inner = (size_t)(BENCH_DEEP_LEVELS - 1 - i);
+
+        f[0].name = "id";    f[0].type = FIELD_TYPE_U32;    f[0].offset = 0; f[0].size = 4; f[0].array_count = 0;
+        f[1].name = "value"; f[1].type = FIELD_TYPE_FLOAT;  f[1].offset = 4; f[1].size = 4; f[1].array_count = 0;
+        f[2].name = "tag";   f[2].type = FIELD_TYPE_STRING; f[2].offset = 8; f[2].size = 1; f[2].array_count = 8;
+        f[3].name = "child"; f[3].type = FIELD_TYPE_STRUCT; f[3].offset = BENCH_DEEP_LEVEL_SIZE;
+        f[3].size = inner * BENCH_DEEP_LEVEL_SIZE;
+        f[3].array_count = 0;
+        f[3].nested_desc = (i < BENCH_DEEP_LEVELS - 1) ? &g_deep_descs[i + 1] : NULL;
+
+        g_deep_descs[i].struct_name = "BenchDeep";
+        g_deep_descs[i].struct_size = (inner + 1) * BENCH_DEEP_LEVEL_SIZE;
+        g_deep_descs[i].field_count = (i < BENCH_DEEP_LEVELS - 1) ? 4 : 3;
+        g_deep_descs[i].fields = f;
+    }
+}
+
+/**
+ * @brief 每个描述符 × 每种 sink：ns/结构体、字节/结构体、sink 调用/结构体
+ * @param results NDJSON 结果文件（NULL 不写）
+ *
+ * @note 所有 sink 都使用 STRUCT_PRINT 的行缓冲区大小和逐行刷新模式，与实际调用一致
+ * @note 数据填充为可打印字符，字符串字段没有结尾 0，按最大长度输出
+ */
+static void bench_suite(FILE* results)
+{
+    static const StructDescriptor* const test_descs[] = { TEST_STRUCTS_DESC_LIST };
+    static const char* const sink_names[BENCH_SUITE_SINKS] = { "null", "memory", "file" };
+    const StructDescriptor* descs[sizeof(test_descs) / sizeof(test_descs[0]) + 2];
+    size_t desc_count = 0;
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    FILE* devnull;
+    size_t i;
+
+    bench_build_synthetic();
+    for (i = 0; i < sizeof(test_descs) / sizeof(test_descs[0]); i++) {
+        descs[desc_count++] = test_descs[i];
+    }
+    descs[desc_count++] = &g_wide_desc;
+    descs[desc_count++] = &g_deep_descs[0];
+
+    for (i = 0; i < sizeof(g_suite_data); i++) {
+        g_suite_data[i] = (u8)(0x20 + (i * 7) % 64);
+    }
+
+    devnull = fopen("/dev/null", "w");
+
+    printf("描述符套件（每轮约 %u KB 输出，取 %d 轮最快）\n", BENCH_SUITE_BYTES / 1024u, BENCH_ROUNDS);
+    printf("%-22s %6s %-7s %12s %12s %12s %12s\n",
+           "struct", "fields", "sink", "ns/struct", "bytes/struct", "calls/struct", "ns/byte");
+
+    for (i = 0; i < desc_count; i++) {
+        const StructDescriptor* desc = descs[i];
+        int s;
+
+        for (s = 0; s < BENCH_SUITE_SINKS; s++) {
+            StructPrintSink sink;
+            size_t bytes, flushes;
+            double ns = 1e30;
+            int iters, round;
+
+            if (s == 0) {
+                struct_print_sink_init(&sink, buf, sizeof(buf), bench_count_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+            } else if (s == 1) {
+                struct_print_sink_init(&sink, buf, sizeof(buf), bench_memory_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+            } else {
+                if (devnull == NULL) continue;
+                struct_print_sink_init(&sink, buf, sizeof(buf), bench_file_flush, devnull, STRUCT_PRINT_SINK_FLUSH_LINE);
+            }
+
+            /* 先打印一次得到输出量，据此确定迭代次数 */
+            g_bench_bytes = 0;
+            g_bench_flushes = 0;
+            struct_print_to(&sink, "data", g_suite_data, desc);
+            bytes = g_bench_bytes;
+            flushes = g_bench_flushes;
+            iters = (int)(BENCH_SUITE_BYTES / (bytes ? bytes : 1));
+            if (iters < 1) iters = 1;
+            if (iters > BENCH_SUITE_MAX_ITERS) iters = BENCH_SUITE_MAX_ITERS;
+
+            for (round = 0; round < BENCH_ROUNDS; round++) {
+                double t0, t;
+                int n;
+
+                t0 = bench_now_ns();
+                for (n = 0; n < iters; n++) {
+                    struct_print_to(&sink, "data", g_suite_data, desc);
+                }
+                if (s == 2) fflush(devnull);
+                t = (bench_now_ns() - t0) / iters;
+                if (t < ns) ns = t;
+            }
+
+            printf("%-22s %6lu %-7s %12.1f %12lu %12lu %12.2f\n",
+                   desc->struct_name, (unsigned long)desc->field_count, sink_names[s],
+                   ns, (unsigned long)bytes, (unsigned long)flushes, ns / (double)(bytes ? bytes : 1));
+            if (results != NULL) {
+                fprintf(results,
+                        "{\"bench\":\"suite\",\"struct\":\"%s\",\"fields\":%lu,\"sink\":\"%s\","
+                        "\"iterations\":%d,\"ns_per_struct\":%.1f,\"bytes_per_struct\":%lu,\"sink_calls_per_struct\":%lu}\n",
+                        desc->struct_name, (unsigned long)desc->field_count, sink_names[s],
+                        iters, ns, (unsigned long)bytes, (unsigned long)flushes);
+            }
+        }
+    }
+    printf("\n");
+
+    if (devnull != NULL) fclose(devnull);
+}
+
+
+/* ============================================================================
+ *                          批量打印测试
+ * ============================================================================ */
+
+#define BENCH_BATCH_COUNT       64
+#define BENCH_BATCH_BUF_SIZE    4096
+#define BENCH_BATCH_ITERATIONS  200
+
+/**
+ * @brief 逐个 struct_print_to vs struct_print_batch_to（结构体数组，每批 64 个实例）
+ *
+ * @note 逐个打印与批量打印使用同一个 sink，输出相同（只有变量名不同）；
+ *       line 为 STRUCT_PRINT 的行缓冲区逐行刷新，full 为 4 KB 缓冲区满时刷新
+ */
+static void bench_batch(void)
+{
+    static const char* const sink_names[2] = { "line", "full" };
+    const StructDescriptor* descs[3];
+    static char buf[BENCH_BATCH_BUF_SIZE];
+    size_t d;
+    int s;
+
+    bench_build_synthetic();
+    descs[0] = &SystemStatus_desc;
+    descs[1] = &BenchFields_desc;
+    descs[2] = &g_wide_desc;
+
+    printf("批量打印（每批 %d 个实例，%d 批取 %d 轮最快）\n", BENCH_BATCH_COUNT, BENCH_BATCH_ITERATIONS, BENCH_ROUNDS);
+    printf("%-14s %-5s %14s %14s %14s %14s %9s\n",
+           "struct", "sink", "single ns", "batch ns", "single calls", "batch calls", "speedup");
+
+    for (d = 0; d < sizeof(descs) / sizeof(descs[0]); d++) {
+        const StructDescriptor* desc = descs[d];
+        size_t stride = desc->struct_size;
+
+        if (stride * BENCH_BATCH_COUNT > sizeof(g_suite_data)) {
+            stride = 0;     /* 大结构体：指针数组，全部指向同一份数据 */
+        }
+        for (s = 0; s < 2; s++) {
+            static const void* ptrs[BENCH_BATCH_COUNT];
+            StructPrintSink sink;
+            const void* base = g_suite_data;
+            double calls[2];
+            double ns[2] = { 1e30, 1e30 };
+            int round, m;
+
+            if (stride == 0) {
+                for (m = 0; m < BENCH_BATCH_COUNT; m++) ptrs[m] = g_suite_data;
+                base = ptrs;
+            }
+            struct_print_sink_init(&sink, buf, (s == 0) ? STRUCT_PRINT_LINE_BUF_SIZE : sizeof(buf),
+                                   bench_count_flush, NULL,
+                                   (s == 0) ? STRUCT_PRINT_SINK_FLUSH_LINE : STRUCT_PRINT_SINK_FLUSH_FULL);
+
+            for (round = 0; round < BENCH_ROUNDS; round++) {
+                for (m = 0; m < 2; m++) {
+                    double t0, t;
+                    int n, k;
+
+                    g_bench_bytes = 0;
+                    g_bench_flushes = 0;
+                    t0 = bench_now_ns();
+                    for (n = 0; n < BENCH_BATCH_ITERATIONS; n++) {
+                        if (m == 1) {
+                            struct_print_batch_to(&sink, "dev", base, stride, BENCH_BATCH_COUNT, desc);
+                            continue;
+                        }
+                        for (k = 0; k < BENCH_BATCH_COUNT; k++) {
+                            const void* data = (stride != 0) ? (const void*)(g_suite_data + k * stride) : ptrs[k];
+                            struct_print_to(&sink, "dev[0]", data, desc);
+                        }
+                    }
+                    t = (bench_now_ns() - t0) / ((double)BENCH_BATCH_ITERATIONS * BENCH_BATCH_COUNT);
+                    if (t < ns[m]) ns[m] = t;
+                    calls[m] = (double)g_bench_flushes / ((double)BENCH_BATCH_ITERATIONS * BENCH_BATCH_COUNT);
+                }
+            }
+            printf("%-14s %-5s %14.1f %14.1f %14.2f %14.2f %8.2fx\n",
+                   desc->struct_name, sink_names[s], ns[0], ns[1], calls[0], calls[1], ns[0] / ns[1]);
+        }
+    }
+    printf("\n");
+}
+
+/* ============================================================================
+ *                          模板缓存测试
+ * ============================================================================ */
+
+#define BENCH_TEMPLATE_ARENA    (64u * 1024u)
+
+STRUCT_PRINT_TEMPLATES_DEFINE(g_bench_template_cache, 64, BENCH_TEMPLATE_ARENA);
+
+/**
+ * @brief 逐段生成字段前缀 vs 模板缓存（空 sink，4 KB 缓冲区满时刷新，基本只计格式化耗时）
+ *
+ * @note 缓存的第一次打印（生成模板）不计时；两种方式的输出逐字节比较（内存 sink）
+ */
+static void bench_templates(void)
+{
+    static const StructDescriptor* const test_descs[] = { TEST_STRUCTS_DESC_LIST };
+    const StructDescriptor* descs[sizeof(test_descs) / sizeof(test_descs[0]) + 2];
+    static char out[2][BENCH_SUITE_MEM_SIZE / 2];
+    size_t out_len[2];
+    size_t desc_count = 0;
+    char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+    static char big[4096];
+    size_t i;
+
+    bench_build_synthetic();
+    for (i = 0; i < sizeof(test_descs) / sizeof(test_descs[0]); i++) {
+        descs[desc_count++] = test_descs[i];
+    }
+    descs[desc_count++] = &g_wide_desc;
+    descs[desc_count++] = &g_deep_descs[0];
+
+    printf("模板缓存（空 sink，4 KB 缓冲区，取 %d 轮最快）\n", BENCH_ROUNDS);
+    printf("%-22s %6s %14s %14s %9s %8s\n", "struct", "fields", "plain ns", "cached ns", "speedup", "output");
+
+    for (i = 0; i < desc_count; i++) {
+        const StructDescriptor* desc = descs[i];
+        StructPrintSink sink;
+        double ns[2] = { 1e30, 1e30 };
+        int iters, round, m;
+
+        /* 两种方式各打印一次：比较输出、生成模板、确定迭代次数 */
+        for (m = 0; m < 2; m++) {
+            g_bench_templates = (m == 0) ? NULL : &g_bench_template_cache;
+            g_suite_mem_pos = 0;
+            struct_print_sink_init(&sink, buf, sizeof(buf), bench_memory_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+            struct_print_to(&sink, "data", g_suite_data, desc);
+            out_len[m] = (g_suite_mem_pos < sizeof(out[m])) ? g_suite_mem_pos : sizeof(out[m]);
+            memcpy(out[m], g_suite_mem, out_len[m]);
+        }
+        iters = (int)(BENCH_SUITE_BYTES / (out_len[0] ? out_len[0] : 1));
+        if (iters < 1) iters = 1;
+        if (iters > BENCH_SUITE_MAX_ITERS) iters = BENCH_SUITE_MAX_ITERS;
+
+        struct_print_sink_init(&sink, big, sizeof(big), bench_count_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+        for (round = 0; round < BENCH_ROUNDS; round++) {
+            for (m = 0; m < 2; m++) {
+                double t0, t;
+                int n;
+
+                g_bench_templates = (m == 0) ? NULL : &g_bench_template_cache;
+                t0 = bench_now_ns();
+                for (n = 0; n < iters; n++) {
+                    struct_print_to(&sink, "data", g_suite_data, desc);
+                }
+                t = (bench_now_ns() - t0) / iters;
+                if (t < ns[m]) ns[m] = t;
+            }
+        }
+        g_bench_templates = NULL;
+
+        printf("%-22s %6lu %14.1f %14.1f %8.2fx %8s\n",
+               desc->struct_name, (unsigned long)desc->field_count, ns[0], ns[1], ns[0] / ns[1],
+               (out_len[0] == out_len[1] && memcmp(out[0], out[1], out_len[0]) == 0) ? "same" : "DIFF");
+    }
+    printf("模板缓存：%lu 个模板，存储区 %lu / %lu 字节，未缓存 %lu 次\n\n",
+           (unsigned long)g_bench_template_cache.count, (unsigned long)g_bench_template_cache.arena_used,
+           (unsigned long)g_bench_template_cache.arena_size, (unsigned long)g_bench_template_cache.misses);
+}
+
+#ifdef BENCH_STATS
+/* ============================================================================
+ *                          性能统计检查
+ * ============================================================================ */
+
+STRUCT_PRINT_STATS_DEFINE(g_bench_stats, 4);
+
+/**
+ * @brief 逐个打印与批量打印记入统计表的次数和字节数应与实际输出一致
+ *
+ * @note 批量打印在整批结束时才刷新，记录结束时内容仍在缓冲区中，
+ *       统计必须把未刷新的部分计入（与记录开始时相同）
+ * @return 全部一致返回 0
+ */
+static int bench_stats_check(void)
+{
+    static const char* const mode_names[2] = { "single", "batch" };
+    const StructDescriptor* descs[2];
+    static char buf[BENCH_BATCH_BUF_SIZE];
+    int failed = 0;
+    size_t d, i;
+    int m;
+
+    descs[0] = &SystemStatus_desc;
+    descs[1] = &BenchFields_desc;
+    for (i = 0; i < sizeof(g_suite_data); i++) {
+        g_suite_data[i] = (u8)(0x20 + (i * 7) % 64);
+    }
+
+    printf("性能统计检查（每次 %d 个实例，4 KB 缓冲区满时刷新）\n", BENCH_BATCH_COUNT);
+    printf("%-14s %-7s %8s %12s %12s %6s\n", "struct", "mode", "count", "stats bytes", "output", "");
+
+    for (d = 0; d < sizeof(descs) / sizeof(descs[0]); d++) {
+        const StructDescriptor* desc = descs[d];
+
+        for (m = 0; m < 2; m++) {
+            const StructPrintStatsEntry* e;
+            StructPrintSink sink;
+            unsigned long count = 0, bytes = 0;
+            int k, ok;
+
+            struct_print_stats_reset(&g_bench_stats);
+            struct_print_sink_init(&sink, buf, sizeof(buf), bench_count_flush, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+            g_bench_bytes = 0;
+            if (m == 1) {
+                struct_print_batch_to(&sink, "dev", g_suite_data, desc->struct_size, BENCH_BATCH_COUNT, desc);
+            } else {
+                for (k = 0; k < BENCH_BATCH_COUNT; k++) {
+                    struct_print_to(&sink, "dev[0]", g_suite_data + k * desc->struct_size, desc);
+                }
+            }
+
+            e = struct_print_stats_find(&g_bench_stats, desc);
+            if (e != NULL) {
+                count = (unsigned long)e->count;
+                bytes = (unsigned long)e->bytes;
+            }
+            ok = (count == BENCH_BATCH_COUNT && bytes == (unsigned long)g_bench_bytes);
+            if (!ok) failed = 1;
+            printf("%-14s %-7s %8lu %12lu %12lu %6s\n", desc->struct_name, mode_names[m],
+                   count, bytes, (unsigned long)g_bench_bytes, ok ? "ok" : "DIFF");
+        }
+    }
+    printf("\n");
+    return failed;
+}
+#endif
+
+/* ============================================================================
+ *                          主函数
+ * ============================================================================ */
+
+int main(int argc, char* argv[])
+{
+    FILE* results = NULL;
+
+#ifdef BENCH_STATS
+    (void)argc;
+    (void)argv;
+    return bench_stats_check();
+#endif
+
+    if (argc > 1) {
+        results = fopen(argv[1], "w");
+        if (results == NULL) {
+            printf("无法写入结果文件 %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    printf("\n");
+    printf("========================================\n");
+    printf("  struct_print.h 性能测试\n");
+    printf("========================================\n\n");
+
+    bench_field_formatting();
+    bench_specialized();
+    bench_options();
+    bench_compact();
+    bench_json();
+    bench_cbor();
+    bench_registry();
+    bench_field_get();
+    bench_suite(results);
+    bench_batch();
+    bench_templates();
+
+    if (results != NULL) {
+        fclose(results);
+        printf("描述符套件结果已写入 %s\n", argv[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,473 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+gen_descriptor.py - struct_print.h 描述符命令行生成器
+
+与 descriptor_generator.html 使用相同的解析和类型映射规则，适合在构建中批量生成：
+扫描头文件（或整个目录树），为每个包含结构体的头文件生成 xxx_desc.h，
+并可选生成汇总所有结构体的 GET_STRUCT_DESC（C11 _Generic）映射文件。
+
+增量生成：每个头文件的内容哈希和解析结果保存在缓存文件中，
+内容未变化的头文件不会重新解析；输出内容未变化时不改写文件（不触发依赖它的编译）。
+
+用法：
+    python3 gen_descriptor.py test_structs.h -o test_structs_desc.h
+    python3 gen_descriptor.py include/ --out-dir gen/ --generic gen/struct_desc_generic.h
+    python3 gen_descriptor.py include/ drivers/ --out-dir gen/ -v
+
+作者：xingleixu@gmail.com
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import re
+import sys
+import time
+
+CACHE_VERSION = 1
+DEFAULT_CACHE_NAME = '.struct_desc_cache.json'
+
+# ============================================================================
+#                           类型映射表（与 descriptor_generator.html 一致）
+# ============================================================================
+
+TYPE_MAP = {
+    'uint8_t': 'U8', 'u8': 'U8', 'unsigned char': 'U8',
+    'uint16_t': 'U16', 'u16': 'U16', 'unsigned short': 'U16',
+    'uint32_t': 'U32', 'u32': 'U32', 'unsigned int': 'U32', 'unsigned long': 'U32',
+    'int8_t': 'S8', 's8': 'S8', 'char': 'S8', 'signed char': 'S8',
+    'int16_t': 'S16', 's16': 'S16', 'short': 'S16', 'signed short': 'S16',
+    'int32_t': 'S32', 's32': 'S32', 'int': 'S32', 'signed int': 'S32',
+    'long': 'S32', 'signed long': 'S32',
+    'float': 'FLOAT',
+    'double': 'DOUBLE',
+}
+
+# 这些类型的数组按字符串显示
+STRING_BASE_TYPES = ('u8', 'uint8_t', 'char', 'unsigned char')
+
+
+def warn(msg):
+    sys.stderr.write('警告: %s\n' % msg)
+
+
+# ============================================================================
+#                           解析器
+# ============================================================================
+
+COMMENT_RE = re.compile(r'//[^\n]*|/\*.*?\*/', re.S)
+PREPROC_RE = re.compile(r'^[ \t]*#(?:[^\n]*\\\n)*[^\n]*', re.M)
+STRUCT_RE = re.compile(r'\b(typedef\s+)?struct\s*(\w+)?\s*\{')
+ARRAY_RE = re.compile(r'^(\w+)\s*((?:\[[^\]]+\])+)$')
+
+
+def strip_source(text):
+    """移除注释和预处理指令（保留换行，便于报告行号）"""
+    text = COMMENT_RE.sub(lambda m: re.sub(r'[^\n]', ' ', m.group(0)), text)
+    return PREPROC_RE.sub(lambda m: re.sub(r'[^\n]', ' ', m.group(0)), text)
+
+
+def find_matching_brace(text, open_pos):
+    """返回与 open_pos 处 '{' 匹配的 '}' 位置，找不到返回 -1"""
+    depth = 0
+    for i in range(open_pos, len(text)):
+        c = text[i]
+        if c == '{':
+            depth += 1
+        elif c == '}':
+            depth -= 1
+            if depth == 0:
+                return i
+    return -1
+
+
+def parse_field_decl(decl, where):
+    """
+    解析一条字段声明（可能包含多个声明符，如 "u8 a, b[4]"）
+    返回 [(name, type, array_dims)]，无法处理的声明返回空列表并给出警告
+    """
+    decl = ' '.join(decl.split())
+    # 位域写法 "flags : 3" 与 "flags:3" 统一，保证冒号留在声明符中
+    decl = re.sub(r'\s*:\s*', ':', decl)
+    if not decl:
+        return []
+    if '{' in decl or '(' in decl:
+        warn('%s: 不支持的字段声明，已跳过: %s' % (where, decl))
+        return []
+
+    parts = [p.strip() for p in decl.split(',')]
+    first = parts[0].split(' ')
+    if len(first) < 2:
+        warn('%s: 无法解析字段，已跳过: %s' % (where, decl))
+        return []
+
+    # 去掉不影响布局的限定符
+    type_words = [w for w in first[:-1] if w not in ('const', 'volatile')]
+    type_name = ' '.join(type_words)
+    declarators = [first[-1]] + parts[1:]
+
+    fields = []
+    for d in declarators:
+        d = d.replace(' ', '')
+        if '*' in d or '*' in type_name:
+            warn('%s: 跳过指针字段 %s' % (where, d.lstrip('*')))
+            continue
+        if ':' in d:
+            warn('%s: 跳过位域字段 %s（无法使用 offsetof）' % (where, d))
+            continue
+        m = ARRAY_RE.match(d)
+        if m:
+            dims = re.findall(r'\[([^\]]+)\]', m.group(2))
+            if len(dims) > 1:
+                warn('%s: 跳过多维数组字段 %s' % (where, m.group(1)))
+                continue
+            fields.append((m.group(1), type_name, dims))
+        elif re.match(r'^\w+$', d):
+            fields.append((d, type_name, []))
+        else:
+            warn('%s: 无法解析字段，已跳过: %s' % (where, d))
+    return fields
+
+
+def parse_header(text, path):
+    """
+    解析头文件中的结构体定义
+    返回 [{"name": 显示名, "tag": 结构体标签, "ctype": C 类型写法, "fields": [[name, type, dims], ...]}]
+    """
+    text = strip_source(text)
+    structs = []
+    pos = 0
+
+    while True:
+        m = STRUCT_RE.search(text, pos)
+        if not m:
+            break
+        open_pos = m.end() - 1
+        close_pos = find_matching_brace(text, open_pos)
+        if close_pos < 0:
+            warn('%s: 结构体定义缺少 }，停止解析' % path)
+            break
+
+        line = text.count('\n', 0, m.start()) + 1
+        body = text[open_pos + 1:close_pos]
+        tail = re.match(r'\s*(\w*)\s*;', text[close_pos + 1:])
+        is_typedef = m.group(1) is not None
+        tag = m.group(2) or ''
+        name = (tail.group(1) if (is_typedef and tail) else '') or tag
+        pos = close_pos + 1
+
+        if not name:
+            continue
+        if not is_typedef and (not tail or tail.group(1)):
+            continue    # struct x { } var; 之类的变量定义
+
+        where = '%s:%d %s' % (path, line, name)
+        if '{' in body:
+            warn('%s: 不支持在结构体内部定义结构体，已跳过' % where)
+            continue
+
+        fields = []
+        for decl in body.split(';'):
+            fields.extend(parse_field_decl(decl, where))
+        if not fields:
+            continue
+
+        ctype = name if is_typedef else 'struct ' + tag
+        structs.append({'name': name, 'tag': tag, 'ctype': ctype, 'fields': [list(f) for f in fields]})
+
+    return structs
+
+
+# ============================================================================
+#                           描述符生成
+# ============================================================================
+
+def field_macro(struct_name, field, known):
+    """生成单个字段的 FIELD_* 宏，返回 (宏文本, 嵌套结构体名或 None)"""
+    name, type_name, dims = field
+    base = type_name[len('struct '):].strip() if type_name.startswith('struct ') else type_name
+
+    if type_name.startswith('struct ') or base in known:
+        nested = known.get(base, base)
+        if dims:
+            return 'FIELD_STRUCT_ARRAY(%s, %s, %s_desc)' % (struct_name, name, nested), nested
+        return 'FIELD_STRUCT(%s, %s, %s_desc)' % (struct_name, name, nested), nested
+
+    if dims:
+        if base in STRING_BASE_TYPES:
+            return 'FIELD_STRING(%s, %s)' % (struct_name, name), None
+        return 'FIELD_ARRAY(%s, %s, FIELD_TYPE_%s)' % (struct_name, name, TYPE_MAP.get(base, 'U8')), None
+
+    kind = TYPE_MAP.get(base)
+    if kind is None:
+        warn('%s.%s: 未知类型 %s，默认使用 FIELD_U8' % (struct_name, name, base))
+        kind = 'U8'
+    return 'FIELD_%s(%s, %s)' % (kind, struct_name, name), None
+
+
+def generate_descriptor(info, known):
+    """生成一个结构体的描述符代码，返回 (代码, 依赖的结构体列表)"""
+    name, ctype = info['name'], info['ctype']
+    lines = ['/* 描述符：%s */' % name, 'BEGIN_STRUCT_DESC(%s, %s_desc)' % (ctype, name)]
+    deps = []
+    fields = info['fields']
+    for i, field in enumerate(fields):
+        text, nested = field_macro(ctype, field, known)
+        if nested:
+            deps.append(nested)
+        lines.append('    %s%s' % (text, ',' if i < len(fields) - 1 else ''))
+    lines.append('END_STRUCT_DESC(%s, %s_desc)' % (ctype, name))
+    return '\n'.join(lines), deps
+
+
+def order_by_dependency(structs, known):
+    """同一文件内按依赖排序：被嵌套的结构体先定义"""
+    by_name = dict((s['name'], s) for s in structs)
+    done, ordered = set(), []
+
+    def visit(s, stack):
+        if s['name'] in done:
+            return
+        stack.add(s['name'])
+        for f in s['fields']:
+            base = f[1][len('struct '):].strip() if f[1].startswith('struct ') else f[1]
+            dep = by_name.get(known.get(base, base))
+            if dep is not None and dep['name'] not in stack:
+                visit(dep, stack)
+        stack.discard(s['name'])
+        done.add(s['name'])
+        ordered.append(s)
+
+    for s in structs:
+        visit(s, set())
+    return ordered
+
+
+def guard_and_list_names(out_path):
+    """根据输出文件名生成头文件保护宏和描述符列表宏名"""
+    stem = re.sub(r'\W', '_', os.path.splitext(os.path.basename(out_path))[0]).upper()
+    list_stem = stem[:-5] if stem.endswith('_DESC') else stem
+    return '__%s_H' % stem, '%s_DESC_LIST' % list_stem
+
+
+def generate_desc_file(in_path, out_path, structs, known, owner):
+    """生成一个 xxx_desc.h 文件的完整内容"""
+    guard, list_name = guard_and_list_names(out_path)
+    out_dir = os.path.dirname(os.path.abspath(out_path))
+    header = os.path.basename(in_path)
+
+    blocks, includes = [], []
+    for info in order_by_dependency(structs, known):
+        code, deps = generate_descriptor(info, known)
+        blocks.append(code)
+        for dep in deps:
+            dep_out = owner.get(dep)
+            if dep_out is None:
+                warn('%s: 找不到嵌套结构体 %s 的定义' % (info['name'], dep))
+            elif os.path.abspath(dep_out) != os.path.abspath(out_path):
+                rel = os.path.relpath(os.path.abspath(dep_out), out_dir).replace(os.sep, '/')
+                if rel not in includes:
+                    includes.append(rel)
+
+    lines = [
+        '/**',
+        ' * @file %s' % os.path.basename(out_path),
+        ' * @brief %s 的结构体描述符' % header,
+        ' * @note 由 gen_descriptor.py 自动生成，请勿手工修改',
+        ' * @note 使用前需先包含 struct_print.h（定义 STRUCT_PRINT_ENABLE）和 %s' % header,
+        ' */',
+        '',
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+    ]
+    if includes:
+        lines.extend('#include "%s"' % inc for inc in includes)
+        lines.append('')
+    for code in blocks:
+        lines.append(code)
+        lines.append('')
+    lines.append('/**')
+    lines.append(' * @brief 本文件中全部描述符的列表（用于主机端工具等需要遍历描述符的场景）')
+    lines.append(' */')
+    lines.append('#define %s \\' % list_name)
+    names = [s['name'] for s in structs]
+    for i, n in enumerate(names):
+        lines.append('    &%s_desc%s' % (n, ', \\' if i < len(names) - 1 else ''))
+    lines.append('')
+    lines.append('#endif /* %s */' % guard)
+    lines.append('')
+    return '\n'.join(lines)
+
+
+def generate_generic_file(out_path, desc_files, structs):
+    """生成汇总全部结构体的 GET_STRUCT_DESC 映射文件"""
+    guard, _ = guard_and_list_names(out_path)
+    out_dir = os.path.dirname(os.path.abspath(out_path))
+    lines = [
+        '/**',
+        ' * @file %s' % os.path.basename(out_path),
+        ' * @brief 自动类型推导宏（用于 STRUCT_PRINT(var)）',
+        ' * @note 由 gen_descriptor.py 自动生成，请勿手工修改',
+        ' * @note 使用前需先包含 struct_print.h 和各结构体定义头文件',
+        ' */',
+        '',
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+    ]
+    for path in desc_files:
+        lines.append('#include "%s"' % os.path.relpath(os.path.abspath(path), out_dir).replace(os.sep, '/'))
+    lines.extend([
+        '',
+        '#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L',
+        '',
+        '/**',
+        ' * @brief 自动选择描述符宏（使用 C11 _Generic）',
+        ' */',
+        '#undef GET_STRUCT_DESC',
+        '#define GET_STRUCT_DESC(var) _Generic((var), \\',
+    ])
+    for s in structs:
+        lines.append('    %s: &%s_desc, \\' % (s['ctype'], s['name']))
+    lines.append('    default: NULL \\')
+    lines.append(')')
+    lines.append('')
+    lines.append('#endif')
+    lines.append('')
+    lines.append('#endif /* %s */' % guard)
+    lines.append('')
+    return '\n'.join(lines)
+
+
+# ============================================================================
+#                           增量生成
+# ============================================================================
+
+def collect_inputs(paths, generated):
+    """展开目录，返回按路径排序的头文件列表（跳过生成的文件）"""
+    result = []
+    for p in paths:
+        if os.path.isdir(p):
+            for root, dirs, files in os.walk(p):
+                dirs[:] = sorted(d for d in dirs if not d.startswith('.'))
+                for f in sorted(files):
+                    if f.endswith('.h') and not f.endswith('_desc.h'):
+                        result.append(os.path.normpath(os.path.join(root, f)))
+        elif os.path.isfile(p):
+            result.append(os.path.normpath(p))
+        else:
+            warn('找不到输入 %s' % p)
+    return [p for p in result if os.path.abspath(p) not in generated]
+
+
+def load_cache(path):
+    try:
+        with open(path, 'r', encoding='utf-8') as f:
+            cache = json.load(f)
+        if cache.get('version') == CACHE_VERSION:
+            return cache.get('files', {})
+    except (IOError, OSError, ValueError):
+        pass
+    return {}
+
+
+def write_if_changed(path, content):
+    """内容变化时才写文件，返回是否写入"""
+    try:
+        with open(path, 'r', encoding='utf-8') as f:
+            if f.read() == content:
+                return False
+    except (IOError, OSError):
+        pass
+    d = os.path.dirname(path)
+    if d and not os.path.isdir(d):
+        os.makedirs(d)
+    with open(path, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(content)
+    return True
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description='为 struct_print.h 生成结构体描述符（增量）')
+    ap.add_argument('inputs', nargs='+', help='头文件或目录（目录递归扫描 *.h，跳过 *_desc.h）')
+    ap.add_argument('-o', '--output', help='输出文件（仅一个输入头文件时可用）')
+    ap.add_argument('--out-dir', help='输出目录（默认与头文件同目录）')
+    ap.add_argument('--generic', help='生成包含全部结构体的 GET_STRUCT_DESC 映射文件')
+    ap.add_argument('--cache', help='缓存文件（默认 %s，位于输出目录或当前目录）' % DEFAULT_CACHE_NAME)
+    ap.add_argument('--force', action='store_true', help='忽略缓存，重新解析全部头文件')
+    ap.add_argument('-v', '--verbose', action='store_true', help='输出统计信息')
+    args = ap.parse_args(argv)
+
+    start = time.time()
+    generated = set()
+    if args.output:
+        generated.add(os.path.abspath(args.output))
+    if args.generic:
+        generated.add(os.path.abspath(args.generic))
+
+    inputs = collect_inputs(args.inputs, generated)
+    if args.output and len(inputs) != 1:
+        ap.error('-o 只能用于单个输入头文件')
+
+    cache_path = args.cache or os.path.join(args.out_dir or '.', DEFAULT_CACHE_NAME)
+    old_cache = {} if args.force else load_cache(cache_path)
+    new_cache = {}
+    parsed = 0
+
+    # 1. 解析（内容哈希未变化的头文件直接使用缓存的解析结果）
+    for path in inputs:
+        with open(path, 'rb') as f:
+            data = f.read()
+        digest = hashlib.sha1(data).hexdigest()
+        entry = old_cache.get(path)
+        if entry is None or entry.get('sha1') != digest:
+            entry = {'sha1': digest, 'structs': parse_header(data.decode('utf-8', 'replace'), path)}
+            parsed += 1
+        new_cache[path] = entry
+
+    # 2. 建立全局结构体表（跨文件嵌套需要）
+    known, owner, outputs = {}, {}, {}
+    for path in inputs:
+        structs = new_cache[path]['structs']
+        if not structs:
+            continue
+        if args.output:
+            out = args.output
+        else:
+            base = os.path.splitext(os.path.basename(path))[0] + '_desc.h'
+            out = os.path.join(args.out_dir or os.path.dirname(path), base)
+        outputs[path] = out
+        for s in structs:
+            if s['name'] in owner:
+                warn('结构体 %s 重复定义（%s）' % (s['name'], path))
+            known[s['name']] = s['name']
+            if s['tag']:
+                known.setdefault(s['tag'], s['name'])
+            owner[s['name']] = out
+
+    # 3. 生成（只改写内容变化的文件）
+    written = 0
+    for path, out in outputs.items():
+        content = generate_desc_file(path, out, new_cache[path]['structs'], known, owner)
+        written += write_if_changed(out, content)
+
+    if args.generic:
+        structs = [s for p in inputs for s in new_cache[p]['structs']]
+        content = generate_generic_file(args.generic, [outputs[p] for p in inputs if p in outputs], structs)
+        written += write_if_changed(args.generic, content)
+
+    if new_cache != old_cache or args.force:
+        write_if_changed(cache_path, json.dumps({'version': CACHE_VERSION, 'files': new_cache},
+                                                indent=1, sort_keys=True) + '\n')
+
+    if args.verbose:
+        sys.stderr.write('头文件 %d 个（解析 %d，缓存 %d），结构体 %d 个，写入 %d 个文件，耗时 %.1f ms\n' % (
+            len(inputs), parsed, len(inputs) - parsed, len(owner), written, (time.time() - start) * 1000.0))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,1094 @@
+/**
+ * @file struct_log_decode.c
+ * @brief STRUCT_LOG 二进制日志解码工具（Linux 主机端）
+ * @author xingleixu@gmail.com
+ * @date 2025-10-18
+ *
+ * 设备端使用 STRUCT_LOG(var) 只输出 "描述符ID + 时间戳 + 结构体原始字节"，
+ * 本工具使用同一份描述符表，将日志帧还原为与 STRUCT_PRINT 相同的文本。
+ *
+ * 用法：
+ *   ./struct_log_decode [文件]        解码文件（省略时从标准输入读取）
+ *   ./struct_log_decode --json [文件] 每帧输出一行 NDJSON（便于日志采集工具直接读取）
+ *   ./struct_log_decode --demo        输出示例日志帧到标准输出
+ *   ./struct_log_decode --demo | ./struct_log_decode
+ *   ./struct_log_decode --cbor [文件] 解码 STRUCT_CBOR_TO 输出的 CBOR 序列（字段名来自数据流中的名称表）
+ *   ./struct_log_decode --cbor-demo   输出示例 CBOR 数据到标准输出
+ *   ./struct_log_decode --export-schema [--json]  导出描述符表的布局 Schema（CBOR，或 JSON）
+ *   ./struct_log_decode --demo-fingerprint        输出以布局指纹标识的示例日志帧
+ *   ./struct_log_decode --schema 文件 [--json] [文件]
+ *                                     按 Schema 文件（固件导出）中的布局解码带指纹的日志帧，
+ *                                     固件结构体布局与本工具编译时不同也能正确解码
+ *
+ * 使用自己的描述符编译：
+ *   gcc -std=c11 -DSTRUCT_LOG_TYPES_HEADER='"my_structs.h"' \
+ *       -DSTRUCT_LOG_DESC_HEADER='"my_structs_desc.h"' \
+ *       -DSTRUCT_LOG_DESC_LIST=MY_STRUCTS_DESC_LIST \
+ *       -o struct_log_decode struct_log_decode.c
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRUCT_PRINT_ENABLE
+#include "struct_print.h"
+
+/* ============================================================================
+ *                          描述符表配置
+ * ============================================================================ */
+
+/* 结构体定义头文件 */
+#ifndef STRUCT_LOG_TYPES_HEADER
+#define STRUCT_LOG_TYPES_HEADER "test_structs.h"
+#endif
+
+/* 描述符头文件 */
+#ifndef STRUCT_LOG_DESC_HEADER
+#define STRUCT_LOG_DESC_HEADER "test_structs_desc.h"
+#endif
+
+/* 描述符列表宏 */
+#ifndef STRUCT_LOG_DESC_LIST
+#define STRUCT_LOG_DESC_LIST TEST_STRUCTS_DESC_LIST
+#endif
+
+#include STRUCT_LOG_TYPES_HEADER
+#include STRUCT_LOG_DESC_HEADER
+
+static const StructDescriptor* const g_descs[] = { STRUCT_LOG_DESC_LIST };
+#define DESC_COUNT (sizeof(g_descs) / sizeof(g_descs[0]))
+
+/* 按描述符 ID 查找的注册表（描述符表很大时逐帧线性查找代价明显）*/
+static const StructDescriptor* g_registry_slots[4096];
+static u32 g_registry_ids[4096];
+static StructRegistry g_registry;
+
+/**
+ * @brief 注册描述符表
+ */
+static void registry_init(void)
+{
+    size_t i;
+
+    struct_registry_init(&g_registry, g_registry_slots, g_registry_ids, 4096);
+    for (i = 0; i < DESC_COUNT; i++) {
+        struct_registry_add(&g_registry, g_descs[i]);
+    }
+}
+
+
+/* ============================================================================
+ *                          输出
+ * ============================================================================ */
+
+/**
+ * @brief 输出到 FILE*
+ */
+static void file_flush(void* ctx, const char* data, size_t len)
+{
+    fwrite(data, 1, len, (FILE*)ctx);
+}
+
+
+/* ============================================================================
+ *                          示例日志（模拟设备端）
+ * ============================================================================ */
+
+/**
+ * @brief 输出一帧日志
+ * @param fingerprint 1 以布局指纹标识（相当于设备端定义 STRUCT_LOG_ID_FINGERPRINT=1）
+ */
+static void demo_log(StructPrintSink* sink, const StructDescriptor* desc, const void* data,
+                     u32 timestamp, int fingerprint)
+{
+    u8 header[STRUCT_LOG_HEADER_SIZE];
+    u8 trailer[STRUCT_LOG_TRAILER_SIZE];
+
+    if (!fingerprint) {
+        struct_log_to(sink, desc, data, timestamp);
+        return;
+    }
+    struct_log_write_header(header, struct_desc_fingerprint(desc), STRUCT_LOG_FLAG_FINGERPRINT,
+                            data, desc->struct_size, timestamp);
+    struct_log_build_trailer(trailer, header, data, desc->struct_size);
+    sink_write(sink, (const char*)header, sizeof(header));
+    sink_write(sink, (const char*)data, desc->struct_size);
+    sink_write(sink, (const char*)trailer, sizeof(trailer));
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 输出几帧示例日志，用于验证解码流程
+ * @param fingerprint 1 帧头携带布局指纹，0 携带名称哈希
+ */
+static void write_demo_frames(int fingerprint)
+{
+    char buf[256];
+    StructPrintSink sink;
+    DeviceInfo device;
+    SystemStatus status;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), file_flush, stdout, STRUCT_PRINT_SINK_FLUSH_FULL);
+
+    memset(&device, 0, sizeof(device));
+    device.device_id = 5;
+    device.firmware_version = 0x0102;
+    device.serial_number = 123456789;
+    device.temperature = 25.6f;
+    device.voltage = 3.3;
+    demo_log(&sink, &DeviceInfo_desc, &device, 1000, fingerprint);
+
+    memset(&status, 0, sizeof(status));
+    status.timestamp = 1697612345;
+    status.device = device;
+    status.sensor.sensor_id = 100;
+    status.sensor.value = -273;
+    status.sensor.status = 1;
+    status.error_code = 0;
+    demo_log(&sink, &SystemStatus_desc, &status, 1010, fingerprint);
+}
+
+
+/* ============================================================================
+ *                          解码
+ * ============================================================================ */
+
+static const StructDescriptor* layout_find(u32 fingerprint);
+
+/**
+ * @brief 查找帧对应的描述符
+ * @note 名称 ID 的帧在注册表中 O(1) 查找；带指纹的帧优先使用 --schema 加载的布局（O(1) 哈希查找），
+ *       找不到时再查编译进本工具的描述符表（只有布局完全一致时才会匹配）
+ */
+static const StructDescriptor* find_frame_desc(const StructLogFrame* frame)
+{
+    const StructDescriptor* desc;
+
+    if (!(frame->flags & STRUCT_LOG_FLAG_FINGERPRINT)) {
+        return struct_registry_find_id(&g_registry, frame->desc_id);
+    }
+    desc = layout_find(frame->desc_id);
+    return (desc != NULL) ? desc : struct_log_find_desc(frame, g_descs, DESC_COUNT);
+}
+
+/**
+ * @brief 解码输入流中的所有日志帧
+ * @param in 输入文件
+ * @param json 1 输出 NDJSON，0 输出与 STRUCT_PRINT 相同的文本
+ * @return 0 成功，1 失败
+ */
+static int decode_stream(FILE* in, int json)
+{
+    size_t cap = 64 * 1024;
+    size_t len = 0;
+    size_t skipped = 0;
+    unsigned long frames = 0;
+    u8* data = (u8*)malloc(cap);
+    u8* aligned = (u8*)malloc(0x10000);     /* 负载长度不超过 65535 */
+    char out_buf[4096];
+    StructPrintSink sink;
+
+    if (data == NULL || aligned == NULL) {
+        free(data);
+        free(aligned);
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+
+    struct_print_sink_init(&sink, out_buf, sizeof(out_buf), file_flush, stdout, STRUCT_PRINT_SINK_FLUSH_FULL);
+
+    for (;;) {
+        size_t pos = 0;
+        size_t n = fread(data + len, 1, cap - len, in);
+        int eof = (n == 0);
+
+        len += n;
+
+        /* 解析缓冲区中的完整帧 */
+        while (pos < len) {
+            StructLogFrame frame;
+            int ret = struct_log_parse(data + pos, len - pos, &frame);
+
+            if (ret > 0) {
+                const StructDescriptor* desc = find_frame_desc(&frame);
+
+                /* 负载在输入缓冲区中的位置不一定满足字段的对齐要求，复制后再按类型读取 */
+                memcpy(aligned, frame.payload, frame.payload_len);
+                frame.payload = aligned;
+                if (json) {
+                    struct_log_json(&sink, &frame, desc);
+                } else {
+                    struct_log_print(&sink, &frame, desc);
+                }
+                pos += (size_t)ret;
+                frames++;
+            } else if (ret < 0 || eof) {
+                pos++;          /* 重新同步（输入结束时不完整的帧同样丢弃）*/
+                skipped++;
+            } else {
+                break;          /* 需要更多数据 */
+            }
+        }
+
+        memmove(data, data + pos, len - pos);
+        len -= pos;
+
+        if (eof) break;
+
+        /* 单帧大于缓冲区时扩容 */
+        if (len == cap) {
+            u8* bigger = (u8*)realloc(data, cap * 2);
+            if (bigger == NULL) {
+                free(data);
+                free(aligned);
+                fprintf(stderr, "内存不足\n");
+                return 1;
+            }
+            data = bigger;
+            cap *= 2;
+        }
+    }
+
+    struct_print_sink_flush(&sink);
+    free(aligned);
+    free(data);
+    fprintf(stderr, "解码 %lu 帧，跳过 %lu 字节\n", frames, (unsigned long)(skipped + len));
+    return 0;
+}
+
+
+/* ============================================================================
+ *                          CBOR 示例与解码
+ * ============================================================================ */
+
+/**
+ * @brief 输出示例 CBOR 数据（名称表只在每种类型首次出现时发送）
+ */
+static void write_cbor_demo(void)
+{
+    char buf[256];
+    StructPrintSink sink;
+    StructCborSession session = STRUCT_CBOR_SESSION_INIT;
+    DeviceInfo device;
+    SystemStatus status;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), file_flush, stdout, STRUCT_PRINT_SINK_FLUSH_FULL);
+
+    memset(&device, 0, sizeof(device));
+    device.device_id = 5;
+    device.firmware_version = 0x0102;
+    device.serial_number = 123456789;
+    device.temperature = 25.6f;
+    device.voltage = 3.3;
+    struct_cbor_record(&session, &sink, &DeviceInfo_desc, &device, 1000);
+
+    memset(&status, 0, sizeof(status));
+    status.timestamp = 1697612345;
+    status.device = device;
+    status.sensor.sensor_id = 100;
+    status.sensor.value = -273;
+    status.sensor.status = 1;
+    struct_cbor_record(&session, &sink, &SystemStatus_desc, &status, 1010);
+
+    device.temperature = 26.1f;
+    struct_cbor_record(&session, &sink, &DeviceInfo_desc, &device, 1020);
+
+    struct_print_sink_flush(&sink);
+}
+
+/**
+ * @brief 名称表中的字段
+ */
+typedef struct {
+    char* name;                 /* 字段名 */
+    int has_nested;             /* 是否为嵌套结构体（数组）*/
+    u32 nested_id;              /* 嵌套结构体的描述符 ID */
+} CborField;
+
+/**
+ * @brief 数据流中收到的名称表
+ */
+typedef struct {
+    u32 id;                     /* 描述符 ID */
+    char* name;                 /* 结构体名 */
+    size_t field_count;
+    CborField* fields;
+} CborSchema;
+
+/* 嵌套层数上限（防止异常输入导致递归过深）*/
+#define CBOR_MAX_DEPTH 64
+
+static CborSchema* g_schemas;
+static size_t g_schema_count;
+
+/**
+ * @brief CBOR 读取位置
+ */
+typedef struct {
+    const u8* p;
+    const u8* end;
+} CborReader;
+
+/**
+ * @brief 读取数据项头部
+ * @param r 读取位置
+ * @param major 主类型
+ * @param info 附加信息（低 5 位）
+ * @param arg 参数值
+ * @return 0 成功，-1 数据不完整或不支持（不定长编码）
+ */
+static int cbor_read_head(CborReader* r, int* major, int* info, uint64_t* arg)
+{
+    int n;
+    int i;
+
+    if (r->p >= r->end) return -1;
+    *major = *r->p >> 5;
+    *info = *r->p & 0x1F;
+    r->p++;
+
+    if (*info < 24) {
+        *arg = (uint64_t)*info;
+        return 0;
+    }
+    if (*info > 27) return -1;
+
+    n = 1 << (*info - 24);
+    if (r->end - r->p < n) return -1;
+    *arg = 0;
+    for (i = 0; i < n; i++) {
+        *arg = (*arg << 8) | *r->p++;
+    }
+    return 0;
+}
+
+/**
+ * @brief 读取文本串，返回新分配的 C 字符串（失败返回 NULL）
+ */
+static char* cbor_read_text(CborReader* r)
+{
+    int major, info;
+    uint64_t len;
+    char* text;
+
+    if (cbor_read_head(r, &major, &info, &len) != 0 || major != 3) return NULL;
+    if ((uint64_t)(r->end - r->p) < len) return NULL;
+    text = (char*)malloc((size_t)len + 1);
+    if (text == NULL) return NULL;
+    memcpy(text, r->p, (size_t)len);
+    text[len] = '\0';
+    r->p += len;
+    return text;
+}
+
+/**
+ * @brief 读取无符号整数
+ */
+static int cbor_read_uint(CborReader* r, uint64_t* value)
+{
+    int major, info;
+    return (cbor_read_head(r, &major, &info, value) == 0 && major == 0) ? 0 : -1;
+}
+
+/**
+ * @brief 跳过一个数据项
+ * @param depth 当前嵌套层数
+ */
+static int cbor_skip(CborReader* r, int depth)
+{
+    int major, info;
+    uint64_t arg, i;
+
+    if (depth > CBOR_MAX_DEPTH || cbor_read_head(r, &major, &info, &arg) != 0) return -1;
+    switch (major) {
+        case 2:
+        case 3:
+            if ((uint64_t)(r->end - r->p) < arg) return -1;
+            r->p += arg;
+            return 0;
+        case 4:
+        case 5:
+            for (i = 0; i < (major == 5 ? arg * 2 : arg); i++) {
+                if (cbor_skip(r, depth + 1) != 0) return -1;
+            }
+            return 0;
+        case 6:
+            return cbor_skip(r, depth + 1);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief 按描述符 ID 查找名称表
+ */
+static CborSchema* cbor_find_schema(u32 id)
+{
+    size_t i;
+    for (i = 0; i < g_schema_count; i++) {
+        if (g_schemas[i].id == id) return &g_schemas[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 释放名称表内容
+ */
+static void cbor_free_schema(CborSchema* schema)
+{
+    size_t i;
+    for (i = 0; i < schema->field_count; i++) {
+        free(schema->fields[i].name);
+    }
+    free(schema->fields);
+    free(schema->name);
+}
+
+/**
+ * @brief 读取名称表：[0, id, "name", [字段...]]（已读取类型）
+ * @return 0 成功，-1 格式错误
+ */
+static int cbor_read_schema(CborReader* r)
+{
+    CborSchema schema;
+    CborSchema* slot;
+    uint64_t id, count, i;
+    int major, info;
+
+    memset(&schema, 0, sizeof(schema));
+    if (cbor_read_uint(r, &id) != 0) return -1;
+    schema.id = (u32)id;
+    schema.name = cbor_read_text(r);
+    if (schema.name == NULL) return -1;
+    if (cbor_read_head(r, &major, &info, &count) != 0 || major != 4 ||
+        count > (uint64_t)(r->end - r->p)) {
+        free(schema.name);
+        return -1;
+    }
+
+    schema.fields = (CborField*)calloc((size_t)count + 1, sizeof(CborField));
+    if (schema.fields == NULL) {
+        free(schema.name);
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        CborField* field = &schema.fields[i];
+        CborReader peek = *r;
+        uint64_t n, nested;
+
+        schema.field_count = (size_t)i + 1;
+        if (cbor_read_head(&peek, &major, &info, &n) != 0) break;
+        if (major == 4 && n == 2) {
+            r->p = peek.p;
+            field->name = cbor_read_text(r);
+            if (field->name == NULL || cbor_read_uint(r, &nested) != 0) break;
+            field->has_nested = 1;
+            field->nested_id = (u32)nested;
+        } else {
+            field->name = cbor_read_text(r);
+            if (field->name == NULL) break;
+        }
+    }
+    if (i < count) {
+        cbor_free_schema(&schema);
+        return -1;
+    }
+
+    /* 同一 ID 再次出现（新会话）时替换旧的名称表 */
+    slot = cbor_find_schema(schema.id);
+    if (slot != NULL) {
+        cbor_free_schema(slot);
+    } else {
+        CborSchema* bigger = (CborSchema*)realloc(g_schemas, (g_schema_count + 1) * sizeof(CborSchema));
+        if (bigger == NULL) {
+            cbor_free_schema(&schema);
+            return -1;
+        }
+        g_schemas = bigger;
+        slot = &g_schemas[g_schema_count++];
+    }
+    *slot = schema;
+    return 0;
+}
+
+/**
+ * @brief 输出浮点数（与 STRUCT_PRINT_JSON 相同的格式）
+ */
+static void cbor_put_json_double(StructPrintSink* out, double value)
+{
+    if (value != value || value - value != 0.0) {
+        sink_puts(out, "null");
+    } else {
+        sink_put_double(out, value);
+    }
+}
+
+/**
+ * @brief 将一个数据项转换为 JSON
+ * @param r 读取位置
+ * @param out 输出缓冲区
+ * @param schema map 使用的名称表（NULL 时字段名输出为 "#序号"）
+ * @param depth 当前嵌套层数
+ * @return 0 成功，-1 格式错误
+ */
+static int cbor_render(CborReader* r, StructPrintSink* out, const CborSchema* schema, int depth)
+{
+    char num[STRUCT_PRINT_FMT_DOUBLE_MAX];
+    int major, info;
+    uint64_t arg, i;
+
+    if (depth > CBOR_MAX_DEPTH || cbor_read_head(r, &major, &info, &arg) != 0) return -1;
+
+    switch (major) {
+        case 0:
+            sink_write(out, num, fmt_u64_dec(num, arg));
+            return 0;
+
+        case 1:
+            /* 值为 -1-arg */
+            sink_putc(out, '-');
+            if (arg == UINT64_MAX) {
+                sink_puts(out, "18446744073709551616");
+            } else {
+                sink_write(out, num, fmt_u64_dec(num, arg + 1));
+            }
+            return 0;
+
+        case 2:
+            if ((uint64_t)(r->end - r->p) < arg) return -1;
+            sink_putc(out, '[');
+            for (i = 0; i < arg; i++) {
+                if (i > 0) sink_putc(out, ',');
+                sink_put_u32(out, r->p[i]);
+            }
+            sink_putc(out, ']');
+            r->p += arg;
+            return 0;
+
+        case 3:
+            if ((uint64_t)(r->end - r->p) < arg) return -1;
+            json_put_string(out, (const char*)r->p, (size_t)arg);
+            r->p += arg;
+            return 0;
+
+        case 4:
+            /* 结构体数组的每个元素使用同一张名称表 */
+            sink_putc(out, '[');
+            for (i = 0; i < arg; i++) {
+                if (i > 0) sink_putc(out, ',');
+                if (cbor_render(r, out, schema, depth + 1) != 0) return -1;
+            }
+            sink_putc(out, ']');
+            return 0;
+
+        case 5:
+            sink_putc(out, '{');
+            for (i = 0; i < arg; i++) {
+                const CborSchema* nested = NULL;
+                uint64_t key;
+
+                if (i > 0) sink_putc(out, ',');
+                if (cbor_read_uint(r, &key) != 0) return -1;
+                if (schema != NULL && key < schema->field_count) {
+                    const CborField* field = &schema->fields[key];
+                    json_put_string(out, field->name, strlen(field->name));
+                    if (field->has_nested) nested = cbor_find_schema(field->nested_id);
+                } else {
+                    sink_puts(out, "\"#");
+                    sink_write(out, num, fmt_u64_dec(num, key));
+                    sink_putc(out, '"');
+                }
+                sink_putc(out, ':');
+                if (cbor_render(r, out, nested, depth + 1) != 0) return -1;
+            }
+            sink_putc(out, '}');
+            return 0;
+
+        case 6:
+            return cbor_render(r, out, schema, depth + 1);
+
+        default:
+            if (info == 20 || info == 21) {
+                sink_puts(out, info == 21 ? "true" : "false");
+            } else if (info == 26) {
+                u32 bits = (u32)arg;
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                cbor_put_json_double(out, value);
+            } else if (info == 27) {
+                double value;
+                memcpy(&value, &arg, sizeof(value));
+                cbor_put_json_double(out, value);
+            } else {
+                sink_puts(out, "null");
+            }
+            return 0;
+    }
+}
+
+/**
+ * @brief 读入全部输入
+ * @param in 输入文件
+ * @param out_len 数据长度
+ * @return 数据（调用者 free）；内存不足返回 NULL
+ */
+static u8* read_all(FILE* in, size_t* out_len)
+{
+    size_t cap = 64 * 1024;
+    size_t len = 0;
+    u8* data = (u8*)malloc(cap);
+
+    if (data == NULL) return NULL;
+    for (;;) {
+        size_t n = fread(data + len, 1, cap - len, in);
+        len += n;
+        if (n == 0) break;
+        if (len == cap) {
+            u8* bigger = (u8*)realloc(data, cap * 2);
+            if (bigger == NULL) {
+                free(data);
+                return NULL;
+            }
+            data = bigger;
+            cap *= 2;
+        }
+    }
+    *out_len = len;
+    return data;
+}
+
+/**
+ * @brief 解码 CBOR 序列：名称表保存下来，记录输出为 NDJSON
+ * @param in 输入文件
+ * @return 0 成功，1 失败
+ */
+static int decode_cbor(FILE* in)
+{
+    size_t len = 0;
+    unsigned long records = 0;
+    u8* data = read_all(in, &len);
+    char out_buf[4096];
+    StructPrintSink out;
+    CborReader r;
+    size_t i;
+
+    if (data == NULL) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+
+    struct_print_sink_init(&out, out_buf, sizeof(out_buf), file_flush, stdout, STRUCT_PRINT_SINK_FLUSH_FULL);
+    r.p = data;
+    r.end = data + len;
+
+    while (r.p < r.end) {
+        int major, info;
+        uint64_t count, kind;
+
+        if (cbor_read_head(&r, &major, &info, &count) != 0 || major != 4 || count < 1 ||
+            cbor_read_uint(&r, &kind) != 0) {
+            break;
+        }
+
+        if (kind == STRUCT_CBOR_SCHEMA && count == 4) {
+            if (cbor_read_schema(&r) != 0) break;
+        } else if (kind == STRUCT_CBOR_RECORD && count == 4) {
+            uint64_t id, timestamp;
+            const CborSchema* schema;
+
+            if (cbor_read_uint(&r, &id) != 0 || cbor_read_uint(&r, &timestamp) != 0) break;
+            schema = cbor_find_schema((u32)id);
+
+            sink_puts(&out, "{\"t\":");
+            sink_put_u32(&out, (u32)timestamp);
+            if (schema != NULL) {
+                sink_puts(&out, ",\"struct\":");
+                json_put_string(&out, schema->name, strlen(schema->name));
+            } else {
+                sink_puts(&out, ",\"id\":\"0x");
+                sink_put_hex(&out, (u32)id, 8);
+                sink_putc(&out, '"');
+            }
+            sink_puts(&out, ",\"value\":");
+            if (cbor_render(&r, &out, schema, 0) != 0) break;
+            sink_putc(&out, '}');
+            sink_endline(&out);
+            records++;
+        } else {
+            /* 未知的数据项（更新版本的编码器）：跳过其余元素 */
+            for (i = 1; i < count; i++) {
+                if (cbor_skip(&r, 0) != 0) break;
+            }
+            if (i < count) break;
+        }
+    }
+    struct_print_sink_flush(&out);
+
+    fprintf(stderr, "解码 %lu 条记录，%lu 个名称表，剩余 %lu 字节未解析\n",
+            records, (unsigned long)g_schema_count, (unsigned long)(r.end - r.p));
+
+    for (i = 0; i < g_schema_count; i++) {
+        cbor_free_schema(&g_schemas[i]);
+    }
+    free(g_schemas);
+    free(data);
+    return 0;
+}
+
+
+/* ============================================================================
+ *                          布局 Schema（描述符指纹）
+ * ============================================================================ */
+
+/**
+ * @brief 从 Schema 文件重建的描述符
+ */
+typedef struct {
+    StructDescriptor desc;      /* 运行时描述符（名称与字段表为堆内存）*/
+    FieldDescriptor* fields;
+    u32* nested_fp;             /* 每个字段引用的嵌套结构体指纹（0 表示不是结构体）*/
+    int state;                  /* 环检测：0 未访问，1 访问中，2 已完成 */
+} LayoutSchema;
+
+static LayoutSchema* g_layouts;
+static size_t g_layout_count;
+static size_t* g_layout_slots;  /* 开放寻址哈希表：指纹 -> g_layouts 下标 + 1 */
+static size_t g_layout_mask;
+
+/**
+ * @brief 按指纹查找布局（O(1)）
+ */
+static const StructDescriptor* layout_find(u32 fingerprint)
+{
+    size_t i;
+
+    if (g_layout_slots == NULL) return NULL;
+    for (i = fingerprint & g_layout_mask; g_layout_slots[i] != 0; i = (i + 1) & g_layout_mask) {
+        const LayoutSchema* layout = &g_layouts[g_layout_slots[i] - 1];
+        if (layout->desc.fingerprint == fingerprint) return &layout->desc;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 标量字段类型的大小（解码时按类型读取，Schema 中的大小必须一致）
+ */
+static size_t layout_type_size(FieldType type)
+{
+    switch (type) {
+        case FIELD_TYPE_U8:
+        case FIELD_TYPE_S8:
+        case FIELD_TYPE_STRING: return 1;
+        case FIELD_TYPE_U16:
+        case FIELD_TYPE_S16:    return 2;
+        case FIELD_TYPE_U32:
+        case FIELD_TYPE_S32:
+        case FIELD_TYPE_FLOAT:  return 4;
+        case FIELD_TYPE_DOUBLE: return 8;
+        default:                return 0;
+    }
+}
+
+/**
+ * @brief 释放布局内容
+ */
+static void layout_free(LayoutSchema* layout)
+{
+    size_t i;
+    for (i = 0; i < layout->desc.field_count; i++) {
+        free((void*)layout->fields[i].name);
+    }
+    free(layout->fields);
+    free(layout->nested_fp);
+    free((void*)layout->desc.struct_name);
+}
+
+/**
+ * @brief 读取布局：[2, 指纹, "name", 大小, [字段...]]（已读取类型）
+ * @return 0 成功，-1 格式错误
+ * @note 偏移、大小均做越界检查，Schema 文件损坏时不会读出负载以外的内存
+ */
+static int layout_read(CborReader* r)
+{
+    LayoutSchema layout;
+    LayoutSchema* bigger;
+    uint64_t fingerprint, size, count, i;
+    int major, info;
+
+    memset(&layout, 0, sizeof(layout));
+    if (cbor_read_uint(r, &fingerprint) != 0 || fingerprint == 0 || fingerprint > 0xFFFFFFFFu) return -1;
+    layout.desc.struct_name = cbor_read_text(r);
+    if (layout.desc.struct_name == NULL) return -1;
+    if (cbor_read_uint(r, &size) != 0 || size > 0xFFFFu ||
+        cbor_read_head(r, &major, &info, &count) != 0 || major != 4 ||
+        count > (uint64_t)(r->end - r->p)) {
+        layout_free(&layout);
+        return -1;
+    }
+    layout.desc.struct_size = (size_t)size;
+    layout.desc.fingerprint = (u32)fingerprint;
+
+    layout.fields = (FieldDescriptor*)calloc((size_t)count + 1, sizeof(FieldDescriptor));
+    layout.nested_fp = (u32*)calloc((size_t)count + 1, sizeof(u32));
+    layout.desc.fields = layout.fields;
+    if (layout.fields == NULL || layout.nested_fp == NULL) {
+        layout_free(&layout);
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        FieldDescriptor* field = &layout.fields[i];
+        uint64_t n, type, offset, field_size, array_count, nested = 0;
+
+        layout.desc.field_count = (size_t)i + 1;
+        if (cbor_read_head(r, &major, &info, &n) != 0 || major != 4 || (n != 5 && n != 6)) break;
+        field->name = cbor_read_text(r);
+        if (field->name == NULL ||
+            cbor_read_uint(r, &type) != 0 || cbor_read_uint(r, &offset) != 0 ||
+            cbor_read_uint(r, &field_size) != 0 || cbor_read_uint(r, &array_count) != 0 ||
+            (n == 6 && cbor_read_uint(r, &nested) != 0)) {
+            break;
+        }
+        /* 结构体字段必须带嵌套指纹；其他类型的大小必须与类型一致 */
+        if (type > FIELD_TYPE_STRUCT || (type == FIELD_TYPE_STRUCT) != (n == 6) ||
+            (type != FIELD_TYPE_STRUCT && field_size != layout_type_size((FieldType)type)) ||
+            nested > 0xFFFFFFFFu || field_size > 0xFFFFu || array_count > 0xFFFFu ||
+            offset + field_size * (array_count > 0 ? array_count : 1) > size) {
+            break;
+        }
+        field->type = (FieldType)type;
+        field->offset = (size_t)offset;
+        field->size = (size_t)field_size;
+        field->array_count = (size_t)array_count;
+        layout.nested_fp[i] = (u32)nested;
+    }
+    if (i < count) {
+        layout_free(&layout);
+        return -1;
+    }
+
+    bigger = (LayoutSchema*)realloc(g_layouts, (g_layout_count + 1) * sizeof(LayoutSchema));
+    if (bigger == NULL) {
+        layout_free(&layout);
+        return -1;
+    }
+    g_layouts = bigger;
+    g_layouts[g_layout_count++] = layout;
+    return 0;
+}
+
+/**
+ * @brief 检查嵌套关系中没有环（否则打印时会无限递归）
+ */
+static int layout_check_cycle(LayoutSchema* layout)
+{
+    size_t i;
+
+    if (layout->state == 1) return -1;
+    if (layout->state == 2) return 0;
+    layout->state = 1;
+    for (i = 0; i < layout->desc.field_count; i++) {
+        const StructDescriptor* nested = layout->fields[i].nested_desc;
+        if (nested != NULL && layout_check_cycle((LayoutSchema*)(void*)nested) != 0) return -1;
+    }
+    layout->state = 2;
+    return 0;
+}
+
+/**
+ * @brief 加载 Schema 文件（struct_schema_export_cbor 的输出）
+ * @return 0 成功，1 失败
+ */
+static int load_schema(const char* path)
+{
+    FILE* in = fopen(path, "rb");
+    size_t len = 0;
+    size_t cap = 1;
+    size_t i, j;
+    u8* data;
+    CborReader r;
+
+    if (in == NULL) {
+        perror(path);
+        return 1;
+    }
+    data = read_all(in, &len);
+    fclose(in);
+    if (data == NULL) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+
+    r.p = data;
+    r.end = data + len;
+    while (r.p < r.end) {
+        int major, info;
+        uint64_t count, kind;
+
+        if (cbor_read_head(&r, &major, &info, &count) != 0 || major != 4 || count < 1 ||
+            cbor_read_uint(&r, &kind) != 0) {
+            break;
+        }
+        if (kind == STRUCT_CBOR_LAYOUT && count == 5) {
+            if (layout_read(&r) != 0) break;
+        } else {
+            for (i = 1; i < count; i++) {
+                if (cbor_skip(&r, 0) != 0) break;
+            }
+            if (i < count) break;
+        }
+    }
+    free(data);
+    if (r.p != r.end) {
+        fprintf(stderr, "%s: Schema 格式错误（偏移 %lu）\n", path, (unsigned long)(len - (size_t)(r.end - r.p)));
+        return 1;
+    }
+
+    /* 哈希表容量取不小于 2 倍布局数的 2 的幂，装载因子不超过 0.5 */
+    while (cap < g_layout_count * 2) cap *= 2;
+    g_layout_slots = (size_t*)calloc(cap, sizeof(size_t));
+    if (g_layout_slots == NULL) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+    g_layout_mask = cap - 1;
+    for (i = 0; i < g_layout_count; i++) {
+        u32 fingerprint = g_layouts[i].desc.fingerprint;
+        size_t slot = fingerprint & g_layout_mask;
+
+        while (g_layout_slots[slot] != 0 && g_layouts[g_layout_slots[slot] - 1].desc.fingerprint != fingerprint) {
+            slot = (slot + 1) & g_layout_mask;
+        }
+        g_layout_slots[slot] = i + 1;   /* 重复的指纹以后出现的为准 */
+    }
+
+    /* 所有布局都读入后（数组不再移动）再连接嵌套结构体 */
+    for (i = 0; i < g_layout_count; i++) {
+        LayoutSchema* layout = &g_layouts[i];
+
+        for (j = 0; j < layout->desc.field_count; j++) {
+            const StructDescriptor* nested;
+
+            if (layout->nested_fp[j] == 0) continue;
+            nested = layout_find(layout->nested_fp[j]);
+            if (nested == NULL || nested->struct_size != layout->fields[j].size) {
+                fprintf(stderr, "%s: %s.%s 引用的结构体 0x%08X 缺失或大小不符\n", path,
+                        layout->desc.struct_name, layout->fields[j].name, (unsigned)layout->nested_fp[j]);
+                return 1;
+            }
+            layout->fields[j].nested_desc = nested;
+        }
+    }
+    for (i = 0; i < g_layout_count; i++) {
+        LayoutSchema* layout = &g_layouts[i];
+
+        if (layout_check_cycle(layout) != 0) {
+            fprintf(stderr, "%s: %s 的嵌套关系存在环\n", path, layout->desc.struct_name);
+            return 1;
+        }
+        if (struct_layout_fingerprint(layout->desc.struct_name, layout->desc.struct_size,
+                                      layout->fields, layout->desc.field_count) != layout->desc.fingerprint) {
+            fprintf(stderr, "%s: 警告：%s 的指纹与布局不一致\n", path, layout->desc.struct_name);
+        }
+    }
+
+    fprintf(stderr, "加载 Schema：%lu 个结构体\n", (unsigned long)g_layout_count);
+    return 0;
+}
+
+/**
+ * @brief 释放已加载的 Schema
+ */
+static void free_schema(void)
+{
+    size_t i;
+    for (i = 0; i < g_layout_count; i++) {
+        layout_free(&g_layouts[i]);
+    }
+    free(g_layouts);
+    free(g_layout_slots);
+}
+
+/**
+ * @brief 导出编译进本工具的描述符表（模拟固件端 struct_schema_export_xxx）
+ * @param json 1 导出 JSON，0 导出 CBOR
+ */
+static void export_schema(int json)
+{
+    char buf[256];
+    StructPrintSink sink;
+
+    struct_print_sink_init(&sink, buf, sizeof(buf), file_flush, stdout, STRUCT_PRINT_SINK_FLUSH_FULL);
+    if (json) {
+        struct_schema_export_json(&sink, g_descs, DESC_COUNT);
+    } else {
+        struct_schema_export_cbor(&sink, g_descs, DESC_COUNT);
+    }
+}
+
+
+/* ============================================================================
+ *                          主函数
+ * ============================================================================ */
+
+int main(int argc, char* argv[])
+{
+    FILE* in = stdin;
+    int json = 0;
+    int cbor = 0;
+    int arg = 1;
+    int ret;
+
+    if (argc > 1 && strcmp(argv[1], "--demo") == 0) {
+        write_demo_frames(0);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--demo-fingerprint") == 0) {
+        write_demo_frames(1);
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--cbor-demo") == 0) {
+        write_cbor_demo();
+        return 0;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--export-schema") == 0) {
+        export_schema(argc > 2 && strcmp(argv[2], "--json") == 0);
+        return 0;
+    }
+
+    if (arg + 1 < argc && strcmp(argv[arg], "--schema") == 0) {
+        if (load_schema(argv[arg + 1]) != 0) {
+            free_schema();
+            return 1;
+        }
+        arg += 2;
+    }
+
+    if (arg < argc && strcmp(argv[arg], "--json") == 0) {
+        json = 1;
+        arg++;
+    } else if (arg < argc && strcmp(argv[arg], "--cbor") == 0) {
+        cbor = 1;
+        arg++;
+    }
+
+    if (arg < argc && strcmp(argv[arg], "-") != 0) {
+        in = fopen(argv[arg], "rb");
+        if (in == NULL) {
+            perror(argv[arg]);
+            free_schema();
+            return 1;
+        }
+    }
+
+    registry_init();
+    ret = cbor ? decode_cbor(in) : decode_stream(in, json);
+
+    if (in != stdin) fclose(in);
+    free_schema();
+    return ret;
+}
@@ -44,26 +44,47 @@ extern "C" {
 
 /**
  * @brief 配置选项
+ * @note 显示相关的选项（地址、偏移、十六进制、缩进）是 StructPrintOptions 的默认值，运行时可按次或全局修改
  */
 #ifdef STRUCT_PRINT_ENABLE
 
 /* 是否显示内存地址 */
+#ifndef STRUCT_PRINT_SHOW_ADDRESS
 #define STRUCT_PRINT_SHOW_ADDRESS       1
+#endif
 
 /* 是否显示字段偏移量 */
+#ifndef STRUCT_PRINT_SHOW_OFFSET
 #define STRUCT_PRINT_SHOW_OFFSET        1
+#endif
 
 /* 是否显示内存十六进制数据 */
+#ifndef STRUCT_PRINT_SHOW_HEX_MEMORY
 #define STRUCT_PRINT_SHOW_HEX_MEMORY    1
+#endif
 
 /* 数组作为字符串显示的最大长度（超过则显示为数值数组） */
 #define STRUCT_PRINT_STRING_MAX_LEN     512
 
 /* 十六进制内存显示的字节数（每个字段） */
+#ifndef STRUCT_PRINT_HEX_BYTES
 #define STRUCT_PRINT_HEX_BYTES          16
+#endif
 
 /* 嵌套层级的缩进空格数 */
+#ifndef STRUCT_PRINT_INDENT_SPACES
 #define STRUCT_PRINT_INDENT_SPACES      2
+#endif
+
+/* 浮点数显示的小数位数（0~9） */
+#ifndef STRUCT_PRINT_FLOAT_DECIMALS
+#define STRUCT_PRINT_FLOAT_DECIMALS     6
+#endif
+
+/* STRUCT_PRINT 默认行缓冲区大小（栈上分配，超长行会分多次输出） */
+#ifndef STRUCT_PRINT_LINE_BUF_SIZE
+#define STRUCT_PRINT_LINE_BUF_SIZE      128
+#endif
 
 #endif /* STRUCT_PRINT_ENABLE */
 
@@ -102,6 +123,26 @@ typedef int32_t  s32;
     #define STRUCT_PRINT_HAS_GENERIC 0  /* C99 或更低版本 */
 #endif
 
+/**
+ * @brief 检测 C++17 编译期描述符支持
+ * @note C++17 下 STRUCT_PRINT(var) 通过重载决议选择描述符，也兼容两参数写法
+ */
+#if defined(__cplusplus) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+    #define STRUCT_PRINT_HAS_CPP17 1
+#else
+    #define STRUCT_PRINT_HAS_CPP17 0
+#endif
+
+/**
+ * @brief 编译期求值修饰（C++17 下为 constexpr，C 下为空）
+ * @note 用于描述符指纹等纯计算函数，使 STRUCT_PRINT_REFLECT 的描述符在编译期得到指纹
+ */
+#if STRUCT_PRINT_HAS_CPP17
+    #define STRUCT_PRINT_CONSTEXPR constexpr
+#else
+    #define STRUCT_PRINT_CONSTEXPR
+#endif
+
 
 /* ============================================================================
  *                            字段类型枚举
@@ -134,6 +175,17 @@ typedef enum {
 
 /* 前向声明 */
 struct StructDescriptor_t;
+struct StructPrintContext_t;
+
+/**
+ * @brief 专用打印函数（由 STRUCT_DESC_SPECIALIZED 生成）
+ * @param ctx 打印上下文
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param indent_level 缩进层级
+ */
+typedef void (*StructPrintFn)(struct StructPrintContext_t* ctx, const char* var_name,
+                              const void* struct_data, int indent_level);
 
 /**
  * @brief 字段描述符结构
@@ -157,6 +209,9 @@ typedef struct StructDescriptor_t {
     size_t struct_size;                         /**< 结构体总大小（字节）*/
     size_t field_count;                         /**< 字段数量 */
     const FieldDescriptor* fields;              /**< 字段描述符数组指针 */
+    StructPrintFn print_fn;                     /**< 专用打印函数（NULL 使用通用解释器）*/
+    u32 fingerprint;                            /**< 布局指纹（0 表示运行时计算，见 struct_desc_fingerprint）*/
+    u32* fingerprint_cache;                     /**< 运行时计算的指纹缓存（END_STRUCT_DESC 定义，可为 NULL）*/
 } StructDescriptor;
 
 
@@ -164,6 +219,20 @@ typedef struct StructDescriptor_t {
  *                            辅助宏定义
  * ============================================================================ */
 
+/**
+ * @brief 字段大小（C++17 下同时在编译期检查 FIELD_* 宏与成员类型是否匹配）
+ * @note 例如 FIELD_U16 用在 u32 成员上会产生编译错误
+ */
+#if STRUCT_PRINT_HAS_CPP17
+#define STRUCT_PRINT_FIELD_SIZE(field_type, struct_type, field_name, size) \
+    struct_print_cpp::checked_size<field_type, decltype(((struct_type*)0)->field_name)>(size)
+#define STRUCT_PRINT_ELEM_SIZE(field_type, struct_type, field_name, size) \
+    struct_print_cpp::checked_elem_size<field_type, decltype(((struct_type*)0)->field_name)>(size)
+#else
+#define STRUCT_PRINT_FIELD_SIZE(field_type, struct_type, field_name, size) (size)
+#define STRUCT_PRINT_ELEM_SIZE(field_type, struct_type, field_name, size) (size)
+#endif
+
 /**
  * @brief 开始定义结构体描述符
  * @param struct_type 结构体类型名
@@ -186,7 +255,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_U8, \
         offsetof(struct_type, field_name), \
-        sizeof(u8), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_U8, struct_type, field_name, sizeof(u8)), \
         0, \
         NULL \
     }
@@ -199,7 +268,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_U16, \
         offsetof(struct_type, field_name), \
-        sizeof(u16), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_U16, struct_type, field_name, sizeof(u16)), \
         0, \
         NULL \
     }
@@ -212,7 +281,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_U32, \
         offsetof(struct_type, field_name), \
-        sizeof(u32), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_U32, struct_type, field_name, sizeof(u32)), \
         0, \
         NULL \
     }
@@ -225,7 +294,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_S8, \
         offsetof(struct_type, field_name), \
-        sizeof(s8), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_S8, struct_type, field_name, sizeof(s8)), \
         0, \
         NULL \
     }
@@ -238,7 +307,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_S16, \
         offsetof(struct_type, field_name), \
-        sizeof(s16), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_S16, struct_type, field_name, sizeof(s16)), \
         0, \
         NULL \
     }
@@ -251,7 +320,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_S32, \
         offsetof(struct_type, field_name), \
-        sizeof(s32), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_S32, struct_type, field_name, sizeof(s32)), \
         0, \
         NULL \
     }
@@ -269,7 +338,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_FLOAT, \
         offsetof(struct_type, field_name), \
-        sizeof(float), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_FLOAT, struct_type, field_name, sizeof(float)), \
         0, \
         NULL \
     }
@@ -282,7 +351,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_DOUBLE, \
         offsetof(struct_type, field_name), \
-        sizeof(double), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_DOUBLE, struct_type, field_name, sizeof(double)), \
         0, \
         NULL \
     }
@@ -297,7 +366,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_STRING, \
         offsetof(struct_type, field_name), \
-        sizeof(((struct_type*)0)->field_name[0]), \
+        STRUCT_PRINT_ELEM_SIZE(FIELD_TYPE_STRING, struct_type, field_name, sizeof(((struct_type*)0)->field_name[0])), \
         sizeof(((struct_type*)0)->field_name) / sizeof(((struct_type*)0)->field_name[0]), \
         NULL \
     }
@@ -313,7 +382,7 @@ typedef struct StructDescriptor_t {
         #field_name, \
         element_type, \
         offsetof(struct_type, field_name), \
-        sizeof(((struct_type*)0)->field_name[0]), \
+        STRUCT_PRINT_ELEM_SIZE(element_type, struct_type, field_name, sizeof(((struct_type*)0)->field_name[0])), \
         sizeof(((struct_type*)0)->field_name) / sizeof(((struct_type*)0)->field_name[0]), \
         NULL \
     }
@@ -329,11 +398,28 @@ typedef struct StructDescriptor_t {
         #field_name, \
         FIELD_TYPE_STRUCT, \
         offsetof(struct_type, field_name), \
-        sizeof(((struct_type*)0)->field_name), \
+        STRUCT_PRINT_FIELD_SIZE(FIELD_TYPE_STRUCT, struct_type, field_name, sizeof(((struct_type*)0)->field_name)), \
         0, \
         &nested_desc \
     }
 
+/**
+ * @brief 定义嵌套结构体数组字段
+ * @param struct_type 结构体类型
+ * @param field_name 字段名
+ * @param nested_desc 数组元素（结构体）的描述符
+ * @note size 为单个元素的大小，array_count 为元素个数；打印时以表格形式每个元素一行
+ */
+#define FIELD_STRUCT_ARRAY(struct_type, field_name, nested_desc) \
+    { \
+        #field_name, \
+        FIELD_TYPE_STRUCT, \
+        offsetof(struct_type, field_name), \
+        STRUCT_PRINT_ELEM_SIZE(FIELD_TYPE_STRUCT, struct_type, field_name, sizeof(((struct_type*)0)->field_name[0])), \
+        sizeof(((struct_type*)0)->field_name) / sizeof(((struct_type*)0)->field_name[0]), \
+        &nested_desc \
+    }
+
 /**
  * @brief 结束结构体描述符定义
  * @param struct_type 结构体类型名
@@ -341,12 +427,17 @@ typedef struct StructDescriptor_t {
  */
 #define END_STRUCT_DESC(struct_type, desc_name) \
     }; \
+    static u32 desc_name##_fingerprint_; \
     static const StructDescriptor desc_name = { \
         #struct_type, \
         sizeof(struct_type), \
         sizeof(desc_name##_fields) / sizeof(FieldDescriptor), \
-        desc_name##_fields \
-    };
+        desc_name##_fields, \
+        NULL, \
+        0, \
+        &desc_name##_fingerprint_ \
+    }; \
+    STRUCT_PRINT_AUTO_REGISTER_(desc_name)
 
 
 /* ============================================================================
@@ -382,6 +473,581 @@ typedef struct StructDescriptor_t {
 #define STRUCT_PRINT_PRINTF printf  /* 默认使用标准 printf */
 #endif
 
+/**
+ * @brief 线程安全输出（多个任务/线程同时调用 STRUCT_PRINT 等宏时记录不交错）
+ * @note 默认关闭：每行调用一次 STRUCT_PRINT_PRINTF，不同线程的记录会逐行交错。
+ *       定义为 1 后，每次调用先在调用者栈上的 STRUCT_PRINT_RECORD_BUF_SIZE 字节缓冲区中格式化整条记录，
+ *       记录不超过缓冲区时只调用一次 STRUCT_PRINT_PRINTF；超过时从第一次输出起持有
+ *       STRUCT_PRINT_LOCK()，直到记录结束才 STRUCT_PRINT_UNLOCK()
+ * @note 只作用于通过 STRUCT_PRINT_PRINTF 输出的宏；STRUCT_PRINT_TO 等 sink 接口由调用者的 sink 决定
+ *
+ * @example FreeRTOS
+ * #define STRUCT_PRINT_THREAD_SAFE 1
+ * #define STRUCT_PRINT_LOCK()   xSemaphoreTake(g_print_mutex, portMAX_DELAY)
+ * #define STRUCT_PRINT_UNLOCK() xSemaphoreGive(g_print_mutex)
+ * #include "struct_print.h"
+ */
+#ifndef STRUCT_PRINT_THREAD_SAFE
+#define STRUCT_PRINT_THREAD_SAFE        0
+#endif
+
+/* 线程安全模式下每次调用的记录缓冲区大小（栈上分配） */
+#ifndef STRUCT_PRINT_RECORD_BUF_SIZE
+#define STRUCT_PRINT_RECORD_BUF_SIZE    1024
+#endif
+
+/*
+ * 线程安全模式下超长记录的输出锁：线程安全模式必须定义。
+ * 记录超过缓冲区时（例如 stCircuitMqttCmdData 的默认格式约 1.4 KB）只能靠它避免交错；
+ * 确认 STRUCT_PRINT_PRINTF 本身线程安全且所有记录都不超过缓冲区时，可显式定义为 ((void)0)
+ */
+#ifndef STRUCT_PRINT_LOCK
+#if STRUCT_PRINT_THREAD_SAFE && defined(STRUCT_PRINT_ENABLE)
+#error "STRUCT_PRINT_THREAD_SAFE requires STRUCT_PRINT_LOCK()/STRUCT_PRINT_UNLOCK() (define them as ((void)0) only if every record fits STRUCT_PRINT_RECORD_BUF_SIZE)"
+#endif
+#define STRUCT_PRINT_LOCK()             ((void)0)
+#define STRUCT_PRINT_UNLOCK()           ((void)0)
+#endif
+
+
+/* ============================================================================
+ *                        性能统计配置（可选）
+ * ============================================================================ */
+
+/**
+ * @brief 性能统计表（表达式，类型为 StructPrintStatsTable*）
+ * @note 默认不定义，不产生任何统计代码。在包含本头文件之前定义后，每次打印结构体
+ *       （STRUCT_PRINT/STRUCT_PRINT_TO/STRUCT_PRINT_WITH/STRUCT_PRINT_FILTERED、环形缓冲区导出、日志解码）
+ *       都按描述符记录次数、输出字节数，以及描述符遍历、数值格式化、sink 输出三部分的耗时
+ * @note 同时需要定义 STRUCT_PRINT_STATS_TIME()：返回 u32 时间戳（单位任意，按无符号差值计算间隔）
+ *
+ * @example STM32（DWT 周期计数器，需先使能 DWT->CTRL 的 CYCCNTENA）
+ * extern struct StructPrintStatsTable_t g_print_stats;
+ * #define STRUCT_PRINT_STATS_TABLE (&g_print_stats)
+ * #define STRUCT_PRINT_STATS_TIME() (DWT->CYCCNT)
+ * #include "struct_print.h"
+ * ...
+ * STRUCT_PRINT_STATS_DEFINE(g_print_stats, 16);            // 在某个 .c 中定义一次
+ *
+ * @example Linux（纳秒）
+ * static inline u32 now_ns(void) { struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+ *                                   return (u32)(ts.tv_sec * 1000000000ull + ts.tv_nsec); }
+ * #define STRUCT_PRINT_STATS_TIME() now_ns()
+ */
+#if defined(STRUCT_PRINT_ENABLE) && defined(STRUCT_PRINT_STATS_TABLE) && !defined(STRUCT_PRINT_STATS_TIME)
+#error "STRUCT_PRINT_STATS_TABLE requires STRUCT_PRINT_STATS_TIME()"
+#endif
+
+
+/* ============================================================================
+ *                        字段前缀模板缓存配置（可选）
+ * ============================================================================ */
+
+/**
+ * @brief 字段前缀模板缓存（表达式，类型为 StructPrintTemplateCache*）
+ * @note 默认不定义，每个字段的前缀（缩进、"[+0xOFFS] "、字段名、": "）逐段生成。
+ *       定义后，每个描述符在每个缩进层级第一次打印时，把全部字段的前缀生成到缓存的存储区中，
+ *       之后打印只拷贝前缀，只格式化字段值
+ * @note 缓存满后新的描述符按原方式输出（计入 misses），输出内容不变
+ * @note 表达式的值为 NULL 时不使用缓存（可在运行时关闭）
+ *
+ * @example
+ * extern struct StructPrintTemplateCache_t g_print_templates;
+ * #define STRUCT_PRINT_TEMPLATE_CACHE (&g_print_templates)
+ * #include "struct_print.h"
+ * ...
+ * STRUCT_PRINT_TEMPLATES_DEFINE(g_print_templates, 32, 4096);   // 在某个 .c 中定义一次
+ */
+
+
+/* ============================================================================
+ *                        输出缓冲区（Sink）
+ * ============================================================================ */
+
+/**
+ * @brief Sink 刷新回调函数类型
+ * @param ctx 用户上下文（struct_print_sink_init 时传入）
+ * @param data 待输出数据，保证以 '\0' 结尾
+ * @param len 数据长度（不含结尾的 '\0'）
+ *
+ * @note 一次回调对应一次底层发送，例如一次 HAL_UART_Transmit
+ */
+typedef void (*StructPrintFlushFunc)(void* ctx, const char* data, size_t len);
+
+/**
+ * @brief Sink 刷新策略标志
+ */
+#define STRUCT_PRINT_SINK_FLUSH_FULL    0x00    /**< 仅在缓冲区写满或显式刷新时输出 */
+#define STRUCT_PRINT_SINK_FLUSH_LINE    0x01    /**< 每行结束时输出一次 */
+
+/**
+ * @brief 输出缓冲区
+ * @note 所有格式化输出都先写入调用者提供的缓冲区，
+ *       在行尾或缓冲区写满时通过 flush 回调一次性输出
+ *
+ * @example
+ * static void uart_flush(void* ctx, const char* data, size_t len) {
+ *     HAL_UART_Transmit(&huart1, (uint8_t*)data, len, 100);
+ * }
+ *
+ * char buf[128];
+ * StructPrintSink sink;
+ * struct_print_sink_init(&sink, buf, sizeof(buf), uart_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+ * STRUCT_PRINT_TO(&sink, status);
+ */
+typedef struct {
+    char* buf;                                  /**< 调用者提供的缓冲区 */
+    size_t capacity;                            /**< 可用容量（保留 1 字节存放 '\0'）*/
+    size_t length;                              /**< 当前缓冲的字节数 */
+    StructPrintFlushFunc flush;                 /**< 刷新回调 */
+    void* ctx;                                  /**< 回调上下文 */
+    unsigned int flags;                         /**< 刷新策略 STRUCT_PRINT_SINK_xxx */
+#ifdef STRUCT_PRINT_STATS_TABLE
+    u32 stats_ticks;                            /**< 刷新回调累计耗时（性能统计用）*/
+    size_t stats_bytes;                         /**< 累计刷新的字节数（性能统计用）*/
+#endif
+} StructPrintSink;
+
+/**
+ * @brief 初始化输出缓冲区
+ * @param sink 缓冲区对象
+ * @param buf 调用者提供的存储空间
+ * @param buf_size 存储空间大小（至少 2 字节）
+ * @param flush 刷新回调
+ * @param ctx 回调上下文
+ * @param flags 刷新策略 STRUCT_PRINT_SINK_xxx
+ * @return 0 成功，-1 参数错误（buf 为 NULL 或 buf_size 小于 2）
+ *
+ * @note 参数错误时 sink 丢弃全部输出（容量为 0 时写入循环无法前进，不能直接使用调用者的缓冲区）
+ */
+static inline int struct_print_sink_init(StructPrintSink* sink, char* buf, size_t buf_size,
+                                         StructPrintFlushFunc flush, void* ctx, unsigned int flags) {
+    static char discard[2];
+    int ok = (buf != NULL && buf_size >= 2);
+    
+    sink->buf = ok ? buf : discard;
+    sink->capacity = ok ? buf_size - 1 : 1;
+    sink->length = 0;
+    sink->flush = ok ? flush : NULL;
+    sink->ctx = ctx;
+    sink->flags = flags;
+#ifdef STRUCT_PRINT_STATS_TABLE
+    sink->stats_ticks = 0;
+    sink->stats_bytes = 0;
+#endif
+    return ok ? 0 : -1;
+}
+
+/**
+ * @brief 输出缓冲区中的全部数据
+ * @param sink 缓冲区对象
+ */
+static inline void struct_print_sink_flush(StructPrintSink* sink) {
+#ifdef STRUCT_PRINT_STATS_TABLE
+    u32 t0;
+#endif
+    if (sink->length == 0) return;
+    sink->buf[sink->length] = '\0';
+#ifdef STRUCT_PRINT_STATS_TABLE
+    t0 = (u32)STRUCT_PRINT_STATS_TIME();
+#endif
+    if (sink->flush != NULL) {
+        sink->flush(sink->ctx, sink->buf, sink->length);
+    }
+#ifdef STRUCT_PRINT_STATS_TABLE
+    sink->stats_ticks += (u32)STRUCT_PRINT_STATS_TIME() - t0;
+    sink->stats_bytes += sink->length;
+#endif
+    sink->length = 0;
+}
+
+/**
+ * @brief 写入一段数据（缓冲区满时自动刷新）
+ * @param sink 缓冲区对象
+ * @param data 数据指针
+ * @param len 数据长度
+ */
+static inline void sink_write(StructPrintSink* sink, const char* data, size_t len) {
+    while (len > 0) {
+        size_t room = sink->capacity - sink->length;
+        size_t n = (len < room) ? len : room;
+
+        memcpy(sink->buf + sink->length, data, n);
+        sink->length += n;
+        data += n;
+        len -= n;
+
+        if (sink->length == sink->capacity) {
+            struct_print_sink_flush(sink);
+        }
+    }
+}
+
+/**
+ * @brief 写入单个字符
+ */
+static inline void sink_putc(StructPrintSink* sink, char c) {
+    sink->buf[sink->length++] = c;
+    if (sink->length == sink->capacity) {
+        struct_print_sink_flush(sink);
+    }
+}
+
+/**
+ * @brief 写入以 '\0' 结尾的字符串
+ */
+static inline void sink_puts(StructPrintSink* sink, const char* str) {
+    sink_write(sink, str, strlen(str));
+}
+
+/**
+ * @brief 写入 count 个相同字符
+ */
+static inline void sink_fill(StructPrintSink* sink, char c, size_t count) {
+    while (count > 0) {
+        size_t room = sink->capacity - sink->length;
+        size_t n = (count < room) ? count : room;
+
+        memset(sink->buf + sink->length, c, n);
+        sink->length += n;
+        count -= n;
+
+        if (sink->length == sink->capacity) {
+            struct_print_sink_flush(sink);
+        }
+    }
+}
+
+/**
+ * @brief 结束当前行（按行刷新模式下触发一次输出）
+ */
+static inline void sink_endline(StructPrintSink* sink) {
+    sink_putc(sink, '\n');
+    if (sink->flags & STRUCT_PRINT_SINK_FLUSH_LINE) {
+        struct_print_sink_flush(sink);
+    }
+}
+
+/**
+ * @brief 预留 n 字节的连续写入空间（空间不足时先刷新）
+ * @return 写入位置；缓冲区总容量小于 n 时返回 NULL
+ * @note 写入完成后调用 sink_commit 提交实际写入的字节数
+ */
+static inline char* sink_reserve(StructPrintSink* sink, size_t n) {
+    if (sink->capacity - sink->length < n) {
+        struct_print_sink_flush(sink);
+    }
+    return (sink->capacity - sink->length >= n) ? sink->buf + sink->length : NULL;
+}
+
+/**
+ * @brief 提交 sink_reserve 之后写入的字节数
+ */
+static inline void sink_commit(StructPrintSink* sink, size_t n) {
+    sink->length += n;
+    if (sink->length == sink->capacity) {
+        struct_print_sink_flush(sink);
+    }
+}
+
+/**
+ * @brief STRUCT_PRINT_PRINTF 适配器（默认 Sink 的刷新回调）
+ * @note 保持旧接口兼容：每次刷新调用一次 STRUCT_PRINT_PRINTF
+ */
+static inline void struct_print_printf_flush(void* ctx, const char* data, size_t len) {
+    (void)ctx;
+    (void)len;
+    STRUCT_PRINT_PRINTF("%s", data);
+}
+
+/*
+ * 便捷函数（STRUCT_PRINT、STRUCT_PRINT_JSON 等）的输出缓冲区：
+ *   char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+ *   StructPrintSink sink;
+ *   int locked;
+ *   struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+ *   ...写入 sink...
+ *   struct_print_out_end(&sink, &locked);
+ * 默认逐行输出；STRUCT_PRINT_THREAD_SAFE 为 1 时整条记录缓冲后输出（见 STRUCT_PRINT_THREAD_SAFE）
+ */
+#if STRUCT_PRINT_THREAD_SAFE
+#define STRUCT_PRINT_OUT_BUF_SIZE       STRUCT_PRINT_RECORD_BUF_SIZE
+#else
+#define STRUCT_PRINT_OUT_BUF_SIZE       STRUCT_PRINT_LINE_BUF_SIZE
+#endif
+
+/**
+ * @brief 线程安全模式的刷新回调：第一次输出前加锁，由 struct_print_out_end 解锁
+ */
+static inline void struct_print_locked_flush(void* ctx, const char* data, size_t len) {
+    int* locked = (int*)ctx;
+    
+    if (!*locked) {
+        STRUCT_PRINT_LOCK();
+        *locked = 1;
+    }
+    struct_print_printf_flush(NULL, data, len);
+}
+
+static inline void struct_print_out_begin(StructPrintSink* sink, char* buf, size_t buf_size, int* locked) {
+    *locked = 0;
+#if STRUCT_PRINT_THREAD_SAFE
+    struct_print_sink_init(sink, buf, buf_size, struct_print_locked_flush, locked, STRUCT_PRINT_SINK_FLUSH_FULL);
+#else
+    struct_print_sink_init(sink, buf, buf_size, struct_print_printf_flush, NULL, STRUCT_PRINT_SINK_FLUSH_LINE);
+#endif
+}
+
+static inline void struct_print_out_end(StructPrintSink* sink, int* locked) {
+    struct_print_sink_flush(sink);
+    if (*locked) {
+        STRUCT_PRINT_UNLOCK();
+    }
+}
+
+
+/* ============================================================================
+ *                    数值格式化（不依赖 printf/vsnprintf）
+ * ============================================================================ */
+
+/* 单个数值格式化结果的最大长度 */
+#define STRUCT_PRINT_FMT_U32_MAX        10      /* 4294967295 */
+#define STRUCT_PRINT_FMT_S32_MAX        11      /* -2147483648 */
+#define STRUCT_PRINT_FMT_DOUBLE_MAX     40      /* 符号 + 20位整数 + '.' + 小数 */
+
+/**
+ * @brief 无符号整数转十进制字符串（两位查表）
+ * @param out 输出缓冲区（至少 STRUCT_PRINT_FMT_U32_MAX 字节，不写入 '\0'）
+ * @param value 数值
+ * @return 写入的字符数
+ */
+static inline size_t fmt_u32_dec(char* out, u32 value) {
+    static const char digits2[] =
+        "00010203040506070809" "10111213141516171819"
+        "20212223242526272829" "30313233343536373839"
+        "40414243444546474849" "50515253545556575859"
+        "60616263646566676869" "70717273747576777879"
+        "80818283848586878889" "90919293949596979899";
+    size_t len;
+    char* p;
+
+    /* 先确定位数，再从低位向高位填充 */
+    if (value < 10u) len = 1;
+    else if (value < 100u) len = 2;
+    else if (value < 1000u) len = 3;
+    else if (value < 10000u) len = 4;
+    else if (value < 100000u) len = 5;
+    else if (value < 1000000u) len = 6;
+    else if (value < 10000000u) len = 7;
+    else if (value < 100000000u) len = 8;
+    else if (value < 1000000000u) len = 9;
+    else len = 10;
+
+    p = out + len;
+    while (value >= 100u) {
+        u32 idx = (value % 100u) * 2u;
+        value /= 100u;
+        *--p = digits2[idx + 1];
+        *--p = digits2[idx];
+    }
+    if (value >= 10u) {
+        *--p = digits2[value * 2u + 1];
+        *--p = digits2[value * 2u];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return len;
+}
+
+/**
+ * @brief 有符号整数转十进制字符串
+ * @param out 输出缓冲区（至少 STRUCT_PRINT_FMT_S32_MAX 字节）
+ * @param value 数值
+ * @return 写入的字符数
+ */
+static inline size_t fmt_s32_dec(char* out, s32 value) {
+    if (value < 0) {
+        out[0] = '-';
+        return 1 + fmt_u32_dec(out + 1, (u32)0 - (u32)value);
+    }
+    return fmt_u32_dec(out, (u32)value);
+}
+
+/**
+ * @brief 无符号整数转大写十六进制字符串（查表，等价于 %0NX）
+ * @param out 输出缓冲区（至少 8 字节）
+ * @param value 数值
+ * @param min_digits 最少位数（不足补 0）
+ * @return 写入的字符数
+ */
+static inline size_t fmt_hex(char* out, u32 value, int min_digits) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    int len = 1;
+    int i;
+
+    while (len < 8 && (value >> (len * 4)) != 0) len++;
+    if (len < min_digits) len = min_digits;
+
+    for (i = len - 1; i >= 0; i--) {
+        out[i] = hex_digits[value & 0x0Fu];
+        value >>= 4;
+    }
+    return (size_t)len;
+}
+
+/**
+ * @brief 无符号 64 位整数转十进制字符串
+ * @note 32 位范围内走 fmt_u32_dec，避免在 Cortex-M 上调用 64 位除法
+ */
+static inline size_t fmt_u64_dec(char* out, uint64_t value) {
+    char tmp[20];
+    size_t len = 0;
+    size_t i;
+
+    if (value <= 0xFFFFFFFFu) {
+        return fmt_u32_dec(out, (u32)value);
+    }
+    while (value > 0) {
+        tmp[len++] = (char)('0' + (int)(value % 10u));
+        value /= 10u;
+    }
+    for (i = 0; i < len; i++) {
+        out[i] = tmp[len - 1 - i];
+    }
+    return len;
+}
+
+/**
+ * @brief 浮点数转定点十进制字符串（等价于 %.Nf，不需要 printf-float 支持）
+ * @param out 输出缓冲区（至少 STRUCT_PRINT_FMT_DOUBLE_MAX 字节）
+ * @param value 数值
+ * @param decimals 小数位数（0~9）
+ * @return 写入的字符数
+ *
+ * @note 绝对值超过 2^64 时以科学计数法输出（d.dddddde+XX）
+ * @note 小数部分按双精度乘法舍入，恰好位于舍入边界的极少数值末位可能与 printf 相差 1
+ */
+static inline size_t fmt_double(char* out, double value, int decimals) {
+    static const u32 pow10[] = {
+        1u, 10u, 100u, 1000u, 10000u, 100000u,
+        1000000u, 10000000u, 100000000u, 1000000000u
+    };
+    size_t len = 0;
+    uint64_t bits;
+    uint64_t int_part;
+    u32 scale;
+    u32 frac_part;
+    double frac;
+
+    if (decimals < 0) decimals = 0;
+    if (decimals > 9) decimals = 9;
+    scale = pow10[decimals];
+
+    memcpy(&bits, &value, sizeof(bits));
+    if (bits >> 63) {
+        out[len++] = '-';
+        value = -value;
+    }
+
+    /* NaN 与自身不相等；inf - inf 为 NaN */
+    if (value != value) {
+        memcpy(out + len, "nan", 3);
+        return len + 3;
+    }
+    if (value - value != 0.0) {
+        memcpy(out + len, "inf", 3);
+        return len + 3;
+    }
+
+    /* 超出 64 位整数范围：科学计数法 */
+    if (value >= 18446744073709551616.0) {
+        int exp10 = 0;
+        while (value >= 10.0) {
+            value /= 10.0;
+            exp10++;
+        }
+        len += fmt_double(out + len, value, decimals);
+        out[len++] = 'e';
+        out[len++] = '+';
+        if (exp10 < 10) out[len++] = '0';
+        len += fmt_u32_dec(out + len, (u32)exp10);
+        return len;
+    }
+
+    /* 整数部分与四舍五入后的小数部分 */
+    int_part = (uint64_t)value;
+    frac = (value - (double)int_part) * (double)scale + 0.5;
+    frac_part = (u32)frac;
+    if (frac_part >= scale) {
+        frac_part -= scale;
+        int_part++;
+    }
+
+    len += fmt_u64_dec(out + len, int_part);
+    if (decimals > 0) {
+        int i;
+        out[len++] = '.';
+        for (i = decimals - 1; i >= 0; i--) {
+            out[len + (size_t)i] = (char)('0' + frac_part % 10u);
+            frac_part /= 10u;
+        }
+        len += (size_t)decimals;
+    }
+    return len;
+}
+
+/**
+ * @brief 写入无符号十进制数（直接格式化到缓冲区）
+ */
+static inline void sink_put_u32(StructPrintSink* sink, u32 value) {
+    char tmp[STRUCT_PRINT_FMT_U32_MAX];
+    char* p = sink_reserve(sink, sizeof(tmp));
+    if (p != NULL) {
+        sink_commit(sink, fmt_u32_dec(p, value));
+    } else {
+        sink_write(sink, tmp, fmt_u32_dec(tmp, value));
+    }
+}
+
+/**
+ * @brief 写入有符号十进制数
+ */
+static inline void sink_put_s32(StructPrintSink* sink, s32 value) {
+    char tmp[STRUCT_PRINT_FMT_S32_MAX];
+    char* p = sink_reserve(sink, sizeof(tmp));
+    if (p != NULL) {
+        sink_commit(sink, fmt_s32_dec(p, value));
+    } else {
+        sink_write(sink, tmp, fmt_s32_dec(tmp, value));
+    }
+}
+
+/**
+ * @brief 写入大写十六进制数（不带 0x 前缀）
+ */
+static inline void sink_put_hex(StructPrintSink* sink, u32 value, int min_digits) {
+    char tmp[8];
+    char* p = sink_reserve(sink, sizeof(tmp));
+    if (p != NULL) {
+        sink_commit(sink, fmt_hex(p, value, min_digits));
+    } else {
+        sink_write(sink, tmp, fmt_hex(tmp, value, min_digits));
+    }
+}
+
+/**
+ * @brief 写入定点小数（STRUCT_PRINT_FLOAT_DECIMALS 位小数）
+ */
+static inline void sink_put_double(StructPrintSink* sink, double value) {
+    char tmp[STRUCT_PRINT_FMT_DOUBLE_MAX];
+    char* p = sink_reserve(sink, sizeof(tmp));
+    if (p != NULL) {
+        sink_commit(sink, fmt_double(p, value, STRUCT_PRINT_FLOAT_DECIMALS));
+    } else {
+        sink_write(sink, tmp, fmt_double(tmp, value, STRUCT_PRINT_FLOAT_DECIMALS));
+    }
+}
+
 
 /* ============================================================================
  *                        内部辅助函数
@@ -427,288 +1093,5559 @@ static inline int is_printable_string(const u8* data, size_t length) {
     return (i > 0); /* 至少有一个可打印字符 */
 }
 
+/**
+ * @brief 计算字符数组中字符串的长度（不超过数组长度）
+ * @param data 数据指针
+ * @param max_len 数组长度
+ * @return 字符串长度
+ */
+static inline size_t bounded_strlen(const u8* data, size_t max_len) {
+    const u8* end = (const u8*)memchr(data, '\0', max_len);
+    return (end != NULL) ? (size_t)(end - data) : max_len;
+}
+
 /**
  * @brief 打印缩进空格
+ * @param sink 输出缓冲区
  * @param indent_level 缩进层级
  */
-static inline void print_indent(int indent_level) {
-    int i;
-    for (i = 0; i < indent_level * STRUCT_PRINT_INDENT_SPACES; i++) {
-        STRUCT_PRINT_PRINTF(" ");
-    }
+static inline void print_indent(StructPrintSink* sink, int indent_level) {
+    sink_fill(sink, ' ', (size_t)indent_level * STRUCT_PRINT_INDENT_SPACES);
 }
 
 /**
- * @brief 打印十六进制内存数据
+ * @brief 输出十六进制内存数据（每行 16 字节）
+ * @param sink 输出缓冲区
  * @param data 数据指针
  * @param length 数据长度
  * @param max_bytes 最多显示的字节数
- * @param indent_level 缩进层级
+ * @param indent 缩进空格数
  */
-static inline void print_hex_memory(const u8* data, size_t length, size_t max_bytes, int indent_level) {
-#if STRUCT_PRINT_SHOW_HEX_MEMORY
+static inline void print_hex_dump(StructPrintSink* sink, const u8* data, size_t length, size_t max_bytes, size_t indent) {
+    static const char hex_digits[] = "0123456789ABCDEF";
     size_t i;
     size_t bytes_to_show = (length < max_bytes) ? length : max_bytes;
     
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("        └─ Memory: ");
+    sink_fill(sink, ' ', indent);
+    sink_puts(sink, "        └─ Memory: ");
     
     for (i = 0; i < bytes_to_show; i++) {
-        STRUCT_PRINT_PRINTF("%02X ", data[i]);
+        char* p = sink_reserve(sink, 3);
+        if (p != NULL) {
+            p[0] = hex_digits[data[i] >> 4];
+            p[1] = hex_digits[data[i] & 0x0F];
+            p[2] = ' ';
+            sink_commit(sink, 3);
+        } else {
+            sink_putc(sink, hex_digits[data[i] >> 4]);
+            sink_putc(sink, hex_digits[data[i] & 0x0F]);
+            sink_putc(sink, ' ');
+        }
         if ((i + 1) % 16 == 0 && (i + 1) < bytes_to_show) {
-            STRUCT_PRINT_PRINTF("\n");
-            print_indent(indent_level);
-            STRUCT_PRINT_PRINTF("                   ");
+            sink_endline(sink);
+            sink_fill(sink, ' ', indent);
+            sink_puts(sink, "                   ");
         }
     }
     
     if (length > max_bytes) {
-        STRUCT_PRINT_PRINTF("...");
+        sink_puts(sink, "...");
     }
-    STRUCT_PRINT_PRINTF("\n");
+    sink_endline(sink);
+}
+
+/**
+ * @brief 打印十六进制内存数据（按编译期配置的缩进，STRUCT_PRINT_SHOW_HEX_MEMORY 为 0 时不输出）
+ * @param sink 输出缓冲区
+ * @param data 数据指针
+ * @param length 数据长度
+ * @param max_bytes 最多显示的字节数
+ * @param indent_level 缩进层级
+ */
+static inline void print_hex_memory(StructPrintSink* sink, const u8* data, size_t length, size_t max_bytes, int indent_level) {
+#if STRUCT_PRINT_SHOW_HEX_MEMORY
+    print_hex_dump(sink, data, length, max_bytes, (size_t)indent_level * STRUCT_PRINT_INDENT_SPACES);
+#else
+    (void)sink; (void)data; (void)length; (void)max_bytes; (void)indent_level;
+#endif
+}
+
+/**
+ * @brief 打印单个元素的值（不含十六进制和换行）
+ * @param sink 输出缓冲区
+ * @param type 元素类型
+ * @param addr 元素地址
+ * @return 1 已打印，0 类型不是标量
+ */
+static inline int print_scalar(StructPrintSink* sink, FieldType type, const void* addr) {
+    switch (type) {
+        case FIELD_TYPE_U8:     sink_put_u32(sink, *(const u8*)addr); break;
+        case FIELD_TYPE_U16:    sink_put_u32(sink, *(const u16*)addr); break;
+        case FIELD_TYPE_U32:    sink_put_u32(sink, *(const u32*)addr); break;
+        case FIELD_TYPE_S8:     sink_put_s32(sink, *(const s8*)addr); break;
+        case FIELD_TYPE_S16:    sink_put_s32(sink, *(const s16*)addr); break;
+        case FIELD_TYPE_S32:    sink_put_s32(sink, *(const s32*)addr); break;
+        case FIELD_TYPE_FLOAT:  sink_put_double(sink, *(const float*)addr); break;
+        case FIELD_TYPE_DOUBLE: sink_put_double(sink, *(const double*)addr); break;
+        default:                return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief 判断字段是否按字符串显示
+ * @param field 字段描述符
+ * @param addr 字段地址
+ */
+static inline int field_is_string(const FieldDescriptor* field, const void* addr) {
+    return field->array_count > 0 &&
+           (field->type == FIELD_TYPE_STRING ||
+            (field->type == FIELD_TYPE_U8 && is_printable_string((const u8*)addr, field->array_count)));
+}
+
+/**
+ * @brief 打印带引号的字符串（长度不超过字符数组大小）
+ */
+static inline void print_quoted_string(StructPrintSink* sink, const void* addr, size_t max_len) {
+    sink_putc(sink, '"');
+    sink_write(sink, (const char*)addr, bounded_strlen((const u8*)addr, max_len));
+    sink_putc(sink, '"');
+}
+
+/* 字段路径（如 device.temperature、sensors[3].value）的最大长度 */
+#ifndef STRUCT_PRINT_PATH_MAX
+#define STRUCT_PRINT_PATH_MAX           64
+#endif
+
+/**
+ * @brief 字段路径（递归遍历描述符时逐级追加，超长部分截断）
+ */
+typedef struct {
+    size_t len;                                 /**< 当前路径长度 */
+    char buf[STRUCT_PRINT_PATH_MAX];            /**< 路径字符串（以 '\0' 结尾）*/
+} StructPrintPath;
+
+/**
+ * @brief 清空路径
+ */
+static inline void struct_path_reset(StructPrintPath* path) {
+    path->len = 0;
+    path->buf[0] = '\0';
+}
+
+/**
+ * @brief 追加路径片段
+ * @param path 路径
+ * @param name 片段
+ * @param with_dot 非首个片段前是否加 '.'
+ * @return 追加前的长度（传给 struct_path_pop 恢复）
+ */
+static inline size_t struct_path_push(StructPrintPath* path, const char* name, int with_dot) {
+    size_t saved = path->len;
+    size_t room = sizeof(path->buf) - 1 - path->len;
+    size_t n;
+    
+    if (with_dot && path->len > 0 && room > 0) {
+        path->buf[path->len++] = '.';
+        room--;
+    }
+    n = strlen(name);
+    if (n > room) n = room;
+    memcpy(path->buf + path->len, name, n);
+    path->len += n;
+    path->buf[path->len] = '\0';
+    return saved;
+}
+
+/**
+ * @brief 追加数组下标 "[index]"
+ * @return 追加前的长度
+ */
+static inline size_t struct_path_push_index(StructPrintPath* path, size_t index) {
+    char text[STRUCT_PRINT_FMT_U32_MAX + 3];
+    size_t n = 0;
+    
+    text[n++] = '[';
+    n += fmt_u32_dec(text + n, (u32)index);
+    text[n++] = ']';
+    text[n] = '\0';
+    return struct_path_push(path, text, 0);
+}
+
+/**
+ * @brief 恢复到 push 之前的路径
+ */
+static inline void struct_path_pop(StructPrintPath* path, size_t saved) {
+    path->len = saved;
+    path->buf[saved] = '\0';
+}
+
+/**
+ * @brief 字段位图的字数（每字 32 个字段）
+ * @example u32 bits[STRUCT_FIELD_BITS_WORDS(1000)];
+ */
+#define STRUCT_FIELD_BITS_WORDS(field_count) (((field_count) + 31u) / 32u)
+
+/**
+ * @brief 字段掩码：选择某个描述符要打印的字段
+ * @note 位图第 i 位（bits[i / 32] 的第 i % 32 位）对应 fields[i]；位图之外的字段按未置位处理
+ */
+typedef struct {
+    const StructDescriptor* desc;               /**< 掩码作用的描述符（嵌套结构体各自指定）*/
+    const u32* include;                         /**< 只打印这些字段（NULL 表示全部）*/
+    const u32* exclude;                         /**< 不打印这些字段（优先于 include，可为 NULL）*/
+    size_t words;                               /**< include/exclude 位图的字数 */
+} StructFieldMask;
+
+/**
+ * @brief 单次打印的过滤条件
+ * @note 被过滤的字段不做任何格式化；各项为 0 表示不限制
+ */
+typedef struct {
+    const StructFieldMask* masks;               /**< 字段掩码数组（可为 NULL）*/
+    size_t mask_count;                          /**< 掩码个数 */
+    size_t max_depth;                           /**< 最多展开的结构体层数（1 表示只打印顶层字段）*/
+    size_t max_array_bytes;                     /**< 每个数组/字符串最多输出的字节数 */
+} StructPrintFilter;
+
+/**
+ * @brief 运行时输出选项
+ * @note 按次传入（struct_print_options_to），或通过 STRUCT_PRINT_GLOBAL_OPTIONS 全局设置
+ */
+typedef struct StructPrintOptions_t {
+    u8 show_address;                            /**< 显示结构体地址 */
+    u8 show_offset;                             /**< 显示字段偏移量 */
+    u8 show_hex_memory;                         /**< 显示字段的十六进制内存 */
+    u8 terse;                                   /**< 简洁格式：无头部和十六进制，每个字段一行 name=value */
+    u16 hex_bytes;                              /**< 每个字段十六进制显示的字节数 */
+    u16 indent_spaces;                          /**< 每层缩进的空格数 */
+    const StructPrintFilter* filter;            /**< 过滤条件（可为 NULL）*/
+} StructPrintOptions;
+
+/* 与编译期配置相同的选项（STRUCT_PRINT 的默认输出）*/
+#define STRUCT_PRINT_OPTIONS_DEFAULT { STRUCT_PRINT_SHOW_ADDRESS, STRUCT_PRINT_SHOW_OFFSET, \
+    STRUCT_PRINT_SHOW_HEX_MEMORY, 0, STRUCT_PRINT_HEX_BYTES, STRUCT_PRINT_INDENT_SPACES, NULL }
+
+/* 简洁格式：每个字段一行 var.path=value */
+#define STRUCT_PRINT_OPTIONS_TERSE { 0, 0, 0, 1, STRUCT_PRINT_HEX_BYTES, STRUCT_PRINT_INDENT_SPACES, NULL }
+
+static const StructPrintOptions struct_print_options_default = STRUCT_PRINT_OPTIONS_DEFAULT;
+static const StructPrintOptions struct_print_options_terse = STRUCT_PRINT_OPTIONS_TERSE;
+
+/**
+ * @brief 全局输出选项（表达式，类型为 const StructPrintOptions*）
+ * @note 默认为编译期配置；在包含本头文件之前定义为自己的变量，即可在运行时切换输出格式
+ *
+ * @example
+ * extern struct StructPrintOptions_t g_print_options;     // 在某个 .c 中定义并初始化
+ * #define STRUCT_PRINT_GLOBAL_OPTIONS (&g_print_options)
+ * #include "struct_print.h"
+ * ...
+ * g_print_options = struct_print_options_terse;           // 例如由串口命令切换
+ */
+#ifndef STRUCT_PRINT_GLOBAL_OPTIONS
+#define STRUCT_PRINT_GLOBAL_OPTIONS (&struct_print_options_default)
+#endif
+
+/**
+ * @brief 预先生成的字段前缀（批量打印的顶层字段，或模板缓存中的一个描述符）
+ * @note 第 i 个字段的前缀为 text[ends[i-1], ends[i])（ends[-1] 视为 0）；
+ *       只有前 count 个字段生成了前缀，其余字段按常规方式输出
+ */
+typedef struct {
+    const StructDescriptor* desc;               /**< 前缀所属的描述符 */
+    const char* text;                           /**< 各字段前缀首尾相接（"  [+0xOFFS] name: "）*/
+    const u16* ends;                            /**< 各字段前缀的结束位置 */
+    size_t count;                               /**< 已生成前缀的字段数 */
+} StructPrintPrefixes;
+
+/**
+ * @brief 打印上下文
+ * @note 在一次打印的递归过程中传递，保存与具体结构体无关的状态
+ */
+typedef struct StructPrintContext_t {
+    StructPrintSink* sink;                      /**< 输出缓冲区 */
+    uintptr_t addr_bias;                        /**< 显示地址偏差（显示地址 = 数据地址 + addr_bias）*/
+    const StructPrintFilter* filter;            /**< 过滤条件（NULL 表示打印全部）*/
+    size_t depth;                               /**< 当前结构体嵌套层数（顶层为 0）*/
+    const StructPrintOptions* options;          /**< 输出选项（不为 NULL）*/
+    int specialized_ok;                         /**< 选项与编译期配置相同，可使用专用打印函数 */
+    const StructPrintPrefixes* prefixes;        /**< 顶层字段的预生成前缀（NULL 表示逐个生成）*/
+    int hold_flush;                             /**< 记录结束时不刷新 sink（批量打印最后统一刷新）*/
+#ifdef STRUCT_PRINT_STATS_TABLE
+    u32 stats_format;                           /**< 本次打印的数值格式化耗时（不含 sink 输出）*/
+    int stats_span;                             /**< 正在计时的格式化区间层数（嵌套区间不重复计时）*/
+#endif
+} StructPrintContext;
+
+/**
+ * @brief 初始化打印上下文
+ * @param ctx 上下文对象
+ * @param sink 输出缓冲区
+ */
+static inline void struct_print_context_set_options(StructPrintContext* ctx, const StructPrintOptions* options);
+
+static inline void struct_print_context_init(StructPrintContext* ctx, StructPrintSink* sink) {
+    ctx->sink = sink;
+    ctx->addr_bias = 0;
+    ctx->depth = 0;
+    ctx->prefixes = NULL;
+    ctx->hold_flush = 0;
+#ifdef STRUCT_PRINT_STATS_TABLE
+    ctx->stats_format = 0;
+    ctx->stats_span = 0;
+#endif
+    struct_print_context_set_options(ctx, STRUCT_PRINT_GLOBAL_OPTIONS);
+}
+
+/**
+ * @brief 设置上下文的输出选项（同时采用选项中的过滤条件）
+ * @param ctx 上下文对象
+ * @param options 输出选项（NULL 表示编译期默认值）
+ */
+static inline void struct_print_context_set_options(StructPrintContext* ctx, const StructPrintOptions* options) {
+    if (options == NULL) options = &struct_print_options_default;
+    ctx->options = options;
+    ctx->filter = options->filter;
+    ctx->specialized_ok = !options->terse &&
+                          options->show_address == STRUCT_PRINT_SHOW_ADDRESS &&
+                          options->show_offset == STRUCT_PRINT_SHOW_OFFSET &&
+                          options->show_hex_memory == STRUCT_PRINT_SHOW_HEX_MEMORY &&
+                          options->hex_bytes == STRUCT_PRINT_HEX_BYTES &&
+                          options->indent_spaces == STRUCT_PRINT_INDENT_SPACES;
+}
+
+/**
+ * @brief 按上下文选项输出缩进
+ */
+static inline void ctx_indent(const StructPrintContext* ctx, int indent_level) {
+    sink_fill(ctx->sink, ' ', (size_t)indent_level * ctx->options->indent_spaces);
+}
+
+/**
+ * @brief 按上下文选项输出字段的十六进制内存
+ */
+static inline void ctx_hex_memory(const StructPrintContext* ctx, const void* data, size_t length, int indent_level) {
+    if (ctx->specialized_ok) {
+        print_hex_memory(ctx->sink, (const u8*)data, length, STRUCT_PRINT_HEX_BYTES, indent_level);
+    } else if (ctx->options->show_hex_memory) {
+        print_hex_dump(ctx->sink, (const u8*)data, length, ctx->options->hex_bytes,
+                       (size_t)indent_level * ctx->options->indent_spaces);
+    }
+}
+
+/**
+ * @brief 数值格式化计时区间：STRUCT_PRINT_STATS_FORMAT_(ctx, 语句)
+ * @note 区间耗时扣除其中的 sink 输出时间；嵌套区间只由最外层计时。未启用性能统计时就是语句本身
+ */
+#ifdef STRUCT_PRINT_STATS_TABLE
+static inline u32 stats_format_begin(StructPrintContext* ctx) {
+    ctx->stats_span++;
+    return (u32)STRUCT_PRINT_STATS_TIME() - ctx->sink->stats_ticks;
+}
+
+static inline void stats_format_end(StructPrintContext* ctx, u32 mark) {
+    if (--ctx->stats_span == 0) {
+        ctx->stats_format += (u32)STRUCT_PRINT_STATS_TIME() - ctx->sink->stats_ticks - mark;
+    }
+}
+
+#define STRUCT_PRINT_STATS_FORMAT_(ctx, stmt) \
+    do { u32 sp_mark_ = stats_format_begin(ctx); stmt; stats_format_end(ctx, sp_mark_); } while (0)
+#else
+#define STRUCT_PRINT_STATS_FORMAT_(ctx, stmt) stmt
+#endif
+
+/**
+ * @brief 取得过滤条件中作用于描述符的字段掩码
+ * @return 掩码；没有过滤条件或没有该描述符的掩码时返回 NULL（打印全部字段）
+ */
+static inline const StructFieldMask* filter_field_mask(const StructPrintFilter* filter, const StructDescriptor* desc) {
+    size_t i;
+    
+    if (filter == NULL) return NULL;
+    for (i = 0; i < filter->mask_count; i++) {
+        if (filter->masks[i].desc == desc) return &filter->masks[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 掩码下是否打印 fields[index]
+ */
+static inline int filter_field_on(const StructFieldMask* mask, size_t index) {
+    size_t word = index / 32u;
+    u32 bit = 1u << (index % 32u);
+    
+    if (mask == NULL) return 1;
+    if (mask->exclude != NULL && word < mask->words && (mask->exclude[word] & bit) != 0) return 0;
+    if (mask->include != NULL) return word < mask->words && (mask->include[word] & bit) != 0;
+    return 1;
+}
+
+/**
+ * @brief 过滤条件下数组/字符串实际输出的长度（字节）
+ */
+static inline size_t filter_array_bytes(const StructPrintContext* ctx, size_t length) {
+    if (ctx->filter != NULL && ctx->filter->max_array_bytes > 0 && length > ctx->filter->max_array_bytes) {
+        return ctx->filter->max_array_bytes;
+    }
+    return length;
+}
+
+/**
+ * @brief 嵌套结构体是否还能展开
+ */
+static inline int filter_can_descend(const StructPrintContext* ctx) {
+    return ctx->filter == NULL || ctx->filter->max_depth == 0 || ctx->depth + 1 < ctx->filter->max_depth;
+}
+
+/**
+ * @brief 按上下文选项生成字段前缀（与 print_field_prefix 的输出相同）
+ * @param ctx 打印上下文
+ * @param desc 结构体描述符
+ * @param indent_level 缩进层级
+ * @param text 前缀存储区
+ * @param text_size 存储区大小（不超过 65535）
+ * @param ends 各字段前缀的结束位置（max_fields 个）
+ * @param max_fields 最多生成的字段数
+ * @return 生成了前缀的字段数（存储区不够时提前结束）
+ */
+static inline size_t prefixes_build(const StructPrintContext* ctx, const StructDescriptor* desc, int indent_level,
+                                    char* text, size_t text_size, u16* ends, size_t max_fields) {
+    size_t indent = (size_t)indent_level * ctx->options->indent_spaces;
+    size_t len = 0;
+    size_t i;
+    
+    for (i = 0; i < desc->field_count && i < max_fields; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        size_t name_len = strlen(field->name);
+        
+        /* 缩进 + "  [+0x" + 最多 8 位十六进制 + "] " + 名称 + ": " */
+        if (len + indent + 16 + name_len + 2 > text_size) break;
+        memset(text + len, ' ', indent);
+        len += indent;
+        if (ctx->options->show_offset) {
+            memcpy(text + len, "  [+0x", 6);
+            len += 6;
+            len += fmt_hex(text + len, (u32)field->offset, 4);
+            memcpy(text + len, "] ", 2);
+            len += 2;
+        } else {
+            memcpy(text + len, "  ", 2);
+            len += 2;
+        }
+        memcpy(text + len, field->name, name_len);
+        len += name_len;
+        memcpy(text + len, ": ", 2);
+        len += 2;
+        ends[i] = (u16)len;
+    }
+    return i;
+}
+
+/**
+ * @brief 原子操作
+ * @note GCC/Clang 使用 __atomic 内建函数；其他编译器可自行定义这些宏
+ * @note STRUCT_PRINT_RING_DROP_OLDEST 策略和模板缓存需要 CAS，Cortex-M0 等不支持
+ *       LDREX/STREX 的内核需由编译器库或自定义宏（例如关中断）实现
+ */
+#ifndef STRUCT_PRINT_ATOMIC_LOAD
+#if defined(__GNUC__) || defined(__clang__)
+#define STRUCT_PRINT_ATOMIC_LOAD(ptr)           __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define STRUCT_PRINT_ATOMIC_STORE(ptr, val)     __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define STRUCT_PRINT_ATOMIC_CAS(ptr, expected, desired) \
+    __atomic_compare_exchange_n((ptr), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+#define STRUCT_PRINT_ATOMIC_LOAD(ptr)           (*(volatile u32*)(ptr))
+#define STRUCT_PRINT_ATOMIC_STORE(ptr, val)     (*(volatile u32*)(ptr) = (val))
+#define STRUCT_PRINT_ATOMIC_CAS(ptr, expected, desired) \
+    ((*(volatile u32*)(ptr) == *(expected)) ? (*(volatile u32*)(ptr) = (desired), 1) : (*(expected) = *(volatile u32*)(ptr), 0))
+#endif
+#endif
+
+/**
+ * @brief 模板缓存条目：一个描述符在一种缩进层级和选项下的字段前缀
+ */
+typedef struct {
+    StructPrintPrefixes prefixes;               /**< 字段前缀（存放在缓存的存储区中）*/
+    int indent_level;                           /**< 缩进层级 */
+    u16 indent_spaces;                          /**< 生成时的每层缩进空格数 */
+    u8 show_offset;                             /**< 生成时是否显示偏移量 */
+    u32 ready;                                  /**< 已生成完毕（原子发布，之后只读）*/
+} StructPrintTemplate;
+
+/**
+ * @brief 字段前缀模板缓存（条目数组 + 存储区，第一次使用时生成，之后只读）
+ * @note 条目和存储区通过 CAS 分配，多个线程同时打印时不需要加锁；
+ *       两个线程同时第一次打印同一个描述符时可能各生成一份，只浪费空间；
+ *       存储区不够时占用一个空条目（prefixes.ends 为 NULL），之后的打印查到它直接按原方式输出
+ */
+typedef struct StructPrintTemplateCache_t {
+    StructPrintTemplate* entries;               /**< 条目数组 */
+    u32 capacity;                               /**< 条目数 */
+    u32 count;                                  /**< 已分配的条目数 */
+    char* arena;                                /**< 存储区（前缀文本和结束位置）*/
+    u32 arena_size;                             /**< 存储区大小 */
+    u32 arena_used;                             /**< 存储区已分配的字节数 */
+    u32 misses;                                 /**< 条目或存储区不足、未能缓存的次数 */
+} StructPrintTemplateCache;
+
+/**
+ * @brief 定义模板缓存
+ * @param name 缓存变量名（非 static，其他文件可用 extern struct StructPrintTemplateCache_t 引用）
+ * @param entries 最多缓存的模板数（描述符 × 用到的缩进层级，嵌套结构体各占一个）
+ * @param arena_bytes 存储区大小；每个字段约 缩进 + 名称长度 + 16 字节
+ */
+#define STRUCT_PRINT_TEMPLATES_DEFINE(name, entries, arena_bytes) \
+    static StructPrintTemplate name##_entries_[entries]; \
+    static u16 name##_arena_[((arena_bytes) + 1) / 2]; \
+    StructPrintTemplateCache name = { name##_entries_, (entries), 0, (char*)name##_arena_, \
+                                      ((arena_bytes) + 1) / 2 * 2, 0, 0 }
+
+/**
+ * @brief 从缓存存储区分配空间（2 字节对齐，失败返回 NULL）
+ */
+static inline char* template_alloc(StructPrintTemplateCache* cache, u32 size) {
+    u32 used = STRUCT_PRINT_ATOMIC_LOAD(&cache->arena_used);
+    u32 start;
+    
+    do {
+        start = (used + 1u) & ~1u;
+        if (start > cache->arena_size || size > cache->arena_size - start) return NULL;
+    } while (!STRUCT_PRINT_ATOMIC_CAS(&cache->arena_used, &used, start + size));
+    return cache->arena + start;
+}
+
+/**
+ * @brief 未能缓存的次数加 1
+ */
+static inline void template_count_miss(StructPrintTemplateCache* cache) {
+    u32 misses = STRUCT_PRINT_ATOMIC_LOAD(&cache->misses);
+    while (!STRUCT_PRINT_ATOMIC_CAS(&cache->misses, &misses, misses + 1u)) {
+    }
+}
+
+/**
+ * @brief 取得描述符的字段前缀模板（没有时生成）
+ * @param cache 模板缓存
+ * @param ctx 打印上下文（决定缩进宽度和是否显示偏移量）
+ * @param desc 结构体描述符
+ * @param indent_level 缩进层级
+ * @return 模板；cache 为 NULL、条目已满或存储区不够时返回 NULL（调用者逐段生成前缀）
+ */
+static inline const StructPrintPrefixes* struct_print_template_get(StructPrintTemplateCache* cache,
+                                                                    const StructPrintContext* ctx,
+                                                                    const StructDescriptor* desc, int indent_level) {
+    StructPrintTemplate* t;
+    size_t text_size = 0;
+    u32 count, index, i;
+    char* mem;
+    
+    if (cache == NULL) return NULL;
+    count = STRUCT_PRINT_ATOMIC_LOAD(&cache->count);
+    for (i = 0; i < count && i < cache->capacity; i++) {
+        t = &cache->entries[i];
+        if (STRUCT_PRINT_ATOMIC_LOAD(&t->ready) && t->prefixes.desc == desc && t->indent_level == indent_level &&
+            t->indent_spaces == ctx->options->indent_spaces && t->show_offset == ctx->options->show_offset) {
+            if (t->prefixes.ends != NULL) return &t->prefixes;
+            template_count_miss(cache);
+            return NULL;        /* 空条目：存储区不够，不再重新估算 */
+        }
+    }
+    
+    /* 条目已满时不估算文本长度，直接按原方式输出 */
+    if (count >= cache->capacity) {
+        template_count_miss(cache);
+        return NULL;
+    }
+    
+    /* 第一次使用：按上限估算文本长度，分配结束位置数组和文本 */
+    for (i = 0; i < desc->field_count; i++) {
+        text_size += (size_t)indent_level * ctx->options->indent_spaces + strlen(desc->fields[i].name) + 18;
+    }
+    if (text_size > 0xFFFFu) text_size = 0xFFFFu;
+    mem = template_alloc(cache, (u32)(desc->field_count * sizeof(u16) + text_size));
+    
+    index = count;
+    do {
+        if (index >= cache->capacity) {
+            template_count_miss(cache);
+            return NULL;        /* 其他线程占满了条目，已分配的存储区不再使用 */
+        }
+    } while (!STRUCT_PRINT_ATOMIC_CAS(&cache->count, &index, index + 1u));
+    
+    t = &cache->entries[index];
+    t->prefixes.desc = desc;
+    t->indent_level = indent_level;
+    t->indent_spaces = ctx->options->indent_spaces;
+    t->show_offset = ctx->options->show_offset;
+    if (mem == NULL) {
+        /* 存储区不够：发布空条目，之后的打印在查找时就返回 */
+        t->prefixes.ends = NULL;
+        t->prefixes.text = NULL;
+        t->prefixes.count = 0;
+        STRUCT_PRINT_ATOMIC_STORE(&t->ready, 1u);
+        template_count_miss(cache);
+        return NULL;
+    }
+    t->prefixes.ends = (const u16*)(void*)mem;
+    t->prefixes.text = mem + desc->field_count * sizeof(u16);
+    t->prefixes.count = prefixes_build(ctx, desc, indent_level, mem + desc->field_count * sizeof(u16),
+                                       text_size, (u16*)(void*)mem, desc->field_count);
+    STRUCT_PRINT_ATOMIC_STORE(&t->ready, 1u);
+    return &t->prefixes;
+}
+
+/**
+ * @brief 清空模板缓存（例如修改了描述符之后）
+ * @note 调用时不能有正在进行的打印
+ */
+static inline void struct_print_templates_reset(StructPrintTemplateCache* cache) {
+    memset(cache->entries, 0, cache->capacity * sizeof(StructPrintTemplate));
+    cache->count = 0;
+    cache->arena_used = 0;
+    cache->misses = 0;
+}
+
+/**
+ * @brief 打印单个字段的值
+ * @param ctx 打印上下文
+ * @param field 字段描述符
+ * @param struct_base 结构体基地址
+ * @param indent_level 缩进层级
+ */
+static void print_field_value(StructPrintContext* ctx, const FieldDescriptor* field, const void* struct_base, int indent_level);
+
+/**
+ * @brief 以表格形式打印结构体数组（表头 + 每个元素一行，实现见"表格打印"一节）
+ * @param sink 输出缓冲区
+ * @param array 数组首元素地址
+ * @param count 元素个数
+ * @param first_index 首元素显示的下标
+ * @param desc 元素的结构体描述符
+ * @param indent_level 缩进层级
+ * @param indent_spaces 每层缩进的空格数（与 StructPrintOptions.indent_spaces 一致）
+ */
+static void struct_print_table_rows(StructPrintSink* sink, const void* array, size_t count, size_t first_index,
+                                    const StructDescriptor* desc, int indent_level, u16 indent_spaces);
+
+/**
+ * @brief 打印结构体头部（分隔线、名称、地址、大小）
+ * @param ctx 打印上下文
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @param indent_level 缩进层级
+ */
+static inline void print_struct_header(StructPrintContext* ctx, const char* var_name, const void* struct_data,
+                                       const StructDescriptor* desc, int indent_level) {
+    StructPrintSink* sink = ctx->sink;
+    
+    ctx_indent(ctx, indent_level);
+    sink_puts(sink, "========================================");
+    sink_endline(sink);
+    
+    ctx_indent(ctx, indent_level);
+    sink_puts(sink, "Struct: ");
+    if (var_name != NULL && var_name[0] != '\0') {
+        sink_puts(sink, var_name);
+        sink_putc(sink, ' ');
+    }
+    sink_putc(sink, '[');
+    sink_puts(sink, desc->struct_name);
+    sink_putc(sink, ']');
+    sink_endline(sink);
+    
+    if (ctx->options->show_address) {
+        ctx_indent(ctx, indent_level);
+        sink_puts(sink, "Address: 0x");
+        sink_put_hex(sink, (u32)((uintptr_t)struct_data + ctx->addr_bias), 8);
+        sink_endline(sink);
+    }
+    
+    ctx_indent(ctx, indent_level);
+    sink_puts(sink, "Size: ");
+    sink_put_u32(sink, (u32)desc->struct_size);
+    sink_puts(sink, " bytes");
+    sink_endline(sink);
+    
+    ctx_indent(ctx, indent_level);
+    sink_puts(sink, "========================================");
+    sink_endline(sink);
+}
+
+/**
+ * @brief 打印结构体尾部分隔线
+ */
+static inline void print_struct_footer(StructPrintContext* ctx, int indent_level) {
+    ctx_indent(ctx, indent_level);
+    sink_puts(ctx->sink, "========================================");
+    sink_endline(ctx->sink);
+}
+
+/**
+ * @brief 打印字段前缀："  [+0xOFFS] name: "
+ * @param ctx 打印上下文
+ * @param offset 字段偏移
+ * @param name 字段名
+ * @param name_len 字段名长度
+ * @param indent_level 缩进层级
+ */
+static inline void print_field_prefix(StructPrintContext* ctx, size_t offset, const char* name,
+                                      size_t name_len, int indent_level) {
+    StructPrintSink* sink = ctx->sink;
+    
+    ctx_indent(ctx, indent_level);
+    
+    if (ctx->options->show_offset) {
+        sink_puts(sink, "  [+0x");
+        sink_put_hex(sink, (u32)offset, 4);
+        sink_puts(sink, "] ");
+    } else {
+        sink_puts(sink, "  ");
+    }
+    
+    sink_write(sink, name, name_len);
+    sink_puts(sink, ": ");
+}
+
+/**
+ * @brief 简洁格式：每个字段一行 "path=value"（递归展开嵌套结构体和结构体数组）
+ * @param ctx 打印上下文
+ * @param path 当前路径（变量名 + 上层字段名）
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ */
+static void print_terse_fields(StructPrintContext* ctx, StructPrintPath* path, const void* struct_data,
+                               const StructDescriptor* desc) {
+    StructPrintSink* sink = ctx->sink;
+    const StructFieldMask* mask = filter_field_mask(ctx->filter, desc);
+    size_t i, j;
+    
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        const u8* addr = (const u8*)struct_data + field->offset;
+        size_t saved;
+        
+        if (!filter_field_on(mask, i)) continue;
+        saved = struct_path_push(path, field->name, path->len > 0);
+        
+        if (field->type == FIELD_TYPE_STRUCT && field->nested_desc != NULL && filter_can_descend(ctx)) {
+            size_t rows = (field->array_count > 0) ? filter_array_bytes(ctx, field->array_count * field->size) / field->size : 0;
+            
+            ctx->depth++;
+            if (field->array_count == 0) {
+                print_terse_fields(ctx, path, addr, field->nested_desc);
+            }
+            for (j = 0; j < rows; j++) {
+                size_t elem_saved = struct_path_push_index(path, j);
+                print_terse_fields(ctx, path, addr + j * field->size, field->nested_desc);
+                struct_path_pop(path, elem_saved);
+            }
+            ctx->depth--;
+        } else {
+            sink_write(sink, path->buf, path->len);
+            sink_putc(sink, '=');
+            if (field->type == FIELD_TYPE_STRUCT) {
+                sink_puts(sink, "{...}");
+            } else if (field->array_count > 0) {
+                size_t bytes = filter_array_bytes(ctx, field->array_count * field->size);
+                
+                if (field_is_string(field, addr)) {
+                    print_quoted_string(sink, addr, bytes);
+                    if (bytes < field->array_count && bounded_strlen(addr, bytes + 1) > bytes) {
+                        sink_puts(sink, "...");
+                    }
+                } else {
+                    size_t count = (bytes / field->size > 0) ? bytes / field->size : 1;
+                    FieldType type = (field->type == FIELD_TYPE_STRING) ? FIELD_TYPE_U8 : field->type;
+                    
+                    sink_putc(sink, '[');
+                    for (j = 0; j < count && j < 16; j++) {
+                        if (j > 0) sink_puts(sink, ", ");
+                        if (!print_scalar(sink, type, addr + j * field->size)) sink_putc(sink, '?');
+                    }
+                    if (field->array_count > j) sink_puts(sink, ", ...");
+                    sink_putc(sink, ']');
+                }
+            } else if (!print_scalar(sink, field->type, addr)) {
+                sink_putc(sink, '?');
+            }
+            sink_endline(sink);
+        }
+        struct_path_pop(path, saved);
+    }
+}
+
+/**
+ * @brief 打印结构体（递归）
+ * @param ctx 打印上下文
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @param indent_level 缩进层级
+ *
+ * @note 描述符带有专用打印函数（STRUCT_DESC_SPECIALIZED）时直接调用它
+ */
+static void struct_print_internal(StructPrintContext* ctx, const char* var_name, const void* struct_data, 
+                                   const StructDescriptor* desc, int indent_level) {
+    StructPrintSink* sink = ctx->sink;
+    const StructPrintPrefixes* prefixes = NULL;
+    const StructFieldMask* mask;
+    int blank = 0;
+    size_t i;
+    
+    if (struct_data == NULL || desc == NULL) {
+        sink_puts(sink, "Error: NULL pointer!");
+        sink_endline(sink);
+        return;
+    }
+    
+    /* 专用打印函数按编译期配置生成，不支持过滤和运行时选项，此时走通用路径 */
+    if (desc->print_fn != NULL && ctx->filter == NULL && ctx->specialized_ok) {
+        /* 专用函数没有描述符遍历，整体计为格式化 */
+        STRUCT_PRINT_STATS_FORMAT_(ctx, desc->print_fn(ctx, var_name, struct_data, indent_level));
+        return;
+    }
+    if (ctx->options->terse) {
+        StructPrintPath path;
+        
+        struct_path_reset(&path);
+        if (var_name != NULL) struct_path_push(&path, var_name, 0);
+        print_terse_fields(ctx, &path, struct_data, desc);
+        return;
+    }
+    mask = filter_field_mask(ctx->filter, desc);
+    if (ctx->prefixes != NULL && ctx->prefixes->desc == desc && indent_level == 0) {
+        prefixes = ctx->prefixes;
+    }
+#ifdef STRUCT_PRINT_TEMPLATE_CACHE
+    if (prefixes == NULL) {
+        prefixes = struct_print_template_get(STRUCT_PRINT_TEMPLATE_CACHE, ctx, desc, indent_level);
+    }
+#endif
+    
+    /* 打印结构体头部信息 */
+    print_struct_header(ctx, var_name, struct_data, desc, indent_level);
+    
+    /* 打印每个字段 */
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        
+        if (!filter_field_on(mask, i)) continue;
+        
+        /* 字段之间空行（嵌套结构体除外，结构体数组按表格输出仍需空行） */
+        if (blank) {
+            sink_endline(sink);
+        }
+        blank = (field->type != FIELD_TYPE_STRUCT || field->array_count > 0);
+        
+        if (prefixes != NULL && i < prefixes->count) {
+            size_t start = (i > 0) ? prefixes->ends[i - 1] : 0;
+            sink_write(sink, prefixes->text + start, prefixes->ends[i] - start);
+        } else {
+            print_field_prefix(ctx, field->offset, field->name, strlen(field->name), indent_level);
+        }
+        
+        /* 打印字段值（嵌套结构体继续遍历，其余计为数值格式化）*/
+#ifdef STRUCT_PRINT_STATS_TABLE
+        if (field->type != FIELD_TYPE_STRUCT) {
+            STRUCT_PRINT_STATS_FORMAT_(ctx, print_field_value(ctx, field, struct_data, indent_level));
+            continue;
+        }
+#endif
+        print_field_value(ctx, field, struct_data, indent_level);
+    }
+    
+    print_struct_footer(ctx, indent_level);
+}
+
+/**
+ * @brief 打印单个字段的值（实现）
+ * @param ctx 打印上下文
+ * @param field 字段描述符
+ * @param struct_base 结构体基地址
+ * @param indent_level 缩进层级
+ */
+static void print_field_value(StructPrintContext* ctx, const FieldDescriptor* field, const void* struct_base, int indent_level) {
+    StructPrintSink* sink = ctx->sink;
+    const void* field_addr = (const u8*)struct_base + field->offset;
+    size_t i;
+    
+    /* 处理数组类型 */
+    if (field->array_count > 0 && field->type != FIELD_TYPE_STRUCT) {
+        size_t bytes = filter_array_bytes(ctx, field->array_count * field->size);
+        
+        /* 字符串类型 */
+        if (field_is_string(field, field_addr)) {
+            print_quoted_string(sink, field_addr, bytes);
+            if (bytes < field->array_count && bounded_strlen((const u8*)field_addr, bytes + 1) > bytes) {
+                sink_puts(sink, "...");
+            }
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, bytes, indent_level);
+        }
+        /* 数值数组 */
+        else {
+            size_t count = (bytes / field->size > 0) ? bytes / field->size : 1;
+            size_t max_show = (count > 16) ? 16 : count;
+            
+            sink_putc(sink, '[');
+            
+            for (i = 0; i < max_show; i++) {
+                const u8* elem_addr = (const u8*)field_addr + i * field->size;
+                
+                switch (field->type) {
+                    case FIELD_TYPE_U8:
+                        sink_put_u32(sink, *(const u8*)elem_addr);
+                        break;
+                    case FIELD_TYPE_U16:
+                        sink_put_u32(sink, *(const u16*)elem_addr);
+                        break;
+                    case FIELD_TYPE_U32:
+                        sink_put_u32(sink, *(const u32*)elem_addr);
+                        break;
+                    case FIELD_TYPE_S8:
+                        sink_put_s32(sink, *(const s8*)elem_addr);
+                        break;
+                    case FIELD_TYPE_S16:
+                        sink_put_s32(sink, *(const s16*)elem_addr);
+                        break;
+                    case FIELD_TYPE_S32:
+                        sink_put_s32(sink, *(const s32*)elem_addr);
+                        break;
+                    default:
+                        sink_putc(sink, '?');
+                        break;
+                }
+                
+                if (i < max_show - 1) {
+                    sink_puts(sink, ", ");
+                }
+            }
+            
+            if (field->array_count > max_show) {
+                sink_puts(sink, ", ...");
+            }
+            
+            sink_putc(sink, ']');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, bytes, indent_level);
+        }
+        return;
+    }
+    
+    /* 处理单一值类型 */
+    switch (field->type) {
+        case FIELD_TYPE_U8:
+            sink_put_u32(sink, *(const u8*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u8*)field_addr, 2);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 1, indent_level);
+            break;
+            
+        case FIELD_TYPE_U16:
+            sink_put_u32(sink, *(const u16*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u16*)field_addr, 4);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 2, indent_level);
+            break;
+            
+        case FIELD_TYPE_U32:
+            sink_put_u32(sink, *(const u32*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u32*)field_addr, 8);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 4, indent_level);
+            break;
+            
+        case FIELD_TYPE_S8:
+            sink_put_s32(sink, *(const s8*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u8*)field_addr, 2);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 1, indent_level);
+            break;
+            
+        case FIELD_TYPE_S16:
+            sink_put_s32(sink, *(const s16*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u16*)field_addr, 4);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 2, indent_level);
+            break;
+            
+        case FIELD_TYPE_S32:
+            sink_put_s32(sink, *(const s32*)field_addr);
+            sink_puts(sink, " (0x");
+            sink_put_hex(sink, *(const u32*)field_addr, 8);
+            sink_putc(sink, ')');
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, 4, indent_level);
+            break;
+            
+        case FIELD_TYPE_FLOAT: {
+            float val = *(const float*)field_addr;
+            sink_put_double(sink, val);
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, sizeof(float), indent_level);
+            break;
+        }
+            
+        case FIELD_TYPE_DOUBLE: {
+            double val = *(const double*)field_addr;
+            sink_put_double(sink, val);
+            sink_endline(sink);
+            ctx_hex_memory(ctx, field_addr, sizeof(double), indent_level);
+            break;
+        }
+            
+        case FIELD_TYPE_STRUCT:
+            if (field->nested_desc != NULL && !filter_can_descend(ctx)) {
+                /* 超过最大层数：只输出类型名 */
+                sink_putc(sink, '[');
+                if (field->array_count > 0) {
+                    sink_put_u32(sink, (u32)field->array_count);
+                    sink_puts(sink, " x ");
+                }
+                sink_puts(sink, field->nested_desc->struct_name);
+                sink_puts(sink, "] {...}");
+                sink_endline(sink);
+            } else if (field->nested_desc != NULL && field->array_count > 0) {
+                /* 结构体数组：[N x 类型名]，随后每个元素一行 */
+                size_t rows = filter_array_bytes(ctx, field->array_count * field->size) / field->size;
+                
+                if (rows == 0) rows = 1;
+                sink_putc(sink, '[');
+                sink_put_u32(sink, (u32)field->array_count);
+                sink_puts(sink, " x ");
+                sink_puts(sink, field->nested_desc->struct_name);
+                sink_putc(sink, ']');
+                sink_endline(sink);
+                struct_print_table_rows(sink, field_addr, rows, 0, field->nested_desc, indent_level + 2,
+                                        ctx->options->indent_spaces);
+                if (rows < field->array_count) {
+                    ctx_indent(ctx, indent_level + 2);
+                    sink_puts(sink, "...");
+                    sink_endline(sink);
+                }
+            } else if (field->nested_desc != NULL) {
+                sink_endline(sink);
+                ctx->depth++;
+                struct_print_internal(ctx, "", field_addr, field->nested_desc, indent_level + 1);
+                ctx->depth--;
+            } else {
+                sink_puts(sink, "<nested struct, no descriptor>");
+                sink_endline(sink);
+            }
+            break;
+            
+        default:
+            sink_puts(sink, "<unknown type>");
+            sink_endline(sink);
+            break;
+    }
+}
+
+
+/* ============================================================================
+ *                    专用打印函数（STRUCT_DESC_SPECIALIZED）
+ * ============================================================================ */
+
+/**
+ * @brief 专用打印：无符号整数 "值 (0xHEX)" + 十六进制内存
+ */
+static inline void print_spec_uint(StructPrintSink* sink, u32 value, int digits, const void* addr, int indent_level) {
+    sink_put_u32(sink, value);
+    sink_puts(sink, " (0x");
+    sink_put_hex(sink, value, digits);
+    sink_putc(sink, ')');
+    sink_endline(sink);
+    print_hex_memory(sink, (const u8*)addr, (size_t)digits / 2, STRUCT_PRINT_HEX_BYTES, indent_level);
+}
+
+/**
+ * @brief 专用打印：有符号整数 "值 (0xHEX)" + 十六进制内存
+ * @param raw 按字段宽度截断后的原始位
+ */
+static inline void print_spec_sint(StructPrintSink* sink, s32 value, u32 raw, int digits, const void* addr, int indent_level) {
+    sink_put_s32(sink, value);
+    sink_puts(sink, " (0x");
+    sink_put_hex(sink, raw, digits);
+    sink_putc(sink, ')');
+    sink_endline(sink);
+    print_hex_memory(sink, (const u8*)addr, (size_t)digits / 2, STRUCT_PRINT_HEX_BYTES, indent_level);
+}
+
+/**
+ * @brief 专用打印：浮点数 + 十六进制内存
+ */
+static inline void print_spec_double(StructPrintSink* sink, double value, const void* addr, size_t size, int indent_level) {
+    sink_put_double(sink, value);
+    sink_endline(sink);
+    print_hex_memory(sink, (const u8*)addr, size, STRUCT_PRINT_HEX_BYTES, indent_level);
+}
+
+/* MSVC 传统预处理器需要多一次展开才能拆分 __VA_ARGS__ */
+#define STRUCT_PRINT_SPEC_EXPAND_(x) x
+
+/* 字段列表 -> 描述符条目 */
+#define STRUCT_PRINT_SPEC_DESC_(T, kind, ...) \
+    STRUCT_PRINT_SPEC_EXPAND_(FIELD_##kind(T, __VA_ARGS__)),
+
+/* 字段列表 -> 展开后的打印代码（偏移、类型均为编译期常量）*/
+#define STRUCT_PRINT_SPEC_FIELD_(T, kind, ...) \
+    STRUCT_PRINT_SPEC_EXPAND_(STRUCT_PRINT_SPEC_##kind(T, __VA_ARGS__)) \
+    sp_field_++;
+
+/* 偏移量的第 shift 位开始的十六进制字符（常量表达式）*/
+#define STRUCT_PRINT_SPEC_HEX_(v, shift) \
+    ((char)((((v) >> (shift)) & 0xF) < 10 ? '0' + (((v) >> (shift)) & 0xF) : 'A' - 10 + (((v) >> (shift)) & 0xF)))
+
+/* 字段前缀在编译期生成（偏移量超过 4 位十六进制时使用通用实现）*/
+#if STRUCT_PRINT_SHOW_OFFSET
+#define STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    if (sp_sep_) sink_endline(sp_sink_); \
+    if (offsetof(T, field) > 0xFFFF) { \
+        print_field_prefix(ctx, offsetof(T, field), #field, sizeof(#field) - 1, indent_level); \
+    } else { \
+        static const char sp_prefix_[] = { ' ', ' ', '[', '+', '0', 'x', \
+            STRUCT_PRINT_SPEC_HEX_(offsetof(T, field), 12), STRUCT_PRINT_SPEC_HEX_(offsetof(T, field), 8), \
+            STRUCT_PRINT_SPEC_HEX_(offsetof(T, field), 4), STRUCT_PRINT_SPEC_HEX_(offsetof(T, field), 0), \
+            ']', ' ' }; \
+        print_indent(sp_sink_, indent_level); \
+        sink_write(sp_sink_, sp_prefix_, sizeof(sp_prefix_)); \
+        sink_write(sp_sink_, #field ": ", sizeof(#field ": ") - 1); \
+    }
+#else
+#define STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    if (sp_sep_) sink_endline(sp_sink_); \
+    print_indent(sp_sink_, indent_level); \
+    sink_write(sp_sink_, "  " #field ": ", sizeof("  " #field ": ") - 1);
+#endif
+
+#define STRUCT_PRINT_SPEC_U8(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_uint(sp_sink_, (u8)sp_data_->field, 2, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_U16(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_uint(sp_sink_, (u16)sp_data_->field, 4, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_U32(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_uint(sp_sink_, (u32)sp_data_->field, 8, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_S8(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_sint(sp_sink_, (s8)sp_data_->field, (u8)sp_data_->field, 2, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_S16(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_sint(sp_sink_, (s16)sp_data_->field, (u16)sp_data_->field, 4, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_S32(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_sint(sp_sink_, (s32)sp_data_->field, (u32)sp_data_->field, 8, &sp_data_->field, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_INT(T, field) STRUCT_PRINT_SPEC_S32(T, field)
+#define STRUCT_PRINT_SPEC_FLOAT(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_double(sp_sink_, sp_data_->field, &sp_data_->field, sizeof(float), indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_DOUBLE(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_spec_double(sp_sink_, sp_data_->field, &sp_data_->field, sizeof(double), indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_STRING(T, field) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_quoted_string(sp_sink_, sp_data_->field, sizeof(sp_data_->field) / sizeof(sp_data_->field[0])); \
+    sink_endline(sp_sink_); \
+    print_hex_memory(sp_sink_, (const u8*)sp_data_->field, sizeof(sp_data_->field) / sizeof(sp_data_->field[0]), \
+                     STRUCT_PRINT_HEX_BYTES, indent_level); \
+    sp_sep_ = 1;
+/* 数组和嵌套结构体较少出现在热点路径上，交给通用解释器 */
+#define STRUCT_PRINT_SPEC_ARRAY(T, field, element_type) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_field_value(ctx, sp_field_, struct_data, indent_level); sp_sep_ = 1;
+#define STRUCT_PRINT_SPEC_STRUCT(T, field, nested_desc) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_field_value(ctx, sp_field_, struct_data, indent_level); sp_sep_ = 0;
+#define STRUCT_PRINT_SPEC_STRUCT_ARRAY(T, field, nested_desc) STRUCT_PRINT_SPEC_PREFIX_(T, field) \
+    print_field_value(ctx, sp_field_, struct_data, indent_level); sp_sep_ = 1;
+
+/**
+ * @brief 定义描述符，同时生成该结构体的专用打印函数
+ * @param struct_type 结构体类型名
+ * @param desc_name 描述符变量名
+ * @param FIELDS 字段列表宏 FIELDS(X, T)，每个字段写作 X(T, 类型, 字段名[, 附加参数])，
+ *               类型与 FIELD_xxx 宏后缀相同（U8/U16/U32/S8/S16/S32/INT/FLOAT/DOUBLE/STRING/ARRAY/STRUCT/STRUCT_ARRAY）
+ *
+ * @note 专用函数中字段循环完全展开，类型是编译期常量（没有 switch 分发），
+ *       "  [+0xOFFS] name: " 前缀在编译期生成；
+ *       ARRAY/STRUCT/STRUCT_ARRAY 字段回退到通用解释器。输出与通用解释器完全相同
+ * @note 描述符本身与 BEGIN_STRUCT_DESC 定义的完全一样，所有 API（STRUCT_PRINT、STRUCT_LOG 解码、
+ *       捕获模式、嵌套打印等）都会自动使用专用函数
+ * @note 与 END_STRUCT_DESC 一样，宏后面不需要分号
+ *
+ * @example
+ * #define DEVICE_INFO_FIELDS(X, T) \
+ *     X(T, U8, device_id) \
+ *     X(T, U16, firmware_version) \
+ *     X(T, FLOAT, temperature) \
+ *     X(T, STRUCT, sensor, SensorData_desc)
+ *
+ * STRUCT_DESC_SPECIALIZED(DeviceInfo, DeviceInfo_desc, DEVICE_INFO_FIELDS)
+ */
+#define STRUCT_DESC_SPECIALIZED(struct_type, desc_name, FIELDS) \
+    static void desc_name##_print(StructPrintContext* ctx, const char* var_name, \
+                                  const void* struct_data, int indent_level); \
+    static const FieldDescriptor desc_name##_fields[] = { \
+        FIELDS(STRUCT_PRINT_SPEC_DESC_, struct_type) \
+    }; \
+    static u32 desc_name##_fingerprint_; \
+    static const StructDescriptor desc_name = { \
+        #struct_type, \
+        sizeof(struct_type), \
+        sizeof(desc_name##_fields) / sizeof(FieldDescriptor), \
+        desc_name##_fields, \
+        desc_name##_print, \
+        0, \
+        &desc_name##_fingerprint_ \
+    }; \
+    STRUCT_PRINT_AUTO_REGISTER_(desc_name) \
+    static void desc_name##_print(StructPrintContext* ctx, const char* var_name, \
+                                  const void* struct_data, int indent_level) { \
+        StructPrintSink* sp_sink_ = ctx->sink; \
+        const struct_type* sp_data_ = (const struct_type*)struct_data; \
+        const FieldDescriptor* sp_field_ = desc_name##_fields; \
+        int sp_sep_ = 0; \
+        print_struct_header(ctx, var_name, struct_data, &desc_name, indent_level); \
+        FIELDS(STRUCT_PRINT_SPEC_FIELD_, struct_type) \
+        (void)sp_data_; \
+        (void)sp_field_; \
+        (void)sp_sep_; \
+        print_struct_footer(ctx, indent_level); \
+    }
+
+
+/* ============================================================================
+ *                        性能统计
+ * ============================================================================ */
+
+/**
+ * @brief 统计的耗时分类
+ */
+typedef enum {
+    STRUCT_PRINT_STATS_TRAVERSE,    /**< 描述符遍历及头部、字段名等固定文本 */
+    STRUCT_PRINT_STATS_FORMAT,      /**< 字段值格式化（数值、字符串、十六进制内存）*/
+    STRUCT_PRINT_STATS_SINK,        /**< sink 刷新回调（串口发送、写文件等）*/
+    STRUCT_PRINT_STATS_PHASES
+} StructPrintStatsPhase;
+
+/**
+ * @brief 单个描述符的统计
+ * @note 时间单位与 STRUCT_PRINT_STATS_TIME() 相同
+ */
+typedef struct {
+    const StructDescriptor* desc;               /**< 描述符（NULL 表示空条目）*/
+    u32 count;                                  /**< 打印次数 */
+    uint64_t bytes;                             /**< 累计输出字节数 */
+    uint64_t total[STRUCT_PRINT_STATS_PHASES];  /**< 各部分累计耗时 */
+    u32 max[STRUCT_PRINT_STATS_PHASES];         /**< 各部分单次最大耗时 */
+    u32 max_call;                               /**< 单次打印的最大总耗时 */
+    u32 ready;                                  /**< 条目已填写完成（原子读写）*/
+} StructPrintStatsEntry;
+
+/**
+ * @brief 性能统计表（固定容量，按描述符指针查找）
+ * @note 新条目用 STRUCT_PRINT_ATOMIC_CAS 占用 count，多个线程同时插入不会越界，
+ *       同一描述符也不会占用两个条目；条目内的累加不加锁，多线程时数值只作参考
+ */
+typedef struct StructPrintStatsTable_t {
+    StructPrintStatsEntry* entries;             /**< 条目数组 */
+    u32 capacity;                               /**< 条目数 */
+    u32 count;                                  /**< 已占用的条目数（原子读写）*/
+    u32 dropped;                                /**< 没有记录的打印次数（表满，或条目正由其他线程填写）*/
+} StructPrintStatsTable;
+
+/**
+ * @brief 定义性能统计表
+ * @param name 统计表变量名（非 static，其他文件可用 extern struct StructPrintStatsTable_t 引用）
+ * @param capacity 最多统计的描述符个数
+ *
+ * @example
+ * STRUCT_PRINT_STATS_DEFINE(g_print_stats, 16);
+ */
+#define STRUCT_PRINT_STATS_DEFINE(name, capacity) \
+    static StructPrintStatsEntry name##_entries_[capacity]; \
+    StructPrintStatsTable name = { name##_entries_, (capacity), 0, 0 }
+
+/**
+ * @brief 查找描述符的统计条目
+ * @return 条目指针；没有记录过返回 NULL
+ */
+static inline const StructPrintStatsEntry* struct_print_stats_find(const StructPrintStatsTable* table,
+                                                                   const StructDescriptor* desc) {
+    u32 count = STRUCT_PRINT_ATOMIC_LOAD(&table->count);
+    u32 i;
+    
+    for (i = 0; i < count && i < table->capacity; i++) {
+        const StructPrintStatsEntry* e = &table->entries[i];
+        
+        if (STRUCT_PRINT_ATOMIC_LOAD(&e->ready) && e->desc == desc) return e;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 清空统计表
+ */
+static inline void struct_print_stats_reset(StructPrintStatsTable* table) {
+    memset(table->entries, 0, table->capacity * sizeof(StructPrintStatsEntry));
+    table->count = 0;
+    table->dropped = 0;
+}
+
+/**
+ * @brief 取得描述符的条目（没有时占用一个新条目）
+ * @return 条目；表满或前面的条目正由其他线程填写时返回 NULL（本次不记录）
+ *
+ * @note 条目按顺序占用：遇到未填写完的条目时不跳过，否则同一描述符可能再占用一个条目
+ */
+static inline StructPrintStatsEntry* stats_entry_get(StructPrintStatsTable* table, const StructDescriptor* desc) {
+    u32 count = STRUCT_PRINT_ATOMIC_LOAD(&table->count);
+    u32 i = 0;
+    
+    for (;;) {
+        StructPrintStatsEntry* e;
+        
+        for (; i < count && i < table->capacity; i++) {
+            e = &table->entries[i];
+            if (!STRUCT_PRINT_ATOMIC_LOAD(&e->ready)) return NULL;
+            if (e->desc == desc) return e;
+        }
+        if (count >= table->capacity) return NULL;
+        if (STRUCT_PRINT_ATOMIC_CAS(&table->count, &count, count + 1u)) {
+            e = &table->entries[count];
+            memset(e, 0, sizeof(*e));
+            e->desc = desc;
+            STRUCT_PRINT_ATOMIC_STORE(&e->ready, 1u);
+            return e;
+        }
+        /* 其他线程先占用了条目：count 已更新，继续检查新条目 */
+    }
+}
+
+/**
+ * @brief 记录一次打印
+ * @param table 统计表
+ * @param desc 描述符
+ * @param ticks 各部分耗时
+ * @param bytes 输出字节数
+ */
+static inline void struct_print_stats_record(StructPrintStatsTable* table, const StructDescriptor* desc,
+                                             const u32 ticks[STRUCT_PRINT_STATS_PHASES], size_t bytes) {
+    StructPrintStatsEntry* e = stats_entry_get(table, desc);
+    u32 call = 0;
+    int p;
+    
+    if (e == NULL) {
+        u32 dropped = STRUCT_PRINT_ATOMIC_LOAD(&table->dropped);
+        while (!STRUCT_PRINT_ATOMIC_CAS(&table->dropped, &dropped, dropped + 1u)) {
+        }
+        return;
+    }
+    e->count++;
+    e->bytes += bytes;
+    for (p = 0; p < STRUCT_PRINT_STATS_PHASES; p++) {
+        e->total[p] += ticks[p];
+        if (ticks[p] > e->max[p]) e->max[p] = ticks[p];
+        call += ticks[p];
+    }
+    if (call > e->max_call) e->max_call = call;
+}
+
+/**
+ * @brief 右对齐输出一个数值列
+ */
+static inline void stats_put_column(StructPrintSink* sink, uint64_t value, size_t width) {
+    char tmp[24];
+    size_t n = fmt_u64_dec(tmp, value);
+    
+    sink_fill(sink, ' ', (n < width) ? width - n : 1);
+    sink_write(sink, tmp, n);
+}
+
+/**
+ * @brief 输出统计表（每个描述符一行：次数、平均字节数、各部分平均耗时、单次最大耗时）
+ * @param sink 输出缓冲区
+ * @param table 统计表
+ *
+ * @example 输出示例（单位为 STRUCT_PRINT_STATS_TIME 的单位）
+ * struct                count  bytes/call    traverse      format        sink    max call
+ * SystemStatus             10        1350         412         690         238        1530
+ */
+static inline void struct_print_stats_dump_to(StructPrintSink* sink, const StructPrintStatsTable* table) {
+    u32 count = STRUCT_PRINT_ATOMIC_LOAD(&table->count);
+    u32 i;
+    
+    sink_puts(sink, "struct                count  bytes/call    traverse      format        sink    max call");
+    sink_endline(sink);
+    for (i = 0; i < count && i < table->capacity; i++) {
+        const StructPrintStatsEntry* e = &table->entries[i];
+        size_t name_len;
+        int p;
+        
+        if (!STRUCT_PRINT_ATOMIC_LOAD(&e->ready) || e->count == 0) continue;
+        name_len = strlen(e->desc->struct_name);
+        sink_write(sink, e->desc->struct_name, name_len);
+        sink_fill(sink, ' ', (name_len < 16) ? 16 - name_len : 1);
+        stats_put_column(sink, e->count, 10);
+        stats_put_column(sink, e->bytes / e->count, 12);
+        for (p = 0; p < STRUCT_PRINT_STATS_PHASES; p++) {
+            stats_put_column(sink, e->total[p] / e->count, 12);
+        }
+        stats_put_column(sink, e->max_call, 12);
+        sink_endline(sink);
+    }
+    if (STRUCT_PRINT_ATOMIC_LOAD(&table->dropped) > 0) {
+        sink_puts(sink, "(");
+        sink_put_u32(sink, table->dropped);
+        sink_puts(sink, " prints not recorded: table full or entry being added)");
+        sink_endline(sink);
+    }
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 通过 STRUCT_PRINT_PRINTF 输出统计表
+ */
+static inline void struct_print_stats_dump(const StructPrintStatsTable* table) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_stats_dump_to(&sink, table);
+    struct_print_out_end(&sink, &locked);
+}
+
+/**
+ * @brief 输出 STRUCT_PRINT_STATS_TABLE 的统计表（未启用性能统计时为空操作）
+ */
+#ifdef STRUCT_PRINT_STATS_TABLE
+#define STRUCT_PRINT_STATS_DUMP() struct_print_stats_dump(STRUCT_PRINT_STATS_TABLE)
+#else
+#define STRUCT_PRINT_STATS_DUMP() ((void)0)
+#endif
+
+/**
+ * @brief 打印一条完整记录并刷新 sink（所有顶层打印入口共用）
+ * @param ctx 打印上下文
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ *
+ * @note 定义了 STRUCT_PRINT_STATS_TABLE 时在这里计时并记入统计表：
+ *       sink 耗时为刷新回调的时间，格式化耗时为字段值区间的时间（已扣除其中的 sink 耗时），
+ *       其余都计为遍历
+ */
+static inline void struct_print_record(StructPrintContext* ctx, const char* var_name, const void* struct_data,
+                                       const StructDescriptor* desc) {
+#ifdef STRUCT_PRINT_STATS_TABLE
+    StructPrintSink* sink = ctx->sink;
+    u32 t0 = (u32)STRUCT_PRINT_STATS_TIME();
+    u32 sink0 = sink->stats_ticks;
+    size_t bytes0 = sink->stats_bytes + sink->length;
+    u32 ticks[STRUCT_PRINT_STATS_PHASES];
+    u32 total;
+    
+    ctx->stats_format = 0;
+#endif
+    struct_print_internal(ctx, var_name, struct_data, desc, 0);
+    if (!ctx->hold_flush) {
+        struct_print_sink_flush(ctx->sink);
+    }
+#ifdef STRUCT_PRINT_STATS_TABLE
+    total = (u32)STRUCT_PRINT_STATS_TIME() - t0;
+    ticks[STRUCT_PRINT_STATS_SINK] = sink->stats_ticks - sink0;
+    ticks[STRUCT_PRINT_STATS_FORMAT] = ctx->stats_format;
+    ticks[STRUCT_PRINT_STATS_TRAVERSE] = total - ticks[STRUCT_PRINT_STATS_SINK] - ticks[STRUCT_PRINT_STATS_FORMAT];
+    if (ticks[STRUCT_PRINT_STATS_TRAVERSE] > total) ticks[STRUCT_PRINT_STATS_TRAVERSE] = 0;  /* 时间戳精度不足 */
+    if (desc != NULL) {
+        /* 批量打印时记录可能仍在缓冲区中，终点与起点一样计入未刷新的部分 */
+        struct_print_stats_record(STRUCT_PRINT_STATS_TABLE, desc, ticks,
+                                  sink->stats_bytes + sink->length - bytes0);
+    }
+#endif
+}
+
+
+/* ============================================================================
+ *                        用户API接口
+ * ============================================================================ */
+
+/**
+ * @brief 打印结构体到指定输出缓冲区
+ * @param sink 输出缓冲区（由 struct_print_sink_init 初始化）
+ * @param var_name 变量名（字符串）
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符指针
+ * 
+ * @note 返回前会刷新 sink 中剩余的数据
+ * @note 推荐使用 STRUCT_PRINT_TO 宏
+ */
+static inline void struct_print_to(StructPrintSink* sink, const char* var_name, 
+                                   const void* struct_data, const StructDescriptor* desc) {
+    StructPrintContext ctx;
+    
+    struct_print_context_init(&ctx, sink);
+    struct_print_record(&ctx, var_name, struct_data, desc);
+}
+
+/**
+ * @brief 打印结构体（内部函数）
+ * @param var_name 变量名（字符串）
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符指针
+ * 
+ * @note 使用栈上的行缓冲区，每行调用一次 STRUCT_PRINT_PRINTF
+ * @note 用户请使用 STRUCT_PRINT 宏，不要直接调用此函数
+ */
+static inline void struct_print(const char* var_name, const void* struct_data, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_to(&sink, var_name, struct_data, desc);
+    struct_print_out_end(&sink, &locked);
+}
+
+/**
+ * @brief 按指定选项打印结构体到输出缓冲区
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @param options 输出选项（NULL 表示编译期默认值，如 &struct_print_options_terse）
+ *
+ * @note 选项只影响本次调用；需要全局生效时定义 STRUCT_PRINT_GLOBAL_OPTIONS
+ */
+static inline void struct_print_options_to(StructPrintSink* sink, const char* var_name, const void* struct_data,
+                                           const StructDescriptor* desc, const StructPrintOptions* options) {
+    StructPrintContext ctx;
+    
+    struct_print_context_init(&ctx, sink);
+    struct_print_context_set_options(&ctx, options);
+    struct_print_record(&ctx, var_name, struct_data, desc);
+}
+
+/**
+ * @brief 按指定选项打印结构体（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_WITH 宏
+ */
+static inline void struct_print_options(const char* var_name, const void* struct_data,
+                                        const StructDescriptor* desc, const StructPrintOptions* options) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_options_to(&sink, var_name, struct_data, desc, options);
+    struct_print_out_end(&sink, &locked);
+}
+
+/**
+ * @brief 按字段名生成字段掩码位图
+ * @param desc 结构体描述符
+ * @param names 逗号分隔的字段名，如 "MsgDataString,Imei"
+ * @param bits 位图（先清零，第 i 位对应 fields[i]）
+ * @param words 位图的字数（STRUCT_FIELD_BITS_WORDS(desc->field_count) 可容纳全部字段）
+ * @return 0 全部名称都已置位；否则为没有置位的名称个数（拼写错误，或字段超出位图）
+ *
+ * @example
+ * static u32 exclude[STRUCT_FIELD_BITS_WORDS(7)];
+ * static StructFieldMask masks[1];
+ * masks[0].desc = &stCircuitMqttCmdData_desc;
+ * masks[0].exclude = exclude;
+ * masks[0].words = STRUCT_FIELD_BITS_WORDS(7);
+ * if (struct_field_bits(&stCircuitMqttCmdData_desc, "MsgDataString", exclude, masks[0].words) != 0) { ... }
+ */
+static inline size_t struct_field_bits(const StructDescriptor* desc, const char* names, u32* bits, size_t words) {
+    size_t unknown = 0;
+    
+    memset(bits, 0, words * sizeof(u32));
+    while (*names != '\0') {
+        size_t len = 0;
+        size_t i;
+        
+        while (names[len] != '\0' && names[len] != ',') len++;
+        for (i = 0; i < desc->field_count; i++) {
+            if (strncmp(desc->fields[i].name, names, len) == 0 && desc->fields[i].name[len] == '\0') break;
+        }
+        if (i < desc->field_count && i / 32u < words) {
+            bits[i / 32u] |= 1u << (i % 32u);
+        } else if (len > 0) {
+            unknown++;
+        }
+        names += len;
+        if (*names == ',') names++;
+    }
+    return unknown;
+}
+
+/**
+ * @brief 按过滤条件打印结构体到指定输出缓冲区
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @param filter 过滤条件（NULL 与 struct_print_to 相同）
+ *
+ * @note 被掩码排除的字段、超过层数的嵌套结构体、超过字节上限的数组部分都不做格式化
+ * @note 有过滤条件时专用打印函数（STRUCT_DESC_SPECIALIZED）不生效，走通用路径
+ */
+static inline void struct_print_filtered_to(StructPrintSink* sink, const char* var_name, const void* struct_data,
+                                            const StructDescriptor* desc, const StructPrintFilter* filter) {
+    StructPrintContext ctx;
+    
+    struct_print_context_init(&ctx, sink);
+    ctx.filter = filter;
+    struct_print_record(&ctx, var_name, struct_data, desc);
+}
+
+/**
+ * @brief 按过滤条件打印结构体（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_FILTERED 宏
+ */
+static inline void struct_print_filtered(const char* var_name, const void* struct_data,
+                                         const StructDescriptor* desc, const StructPrintFilter* filter) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_filtered_to(&sink, var_name, struct_data, desc, filter);
+    struct_print_out_end(&sink, &locked);
+}
+
+
+/* ============================================================================
+ *                    批量打印（STRUCT_PRINT_BATCH）
+ * ============================================================================ */
+
+/* 批量打印时预生成顶层字段前缀的缓冲区大小（栈上分配，不超过 65535）*/
+#ifndef STRUCT_PRINT_BATCH_PREFIX_SIZE
+#define STRUCT_PRINT_BATCH_PREFIX_SIZE      512
+#endif
+
+/* 最多预生成前缀的顶层字段数（之后的字段按常规方式输出）*/
+#ifndef STRUCT_PRINT_BATCH_PREFIX_FIELDS
+#define STRUCT_PRINT_BATCH_PREFIX_FIELDS    32
+#endif
+
+/**
+ * @brief 批量打印多个结构体实例到指定输出缓冲区
+ * @param sink 输出缓冲区
+ * @param var_name 数组名（每条记录显示为 var_name[i]）
+ * @param base 首个实例地址；stride 为 0 时为指针数组（const void* const*）
+ * @param stride 相邻实例的间隔字节数（结构体数组为 sizeof 元素，0 表示指针数组）
+ * @param count 实例个数
+ * @param desc 结构体描述符
+ *
+ * @note 输出与逐个调用 struct_print_to 相同；上下文初始化、顶层字段前缀
+ *       （偏移、字段名）只在循环外生成一次，记录之间不刷新 sink，返回前统一刷新
+ * @note 使用 STRUCT_PRINT_SINK_FLUSH_FULL 的大缓冲区时，整批记录只调用很少几次输出回调
+ * @note 指针数组中的 NULL 输出 "Error: NULL pointer!"
+ */
+static inline void struct_print_batch_to(StructPrintSink* sink, const char* var_name, const void* base,
+                                         size_t stride, size_t count, const StructDescriptor* desc) {
+    char text[STRUCT_PRINT_BATCH_PREFIX_SIZE];
+    u16 ends[STRUCT_PRINT_BATCH_PREFIX_FIELDS];
+    StructPrintPrefixes prefixes;
+    StructPrintContext ctx;
+    StructPrintPath path;
+    size_t i;
+    
+    if (base == NULL || desc == NULL) {
+        sink_puts(sink, "Error: NULL pointer!");
+        sink_endline(sink);
+        struct_print_sink_flush(sink);
+        return;
+    }
+    
+    struct_print_context_init(&ctx, sink);
+    prefixes.desc = desc;
+    prefixes.text = text;
+    prefixes.ends = ends;
+    prefixes.count = prefixes_build(&ctx, desc, 0, text, sizeof(text), ends, STRUCT_PRINT_BATCH_PREFIX_FIELDS);
+    ctx.prefixes = &prefixes;
+    ctx.hold_flush = 1;
+    
+    struct_path_reset(&path);
+    if (var_name != NULL) struct_path_push(&path, var_name, 0);
+    
+    for (i = 0; i < count; i++) {
+        const void* data = (stride != 0) ? (const void*)((const u8*)base + i * stride)
+                                         : ((const void* const*)base)[i];
+        size_t saved = struct_path_push_index(&path, i);
+        
+        struct_print_record(&ctx, path.buf, data, desc);
+        struct_path_pop(&path, saved);
+    }
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 批量打印多个结构体实例（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_BATCH 宏（结构体数组），指针数组直接调用本函数（stride 为 0）
+ */
+static inline void struct_print_batch(const char* var_name, const void* base, size_t stride,
+                                      size_t count, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_batch_to(&sink, var_name, base, stride, count, desc);
+    struct_print_out_end(&sink, &locked);
+}
+
+/* ============================================================================
+ *                    二进制日志（STRUCT_LOG，主机端解码）
+ * ============================================================================ */
+
+/**
+ * @brief 二进制日志帧格式（小端序）
+ *
+ *   偏移  长度  内容
+ *   0     2     帧头 'S' 'L'
+ *   2     1     版本号 STRUCT_LOG_VERSION
+ *   3     1     标志位（STRUCT_LOG_FLAG_xxx）
+ *   4     4     描述符 ID（struct_desc_id，或带 FINGERPRINT 标志时为 struct_desc_fingerprint）
+ *   8     4     时间戳（STRUCT_LOG_TIMESTAMP）
+ *   12    4     结构体在设备上的地址
+ *   16    2     负载长度 N（= struct_size）
+ *   18    N     结构体原始字节（memcpy）
+ *   18+N  2     Fletcher-16 校验（覆盖偏移 2 ~ 18+N-1）
+ *
+ * @note 设备端只做 memcpy，不做任何格式化；主机端使用同一份描述符表，
+ *       通过 struct_log_print 还原为与 STRUCT_PRINT 相同的文本
+ * @note 主机端解码要求结构体布局一致（同样的字节序和对齐规则）
+ */
+#define STRUCT_LOG_MAGIC0           0x53    /* 'S' */
+#define STRUCT_LOG_MAGIC1           0x4C    /* 'L' */
+#define STRUCT_LOG_VERSION          1
+#define STRUCT_LOG_HEADER_SIZE      18
+#define STRUCT_LOG_TRAILER_SIZE     2
+#define STRUCT_LOG_FRAME_SIZE(payload_len) \
+    (STRUCT_LOG_HEADER_SIZE + (payload_len) + STRUCT_LOG_TRAILER_SIZE)
+#define STRUCT_LOG_FLAG_FINGERPRINT 0x01    /* 偏移 4 处为布局指纹 */
+
+/**
+ * @brief 配置帧头中的描述符 ID 类型
+ * @note 0（默认）：结构体名称哈希 struct_desc_id，旧解码器可直接识别
+ *       1：布局指纹 struct_desc_fingerprint，主机端可按指纹选择与固件一致的 Schema，
+ *          布局变化后的旧日志不会被新描述符误解析
+ * @note C 描述符的指纹在运行时计算（O(字段数)），C++17 STRUCT_PRINT_REFLECT 的指纹为编译期常量
+ */
+#ifndef STRUCT_LOG_ID_FINGERPRINT
+#define STRUCT_LOG_ID_FINGERPRINT 0
+#endif
+
+/**
+ * @brief 配置时间戳函数
+ * @note 返回 u32，例如 HAL_GetTick() 或 DWT->CYCCNT
+ *
+ * @example
+ * #define STRUCT_LOG_TIMESTAMP() HAL_GetTick()
+ */
+#ifndef STRUCT_LOG_TIMESTAMP
+#define STRUCT_LOG_TIMESTAMP() 0u
+#endif
+
+/**
+ * @brief 配置二进制输出函数
+ * @note 函数签名等价于：void func(const void* data, size_t len)
+ *       每帧调用三次（帧头、结构体数据、校验）
+ *
+ * @example
+ * #define STRUCT_LOG_WRITE(data, len) HAL_UART_Transmit(&huart1, (uint8_t*)(data), (len), 100)
+ */
+#ifndef STRUCT_LOG_WRITE
+#define STRUCT_LOG_WRITE(data, len) fwrite((data), 1, (len), stdout)
+#endif
+
+/**
+ * @brief 计算结构体名称对应的描述符 ID（FNV-1a 32 位哈希）
+ * @param name 结构体名称
+ * @return 描述符 ID
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 struct_name_id(const char* name) {
+    const char* p = name;
+    u32 hash = 2166136261u;
+    
+    while (*p != '\0') {
+        hash ^= (u8)*p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief 计算描述符 ID（结构体名称的 FNV-1a 32 位哈希）
+ * @param desc 结构体描述符
+ * @return 描述符 ID
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 struct_desc_id(const StructDescriptor* desc) {
+    return struct_name_id(desc->struct_name);
+}
+
+/**
+ * @brief FNV-1a 累加一个字符串（含结尾 '\0'，避免 "ab"+"c" 与 "a"+"bc" 相同）
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 fingerprint_add_str(u32 hash, const char* p) {
+    do {
+        hash ^= (u8)*p;
+        hash *= 16777619u;
+    } while (*p++ != '\0');
+    return hash;
+}
+
+/**
+ * @brief FNV-1a 累加一个整数（按小端 4 字节，与主机字长无关）
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 fingerprint_add_u32(u32 hash, size_t value) {
+    int i = 0;
+    
+    for (i = 0; i < 4; i++) {
+        hash ^= (u8)((u32)value >> (i * 8));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline STRUCT_PRINT_CONSTEXPR u32 struct_desc_fingerprint(const StructDescriptor* desc);
+
+/**
+ * @brief 计算结构体布局指纹
+ * @param struct_name 结构体名称
+ * @param struct_size 结构体大小
+ * @param fields 字段描述符数组
+ * @param field_count 字段数量
+ * @return 指纹（非 0）
+ *
+ * @note 覆盖结构体名称、大小，以及每个字段的名称、类型、偏移、大小、数组元素个数；
+ *       嵌套结构体并入其自身的指纹，因此子结构体布局变化也会改变父结构体的指纹
+ * @note C++17 下为 constexpr，STRUCT_PRINT_REFLECT 在编译期写入 StructDescriptor::fingerprint
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 struct_layout_fingerprint(const char* struct_name, size_t struct_size,
+                                                                   const FieldDescriptor* fields, size_t field_count) {
+    u32 hash = 2166136261u;
+    size_t i = 0;
+    
+    hash = fingerprint_add_str(hash, struct_name);
+    hash = fingerprint_add_u32(hash, struct_size);
+    hash = fingerprint_add_u32(hash, field_count);
+    for (i = 0; i < field_count; i++) {
+        hash = fingerprint_add_str(hash, fields[i].name);
+        hash = fingerprint_add_u32(hash, (size_t)fields[i].type);
+        hash = fingerprint_add_u32(hash, fields[i].offset);
+        hash = fingerprint_add_u32(hash, fields[i].size);
+        hash = fingerprint_add_u32(hash, fields[i].array_count);
+        if (fields[i].nested_desc != NULL) {
+            hash = fingerprint_add_u32(hash, struct_desc_fingerprint(fields[i].nested_desc));
+        }
+    }
+    /* 0 保留为"未计算" */
+    return (hash != 0) ? hash : 1u;
+}
+
+/**
+ * @brief 获取描述符的布局指纹
+ * @param desc 结构体描述符
+ * @return 指纹；描述符中已有编译期指纹时直接返回，否则第一次调用时计算（O(字段数)）并写入缓存
+ *
+ * @note C 的常量表达式无法对字符串求哈希，BEGIN_STRUCT_DESC 定义的描述符指纹为 0，
+ *       由本函数在运行时计算一次，保存在 END_STRUCT_DESC 定义的缓存中（之后每帧只读一次）；
+ *       没有缓存的描述符（fingerprint_cache 为 NULL）每次现场计算
+ * @note 多线程同时第一次调用时可能各算一次，结果相同
+ */
+static inline STRUCT_PRINT_CONSTEXPR u32 struct_desc_fingerprint(const StructDescriptor* desc) {
+    u32 hash = 0;
+    
+    if (desc->fingerprint != 0) return desc->fingerprint;
+    if (desc->fingerprint_cache != NULL) {
+        hash = STRUCT_PRINT_ATOMIC_LOAD(desc->fingerprint_cache);
+        if (hash != 0) return hash;
+    }
+    hash = struct_layout_fingerprint(desc->struct_name, desc->struct_size, desc->fields, desc->field_count);
+    if (desc->fingerprint_cache != NULL) {
+        STRUCT_PRINT_ATOMIC_STORE(desc->fingerprint_cache, hash);
+    }
+    return hash;
+}
+
+/**
+ * @brief Fletcher-16 校验（增量计算）
+ * @param sums 两个累加和（初始为 0）
+ * @param data 数据指针
+ * @param len 数据长度
+ */
+static inline void struct_log_checksum(u32 sums[2], const u8* data, size_t len) {
+    u32 a = sums[0];
+    u32 b = sums[1];
+    
+    /* 每 360 字节取模一次，32 位累加和不会溢出 */
+    while (len > 0) {
+        size_t n = (len < 360) ? len : 360;
+        len -= n;
+        while (n-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= 255u;
+        b %= 255u;
+    }
+    sums[0] = a;
+    sums[1] = b;
+}
+
+/**
+ * @brief 按给定的 ID 和标志填写帧头
+ * @param header 帧头缓冲区（STRUCT_LOG_HEADER_SIZE 字节）
+ * @param id 描述符 ID 或布局指纹
+ * @param flags 帧标志（STRUCT_LOG_FLAG_xxx）
+ * @param data 结构体数据指针（记录其地址）
+ * @param len 负载长度
+ * @param timestamp 时间戳
+ */
+static inline void struct_log_write_header(u8* header, u32 id, u8 flags, const void* data,
+                                           size_t len, u32 timestamp) {
+    u32 addr = (u32)(uintptr_t)data;
+    int i;
+    
+    header[0] = STRUCT_LOG_MAGIC0;
+    header[1] = STRUCT_LOG_MAGIC1;
+    header[2] = STRUCT_LOG_VERSION;
+    header[3] = flags;
+    for (i = 0; i < 4; i++) {
+        header[4 + i] = (u8)(id >> (i * 8));
+        header[8 + i] = (u8)(timestamp >> (i * 8));
+        header[12 + i] = (u8)(addr >> (i * 8));
+    }
+    header[16] = (u8)len;
+    header[17] = (u8)(len >> 8);
+}
+
+/**
+ * @brief 填写帧头（ID 类型由 STRUCT_LOG_ID_FINGERPRINT 决定）
+ * @param header 帧头缓冲区（STRUCT_LOG_HEADER_SIZE 字节）
+ * @param desc 结构体描述符
+ * @param data 结构体数据指针
+ * @param timestamp 时间戳
+ */
+static inline void struct_log_build_header(u8* header, const StructDescriptor* desc, 
+                                           const void* data, u32 timestamp) {
+    if (STRUCT_LOG_ID_FINGERPRINT) {
+        struct_log_write_header(header, struct_desc_fingerprint(desc), STRUCT_LOG_FLAG_FINGERPRINT,
+                                data, desc->struct_size, timestamp);
+    } else {
+        struct_log_write_header(header, struct_desc_id(desc), 0, data, desc->struct_size, timestamp);
+    }
+}
+
+/**
+ * @brief 计算整帧的校验值
+ */
+static inline void struct_log_build_trailer(u8* trailer, const u8* header, const void* data, size_t len) {
+    u32 sums[2] = { 0, 0 };
+    
+    struct_log_checksum(sums, header + 2, STRUCT_LOG_HEADER_SIZE - 2);
+    struct_log_checksum(sums, (const u8*)data, len);
+    trailer[0] = (u8)sums[0];
+    trailer[1] = (u8)sums[1];
+}
+
+/**
+ * @brief 将结构体编码为一帧二进制日志
+ * @param out 输出缓冲区
+ * @param out_size 输出缓冲区大小
+ * @param desc 结构体描述符
+ * @param data 结构体数据指针
+ * @param timestamp 时间戳
+ * @return 帧长度；缓冲区不足或结构体超过 65535 字节时返回 0
+ */
+static inline size_t struct_log_encode(u8* out, size_t out_size, const StructDescriptor* desc,
+                                       const void* data, u32 timestamp) {
+    size_t len = desc->struct_size;
+    
+    if (len > 0xFFFFu || out_size < STRUCT_LOG_FRAME_SIZE(len)) return 0;
+    
+    struct_log_build_header(out, desc, data, timestamp);
+    memcpy(out + STRUCT_LOG_HEADER_SIZE, data, len);
+    struct_log_build_trailer(out + STRUCT_LOG_HEADER_SIZE + len, out, data, len);
+    return STRUCT_LOG_FRAME_SIZE(len);
+}
+
+/**
+ * @brief 输出一帧二进制日志到指定 Sink
+ * @param sink 输出缓冲区（建议使用 STRUCT_PRINT_SINK_FLUSH_FULL）
+ * @param desc 结构体描述符
+ * @param data 结构体数据指针
+ * @param timestamp 时间戳
+ */
+static inline void struct_log_to(StructPrintSink* sink, const StructDescriptor* desc,
+                                 const void* data, u32 timestamp) {
+    u8 header[STRUCT_LOG_HEADER_SIZE];
+    u8 trailer[STRUCT_LOG_TRAILER_SIZE];
+    
+    if (desc == NULL || data == NULL || desc->struct_size > 0xFFFFu) return;
+    
+    struct_log_build_header(header, desc, data, timestamp);
+    struct_log_build_trailer(trailer, header, data, desc->struct_size);
+    sink_write(sink, (const char*)header, sizeof(header));
+    sink_write(sink, (const char*)data, desc->struct_size);
+    sink_write(sink, (const char*)trailer, sizeof(trailer));
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 输出一帧二进制日志（使用 STRUCT_LOG_WRITE）
+ * @param desc 结构体描述符
+ * @param data 结构体数据指针
+ *
+ * @note 用户请使用 STRUCT_LOG 宏
+ */
+static inline void struct_log(const StructDescriptor* desc, const void* data) {
+    u8 header[STRUCT_LOG_HEADER_SIZE];
+    u8 trailer[STRUCT_LOG_TRAILER_SIZE];
+    
+    if (desc == NULL || data == NULL || desc->struct_size > 0xFFFFu) return;
+    
+    struct_log_build_header(header, desc, data, STRUCT_LOG_TIMESTAMP());
+    struct_log_build_trailer(trailer, header, data, desc->struct_size);
+    STRUCT_LOG_WRITE(header, sizeof(header));
+    STRUCT_LOG_WRITE(data, desc->struct_size);
+    STRUCT_LOG_WRITE(trailer, sizeof(trailer));
+}
+
+/**
+ * @brief 解码后的日志帧
+ */
+typedef struct {
+    u32 desc_id;                                /**< 描述符 ID 或布局指纹（见 flags）*/
+    u8 flags;                                   /**< 帧标志（STRUCT_LOG_FLAG_xxx）*/
+    u32 timestamp;                              /**< 时间戳 */
+    u32 address;                                /**< 结构体在设备上的地址 */
+    const u8* payload;                          /**< 结构体原始字节（指向输入缓冲区）*/
+    size_t payload_len;                         /**< 负载长度 */
+} StructLogFrame;
+
+/**
+ * @brief 从字节流中解析一帧
+ * @param buf 输入数据
+ * @param len 输入数据长度
+ * @param frame 解析结果
+ * @return >0：帧长度（解析成功）；0：数据不足，需要更多输入；
+ *         -1：buf 起始处不是有效帧（调用者应丢弃 1 字节后重试）
+ */
+static inline int struct_log_parse(const u8* buf, size_t len, StructLogFrame* frame) {
+    size_t payload_len;
+    u8 trailer[STRUCT_LOG_TRAILER_SIZE];
+    
+    if (len < 1) return 0;
+    if (buf[0] != STRUCT_LOG_MAGIC0) return -1;
+    if (len < 2) return 0;
+    if (buf[1] != STRUCT_LOG_MAGIC1) return -1;
+    if (len < 3) return 0;
+    if (buf[2] != STRUCT_LOG_VERSION) return -1;
+    if (len < STRUCT_LOG_HEADER_SIZE) return 0;
+    
+    payload_len = (size_t)buf[16] | ((size_t)buf[17] << 8);
+    if (len < STRUCT_LOG_FRAME_SIZE(payload_len)) return 0;
+    
+    struct_log_build_trailer(trailer, buf, buf + STRUCT_LOG_HEADER_SIZE, payload_len);
+    if (trailer[0] != buf[STRUCT_LOG_HEADER_SIZE + payload_len] ||
+        trailer[1] != buf[STRUCT_LOG_HEADER_SIZE + payload_len + 1]) {
+        return -1;
+    }
+    
+    frame->desc_id = (u32)buf[4] | ((u32)buf[5] << 8) | ((u32)buf[6] << 16) | ((u32)buf[7] << 24);
+    frame->flags = buf[3];
+    frame->timestamp = (u32)buf[8] | ((u32)buf[9] << 8) | ((u32)buf[10] << 16) | ((u32)buf[11] << 24);
+    frame->address = (u32)buf[12] | ((u32)buf[13] << 8) | ((u32)buf[14] << 16) | ((u32)buf[15] << 24);
+    frame->payload = buf + STRUCT_LOG_HEADER_SIZE;
+    frame->payload_len = payload_len;
+    return (int)STRUCT_LOG_FRAME_SIZE(payload_len);
+}
+
+/**
+ * @brief 在描述符表中查找帧对应的描述符
+ * @param frame 日志帧
+ * @param descs 描述符指针数组
+ * @param count 数组元素个数
+ * @return 描述符指针；未找到返回 NULL
+ *
+ * @note 带 STRUCT_LOG_FLAG_FINGERPRINT 的帧按布局指纹匹配，布局不同的描述符不会被选中
+ */
+static inline const StructDescriptor* struct_log_find_desc(const StructLogFrame* frame,
+                                                           const StructDescriptor* const* descs, size_t count) {
+    int by_fingerprint = (frame->flags & STRUCT_LOG_FLAG_FINGERPRINT) != 0;
+    size_t i;
+    
+    for (i = 0; i < count; i++) {
+        u32 id = by_fingerprint ? struct_desc_fingerprint(descs[i]) : struct_desc_id(descs[i]);
+        if (id == frame->desc_id) {
+            return descs[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief 将一帧日志还原为文本（主机端）
+ * @param sink 输出缓冲区
+ * @param frame 日志帧
+ * @param desc 帧对应的描述符（可为 NULL）
+ *
+ * @note 输出格式与 STRUCT_PRINT 相同，Address 显示设备上的原始地址
+ */
+static inline void struct_log_print(StructPrintSink* sink, const StructLogFrame* frame,
+                                    const StructDescriptor* desc) {
+    StructPrintContext ctx;
+    
+    sink_puts(sink, "[t=");
+    sink_put_u32(sink, frame->timestamp);
+    sink_putc(sink, ']');
+    sink_endline(sink);
+    
+    if (desc == NULL) {
+        sink_puts(sink, (frame->flags & STRUCT_LOG_FLAG_FINGERPRINT) ? "Unknown fingerprint 0x"
+                                                                      : "Unknown descriptor ID 0x");
+        sink_put_hex(sink, frame->desc_id, 8);
+        sink_puts(sink, ", ");
+        sink_put_u32(sink, (u32)frame->payload_len);
+        sink_puts(sink, " bytes");
+        sink_endline(sink);
+    } else if (desc->struct_size != frame->payload_len) {
+        sink_puts(sink, "Size mismatch for ");
+        sink_puts(sink, desc->struct_name);
+        sink_puts(sink, ": frame ");
+        sink_put_u32(sink, (u32)frame->payload_len);
+        sink_puts(sink, " bytes, descriptor ");
+        sink_put_u32(sink, (u32)desc->struct_size);
+        sink_puts(sink, " bytes");
+        sink_endline(sink);
+    } else {
+        struct_print_context_init(&ctx, sink);
+        ctx.addr_bias = (uintptr_t)frame->address - (uintptr_t)frame->payload;
+        struct_print_record(&ctx, "", frame->payload, desc);
+    }
+    struct_print_sink_flush(sink);
+}
+
+
+/* ============================================================================
+ *                    描述符注册表（链接段 + O(1) 查找）
+ * ============================================================================ */
+
+/**
+ * @brief 链接段注册支持检测
+ * @note GCC/Clang + ELF（Linux、arm-none-eabi 等）下，STRUCT_DESC_REGISTER 把描述符指针放入
+ *       名为 struct_desc 的段，链接器自动生成 __start_struct_desc / __stop_struct_desc，
+ *       运行时用 struct_desc_section() 遍历，不需要手写描述符列表
+ * @note 其他工具链下 STRUCT_DESC_REGISTER 为空，请用 struct_registry_add() 逐个注册
+ * @note 链接脚本显式列出输出段并使用 --gc-sections 时，需要保留该段，例如：
+ *       .struct_desc : { PROVIDE(__start_struct_desc = .); KEEP(*(struct_desc)) PROVIDE(__stop_struct_desc = .); } > FLASH
+ */
+#if defined(__GNUC__) && defined(__ELF__)
+    #define STRUCT_PRINT_HAS_SECTION_REGISTRY 1
+#else
+    #define STRUCT_PRINT_HAS_SECTION_REGISTRY 0
+#endif
+
+/**
+ * @brief 描述符定义时自动注册到链接段
+ * @note 为 1 时 END_STRUCT_DESC / STRUCT_DESC_SPECIALIZED / STRUCT_PRINT_REFLECT 自动调用 STRUCT_DESC_REGISTER；
+ *       描述符头文件被多个 .c 包含时每个编译单元各注册一份（注册表按名称去重），
+ *       并且未使用的描述符不会再被优化掉。默认 0，建议在一个 .c 中显式注册
+ */
+#ifndef STRUCT_PRINT_AUTO_REGISTER
+#define STRUCT_PRINT_AUTO_REGISTER 0
+#endif
+
+#if STRUCT_PRINT_HAS_SECTION_REGISTRY
+extern const StructDescriptor* const __start_struct_desc[] __attribute__((weak));
+extern const StructDescriptor* const __stop_struct_desc[] __attribute__((weak));
+
+/**
+ * @brief 将描述符注册到 struct_desc 链接段
+ * @param desc_name 描述符变量名（BEGIN_STRUCT_DESC / STRUCT_PRINT_REFLECT 定义）
+ *
+ * @example
+ * END_STRUCT_DESC(SystemStatus, SystemStatus_desc)
+ * STRUCT_DESC_REGISTER(SystemStatus_desc)
+ */
+#define STRUCT_DESC_REGISTER(desc_name) \
+    static const StructDescriptor* const desc_name##_registry_entry_ \
+        __attribute__((used, section("struct_desc"))) = &desc_name;
+#else
+#define STRUCT_DESC_REGISTER(desc_name)
+#endif
+
+#if STRUCT_PRINT_AUTO_REGISTER
+    #define STRUCT_PRINT_AUTO_REGISTER_(desc_name) STRUCT_DESC_REGISTER(desc_name)
+#else
+    #define STRUCT_PRINT_AUTO_REGISTER_(desc_name)
+#endif
+
+/**
+ * @brief 获取 struct_desc 链接段中的全部描述符
+ * @param begin 输出：第一个描述符指针的地址
+ * @return 描述符个数（没有注册任何描述符或工具链不支持时为 0）
+ *
+ * @note 返回的数组可直接传给 struct_schema_export_cbor() 等接受描述符表的函数
+ */
+static inline size_t struct_desc_section(const StructDescriptor* const** begin) {
+#if STRUCT_PRINT_HAS_SECTION_REGISTRY
+    if (__start_struct_desc != NULL && __stop_struct_desc != NULL) {
+        *begin = __start_struct_desc;
+        return (size_t)(__stop_struct_desc - __start_struct_desc);
+    }
+#endif
+    *begin = NULL;
+    return 0;
+}
+
+/**
+ * @brief 描述符注册表：按描述符 ID（结构体名称哈希）散列的开放寻址表
+ * @note 槽数组由调用者提供（不使用动态内存），槽数为 2 的幂，建议不少于类型数的 2 倍；
+ *       按名称和按 ID 查找都是一次哈希加常数次探测，与注册的类型数无关
+ */
+typedef struct {
+    const StructDescriptor** slots;             /**< 槽（NULL 为空）*/
+    u32* ids;                                   /**< 槽中描述符的 ID（探测时不必重新计算哈希）*/
+    size_t mask;                                /**< 槽数 - 1 */
+    size_t count;                               /**< 已注册个数 */
+} StructRegistry;
+
+/**
+ * @brief 定义静态存储的注册表
+ * @param name 注册表变量名
+ * @param capacity 槽数（必须为 2 的幂）
+ *
+ * @example
+ * STRUCT_REGISTRY_DEFINE(g_registry, 256);
+ * struct_registry_add_section(&g_registry);
+ */
+#define STRUCT_REGISTRY_DEFINE(name, capacity) \
+    static const StructDescriptor* name##_slots_[capacity]; \
+    static u32 name##_ids_[capacity]; \
+    static StructRegistry name = { name##_slots_, name##_ids_, (capacity) - 1, 0 }
+
+/**
+ * @brief 初始化注册表
+ * @param reg 注册表
+ * @param slots 槽数组
+ * @param ids ID 数组（与槽数组等长）
+ * @param capacity 数组长度（不是 2 的幂时只使用不超过它的最大 2 的幂）
+ * @return 0 成功，-1 参数错误（数组为 NULL 或 capacity 为 0；此时注册表为空且不能注册）
+ */
+static inline int struct_registry_init(StructRegistry* reg, const StructDescriptor** slots, u32* ids, size_t capacity) {
+    static const StructDescriptor* empty_slot[1];
+    static u32 empty_id[1];
+    size_t n = 1;
+    
+    if (slots == NULL || ids == NULL || capacity == 0) {
+        reg->slots = empty_slot;
+        reg->ids = empty_id;
+        reg->mask = 0;
+        reg->count = 0;
+        return -1;
+    }
+    while (n * 2 <= capacity) n *= 2;
+    memset(slots, 0, n * sizeof(slots[0]));
+    reg->slots = slots;
+    reg->ids = ids;
+    reg->mask = n - 1;
+    reg->count = 0;
+    return 0;
+}
+
+/**
+ * @brief 注册一个描述符
+ * @param reg 注册表
+ * @param desc 结构体描述符
+ * @return 0 成功；1 同名描述符已注册（保留先注册的）；-1 注册表已满；
+ *         -2 ID 冲突：已注册的另一个结构体名称哈希相同（不注册，否则按 ID 查找无法区分）
+ */
+static inline int struct_registry_add(StructRegistry* reg, const StructDescriptor* desc) {
+    u32 id = struct_desc_id(desc);
+    size_t i = id & reg->mask;
+    size_t probes;
+    
+    /* 至少保留一个空槽，保证查找在遇到空槽时结束 */
+    if (reg->count >= reg->mask) return -1;
+    
+    for (probes = 0; probes <= reg->mask; probes++) {
+        if (reg->slots[i] == NULL) {
+            reg->slots[i] = desc;
+            reg->ids[i] = id;
+            reg->count++;
+            return 0;
+        }
+        if (reg->ids[i] == id) {
+            return (strcmp(reg->slots[i]->struct_name, desc->struct_name) == 0) ? 1 : -2;
+        }
+        i = (i + 1) & reg->mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief 注册 struct_desc 链接段中的全部描述符
+ * @param reg 注册表
+ * @return 新注册的个数（重复的不计）
+ */
+static inline size_t struct_registry_add_section(StructRegistry* reg) {
+    const StructDescriptor* const* descs;
+    size_t count = struct_desc_section(&descs);
+    size_t added = 0;
+    size_t i;
+    
+    for (i = 0; i < count; i++) {
+        if (descs[i] != NULL && struct_registry_add(reg, descs[i]) == 0) {
+            added++;
+        }
+    }
+    return added;
+}
+
+/**
+ * @brief 按描述符 ID 查找
+ * @param reg 注册表
+ * @param id 描述符 ID（struct_desc_id，即 STRUCT_LOG 帧头中的 ID）
+ * @return 描述符指针；未找到返回 NULL
+ * @note 注册时拒绝 ID 冲突的描述符，同一 ID 最多对应一个描述符
+ */
+static inline const StructDescriptor* struct_registry_find_id(const StructRegistry* reg, u32 id) {
+    size_t i = id & reg->mask;
+    size_t probes;
+    
+    for (probes = 0; probes <= reg->mask && reg->slots[i] != NULL; probes++) {
+        if (reg->ids[i] == id) return reg->slots[i];
+        i = (i + 1) & reg->mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 按结构体名称查找
+ * @param reg 注册表
+ * @param name 结构体名称（如 "SystemStatus"）
+ * @return 描述符指针；未找到返回 NULL
+ */
+static inline const StructDescriptor* struct_registry_find_name(const StructRegistry* reg, const char* name) {
+    u32 id = struct_name_id(name);
+    size_t i = id & reg->mask;
+    size_t probes;
+    
+    for (probes = 0; probes <= reg->mask && reg->slots[i] != NULL; probes++) {
+        if (reg->ids[i] == id && strcmp(reg->slots[i]->struct_name, name) == 0) return reg->slots[i];
+        i = (i + 1) & reg->mask;
+    }
+    return NULL;
+}
+
+/**
+ * @brief 遍历注册表
+ * @param reg 注册表
+ * @param pos 遍历位置（从 0 开始，由本函数更新）
+ * @return 下一个描述符；遍历结束返回 NULL
+ *
+ * @example
+ * size_t pos = 0;
+ * const StructDescriptor* desc;
+ * while ((desc = struct_registry_next(&g_registry, &pos)) != NULL) { ... }
+ */
+static inline const StructDescriptor* struct_registry_next(const StructRegistry* reg, size_t* pos) {
+    while (*pos <= reg->mask) {
+        const StructDescriptor* desc = reg->slots[(*pos)++];
+        if (desc != NULL) return desc;
+    }
+    return NULL;
+}
+
+
+/* ============================================================================
+ *              捕获模式：无锁单生产者/单消费者环形缓冲区
+ * ============================================================================ */
+
+/**
+ * @brief 环形缓冲区溢出策略
+ */
+#define STRUCT_PRINT_RING_DROP_NEWEST   0   /**< 缓冲区满时丢弃新记录（纯 load/store，无 CAS）*/
+#define STRUCT_PRINT_RING_DROP_OLDEST   1   /**< 缓冲区满时覆盖最旧的记录 */
+
+/**
+ * @brief 环形缓冲区中每条记录的头部
+ */
+typedef struct {
+    const StructDescriptor* desc;               /**< 结构体描述符 */
+    const char* var_name;                       /**< 变量名（字符串常量）*/
+    uintptr_t address;                          /**< 结构体原始地址（打印时显示）*/
+    size_t length;                              /**< 结构体字节数 */
+} StructPrintRingRecord;
+
+/* 记录头按 8 字节对齐，保证负载中的 double 等字段可以原地读取 */
+#define STRUCT_PRINT_RING_RECORD_SIZE \
+    ((sizeof(StructPrintRingRecord) + 7u) & ~(size_t)7u)
+
+/**
+ * @brief 无锁 SPSC 环形缓冲区
+ * @note 生产者（ISR/控制循环）只拷贝结构体原始字节，消费者（低优先级任务/空闲循环）负责格式化
+ * @note 使用固定大小的槽，每个槽存放一条记录（记录头 + 结构体数据）
+ */
+typedef struct {
+    u8* storage;                                /**< 槽存储区（slot_count + 1 个槽，最后一个为消费者暂存区）*/
+    u32 slot_count;                             /**< 槽数量（2 的幂）*/
+    u32 slot_size;                              /**< 每个槽的字节数（8 的倍数）*/
+    u32 policy;                                 /**< 溢出策略 STRUCT_PRINT_RING_xxx */
+    u32 head;                                   /**< 写入计数（生产者修改）*/
+    u32 tail;                                   /**< 读取计数（消费者修改；DROP_OLDEST 时生产者也可推进）*/
+    u32 pushed;                                 /**< 成功写入的记录数 */
+    u32 dropped;                                /**< 因缓冲区满丢弃的记录数 */
+    u32 oversize;                               /**< 因超过槽大小丢弃的记录数 */
+    u32 high_water;                             /**< 最高占用槽数 */
+} StructPrintRing;
+
+/**
+ * @brief 环形缓冲区统计信息
+ */
+typedef struct {
+    u32 pushed;                                 /**< 成功写入的记录数 */
+    u32 dropped;                                /**< 因缓冲区满丢弃的记录数 */
+    u32 oversize;                               /**< 因超过槽大小丢弃的记录数 */
+    u32 high_water;                             /**< 最高占用槽数 */
+    u32 pending;                                /**< 当前待处理的记录数 */
+} StructPrintRingStats;
+
+/**
+ * @brief 静态定义环形缓冲区
+ * @param name 缓冲区变量名
+ * @param slots 槽数量（2 的幂）
+ * @param slot_bytes 每个槽可容纳的结构体字节数
+ * @param policy 溢出策略 STRUCT_PRINT_RING_xxx
+ *
+ * @example
+ * STRUCT_PRINT_RING_DEFINE(g_print_ring, 16, sizeof(SystemStatus), STRUCT_PRINT_RING_DROP_NEWEST);
+ */
+#define STRUCT_PRINT_RING_SLOT_SIZE(slot_bytes) \
+    ((STRUCT_PRINT_RING_RECORD_SIZE + (slot_bytes) + 7u) & ~(size_t)7u)
+
+#define STRUCT_PRINT_RING_DEFINE(name, slots, slot_bytes, policy) \
+    static uint64_t name##_storage[((slots) + 1) * STRUCT_PRINT_RING_SLOT_SIZE(slot_bytes) / 8]; \
+    StructPrintRing name = { \
+        (u8*)name##_storage, \
+        (slots), \
+        (u32)STRUCT_PRINT_RING_SLOT_SIZE(slot_bytes), \
+        (policy), \
+        0, 0, 0, 0, 0, 0 \
+    }
+
+/**
+ * @brief 初始化环形缓冲区
+ * @param ring 缓冲区对象
+ * @param storage 存储区（至少 (slot_count + 1) * slot_size 字节，8 字节对齐）
+ * @param slot_count 槽数量（必须是 2 的幂）
+ * @param slot_size 每个槽的字节数（建议使用 STRUCT_PRINT_RING_SLOT_SIZE 计算）
+ * @param policy 溢出策略 STRUCT_PRINT_RING_xxx
+ * @return 0 成功，-1 参数错误
+ */
+static inline int struct_print_ring_init(StructPrintRing* ring, void* storage, u32 slot_count,
+                                         u32 slot_size, u32 policy) {
+    if (storage == NULL || slot_count == 0 || (slot_count & (slot_count - 1)) != 0 ||
+        slot_size <= STRUCT_PRINT_RING_RECORD_SIZE || (slot_size & 7u) != 0) {
+        return -1;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->storage = (u8*)storage;
+    ring->slot_count = slot_count;
+    ring->slot_size = slot_size;
+    ring->policy = policy;
+    return 0;
+}
+
+/**
+ * @brief 拷贝一条记录到环形缓冲区（生产者，可在中断中调用）
+ * @param ring 缓冲区对象
+ * @param var_name 变量名（必须是常量字符串，只保存指针）
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @return 1 写入成功，0 被丢弃
+ *
+ * @note 只做一次 memcpy，不做任何格式化
+ * @note 仅允许一个生产者；多个 ISR 写同一缓冲区时需自行保证互斥
+ */
+static inline int struct_print_ring_push(StructPrintRing* ring, const char* var_name,
+                                         const void* struct_data, const StructDescriptor* desc) {
+    u32 head = ring->head;
+    u32 tail = STRUCT_PRINT_ATOMIC_LOAD(&ring->tail);
+    u32 used;
+    StructPrintRingRecord* rec;
+    
+    if (struct_data == NULL || desc == NULL) return 0;
+    
+    if (desc->struct_size > ring->slot_size - STRUCT_PRINT_RING_RECORD_SIZE) {
+        ring->oversize++;
+        return 0;
+    }
+    
+    if (head - tail >= ring->slot_count) {
+        if (ring->policy != STRUCT_PRINT_RING_DROP_OLDEST) {
+            ring->dropped++;
+            return 0;
+        }
+        /* 推进 tail 丢弃最旧记录；CAS 失败说明消费者刚好取走了它，同样腾出了空间 */
+        if (STRUCT_PRINT_ATOMIC_CAS(&ring->tail, &tail, tail + 1)) {
+            ring->dropped++;
+        }
+    }
+    
+    rec = (StructPrintRingRecord*)(ring->storage + (size_t)(head & (ring->slot_count - 1)) * ring->slot_size);
+    rec->desc = desc;
+    rec->var_name = var_name;
+    rec->address = (uintptr_t)struct_data;
+    rec->length = desc->struct_size;
+    memcpy((u8*)rec + STRUCT_PRINT_RING_RECORD_SIZE, struct_data, desc->struct_size);
+    
+    STRUCT_PRINT_ATOMIC_STORE(&ring->head, head + 1);
+    ring->pushed++;
+    
+    used = head + 1 - STRUCT_PRINT_ATOMIC_LOAD(&ring->tail);
+    if (used > ring->high_water) {
+        ring->high_water = used;
+    }
+    return 1;
+}
+
+/**
+ * @brief 取出最旧的一条记录（消费者）
+ * @param ring 缓冲区对象
+ * @return 记录指针（在下一次 struct_print_ring_peek/release 之前有效）；缓冲区为空时返回 NULL
+ *
+ * @note DROP_NEWEST 策略下直接返回槽内数据（零拷贝），处理完后需调用 struct_print_ring_release
+ * @note DROP_OLDEST 策略下记录可能被生产者覆盖，因此先拷贝到暂存槽并立即提交
+ */
+static inline const StructPrintRingRecord* struct_print_ring_peek(StructPrintRing* ring) {
+    for (;;) {
+        u32 tail = STRUCT_PRINT_ATOMIC_LOAD(&ring->tail);
+        u32 head = STRUCT_PRINT_ATOMIC_LOAD(&ring->head);
+        const u8* slot;
+        u8* scratch;
+        
+        if (tail == head) return NULL;
+        
+        slot = ring->storage + (size_t)(tail & (ring->slot_count - 1)) * ring->slot_size;
+        if (ring->policy != STRUCT_PRINT_RING_DROP_OLDEST) {
+            return (const StructPrintRingRecord*)slot;
+        }
+        
+        scratch = ring->storage + (size_t)ring->slot_count * ring->slot_size;
+        memcpy(scratch, slot, ring->slot_size);
+        if (STRUCT_PRINT_ATOMIC_CAS(&ring->tail, &tail, tail + 1)) {
+            return (const StructPrintRingRecord*)scratch;
+        }
+        /* 拷贝期间该记录被生产者丢弃，数据可能不完整，重试 */
+    }
+}
+
+/**
+ * @brief 释放 struct_print_ring_peek 返回的记录（消费者）
+ */
+static inline void struct_print_ring_release(StructPrintRing* ring) {
+    if (ring->policy != STRUCT_PRINT_RING_DROP_OLDEST) {
+        STRUCT_PRINT_ATOMIC_STORE(&ring->tail, ring->tail + 1);
+    }
+}
+
+/**
+ * @brief 格式化并输出缓冲区中的记录（消费者，在低优先级任务或空闲循环中调用）
+ * @param ring 缓冲区对象
+ * @param sink 输出缓冲区
+ * @param max_records 最多处理的记录数（0 表示全部）
+ * @return 实际处理的记录数
+ *
+ * @note 输出与同步调用 STRUCT_PRINT 完全相同（Address 显示捕获时的原始地址）
+ */
+static inline size_t struct_print_ring_drain(StructPrintRing* ring, StructPrintSink* sink, size_t max_records) {
+    size_t count = 0;
+    const StructPrintRingRecord* rec;
+    StructPrintContext ctx;
+    
+    struct_print_context_init(&ctx, sink);
+    
+    while ((max_records == 0 || count < max_records) && (rec = struct_print_ring_peek(ring)) != NULL) {
+        const u8* data = (const u8*)rec + STRUCT_PRINT_RING_RECORD_SIZE;
+        
+        ctx.addr_bias = rec->address - (uintptr_t)data;
+        struct_print_record(&ctx, rec->var_name, data, rec->desc);
+        struct_print_ring_release(ring);
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 读取环形缓冲区统计信息
+ * @param ring 缓冲区对象
+ * @param stats 统计信息输出
+ */
+static inline void struct_print_ring_get_stats(const StructPrintRing* ring, StructPrintRingStats* stats) {
+    stats->pushed = ring->pushed;
+    stats->dropped = ring->dropped;
+    stats->oversize = ring->oversize;
+    stats->high_water = ring->high_water;
+    stats->pending = STRUCT_PRINT_ATOMIC_LOAD(&ring->head) - STRUCT_PRINT_ATOMIC_LOAD(&ring->tail);
+}
+
+
+/* ============================================================================
+ *              异步格式化工作池（多核，POSIX 线程）
+ * ============================================================================ */
+
+/**
+ * @brief 启用异步工作池（需要 pthread，编译时加 -pthread）
+ * @note 面向 Linux 网关等多核主机：调用者只拷贝结构体字节并入队，多个工作线程并行格式化，
+ *       输出阶段按提交顺序重新排列，日志顺序与提交顺序一致
+ */
+#ifndef STRUCT_PRINT_POOL
+#define STRUCT_PRINT_POOL               0
+#endif
+
+#if STRUCT_PRINT_POOL
+
+#include <pthread.h>
+
+/* 最大工作线程数 */
+#ifndef STRUCT_PRINT_POOL_MAX_WORKERS
+#define STRUCT_PRINT_POOL_MAX_WORKERS   16
+#endif
+
+/**
+ * @brief 一条待格式化的记录（槽）
+ */
+typedef struct {
+    const StructDescriptor* desc;               /**< 结构体描述符 */
+    const char* var_name;                       /**< 变量名（字符串常量）*/
+    uintptr_t address;                          /**< 结构体原始地址（打印时显示）*/
+    u32 seq;                                    /**< 提交序号 */
+    int done;                                   /**< 已格式化，等待按顺序输出 */
+    size_t text_len;                            /**< 格式化结果长度 */
+} StructPrintPoolSlot;
+
+/**
+ * @brief 工作线程的任务队列（保存槽序号；空闲线程从其他队列窃取）
+ */
+typedef struct {
+    pthread_mutex_t lock;                       /**< 队列锁 */
+    u32* items;                                 /**< 序号数组（槽数个）*/
+    u32 head;                                   /**< 取出计数 */
+    u32 tail;                                   /**< 放入计数 */
+} StructPrintPoolQueue;
+
+struct StructPrintPool_t;
+
+/**
+ * @brief 工作线程
+ */
+typedef struct {
+    struct StructPrintPool_t* pool;             /**< 所属工作池 */
+    u32 index;                                  /**< 线程序号 */
+    u32 done;                                   /**< 格式化的记录数 */
+    u32 steals;                                 /**< 从其他线程队列窃取的记录数 */
+    pthread_t thread;                           /**< 线程句柄 */
+} StructPrintPoolWorker;
+
+/**
+ * @brief 工作池运行状态（由 struct_print_pool_start 初始化）
+ */
+typedef struct {
+    pthread_mutex_t lock;                       /**< 保护下面的计数 */
+    pthread_cond_t work_cond;                   /**< 有新任务 */
+    pthread_cond_t space_cond;                  /**< 有记录输出完成（槽空出）*/
+    pthread_mutex_t out_lock;                   /**< 输出阶段锁（保证按序、串行调用输出回调）*/
+    u32 submitted;                              /**< 已提交的记录数 */
+    u32 queued;                                 /**< 已提交未被工作线程取走的记录数（原子读写）*/
+    u32 idle;                                   /**< 正在等待任务的工作线程数 */
+    u32 waiters;                                /**< 等待槽位的提交线程和 flush 调用数 */
+    u32 output;                                 /**< 已输出的记录数（lock 保护，供提交和 flush 等待）*/
+    u32 out_next;                               /**< 输出阶段的下一个序号（out_lock 保护写入，原子读写）*/
+    u32 oversize;                               /**< 因超过槽数据区大小被拒绝的记录数 */
+    u32 truncated;                              /**< 格式化结果超过槽文本区被截断的记录数 */
+    int stop;                                   /**< 请求退出 */
+    u32 worker_count;                           /**< 工作线程数 */
+    StructPrintFlushFunc out_fn;                /**< 输出回调（每条记录调用一次）*/
+    void* out_ctx;                              /**< 输出回调上下文 */
+    StructPrintPoolQueue queues[STRUCT_PRINT_POOL_MAX_WORKERS];
+    StructPrintPoolWorker workers[STRUCT_PRINT_POOL_MAX_WORKERS];
+} StructPrintPoolState;
+
+/**
+ * @brief 异步工作池
+ * @note 使用 STRUCT_PRINT_POOL_DEFINE 静态定义，存储区在编译期确定
+ */
+typedef struct StructPrintPool_t {
+    StructPrintPoolSlot* slots;                 /**< 槽数组 */
+    u32* queue_items;                           /**< 各线程队列的序号数组（STRUCT_PRINT_POOL_MAX_WORKERS × 槽数）*/
+    u8* data;                                   /**< 结构体数据区（每槽 data_size 字节）*/
+    char* text;                                 /**< 格式化结果区（每槽 text_size 字节）*/
+    u32 slot_count;                             /**< 槽数（2 的幂，即最多在途的记录数）*/
+    size_t data_size;                           /**< 每槽数据区字节数（8 的倍数）*/
+    size_t text_size;                           /**< 每槽文本区字节数（含结尾 '\0'）*/
+    StructPrintPoolState* state;                /**< 运行状态 */
+} StructPrintPool;
+
+/**
+ * @brief 工作池统计信息
+ */
+typedef struct {
+    u32 submitted;                              /**< 已提交的记录数 */
+    u32 output;                                 /**< 已输出的记录数 */
+    u32 oversize;                               /**< 被拒绝的记录数（结构体超过槽数据区）*/
+    u32 truncated;                              /**< 被截断的记录数（输出超过槽文本区）*/
+    u32 steals;                                 /**< 工作线程之间窃取的记录数 */
+} StructPrintPoolStats;
+
+/**
+ * @brief 静态定义工作池
+ * @param name 工作池变量名
+ * @param slots 槽数（2 的幂）：最多在途的记录数，满时 struct_print_pool_submit 等待
+ * @param data_bytes 每条记录可容纳的结构体字节数
+ * @param text_bytes 每条记录格式化结果的最大字节数（超过部分截断）
+ *
+ * @example
+ * STRUCT_PRINT_POOL_DEFINE(g_print_pool, 256, sizeof(SystemStatus), 2048);
+ */
+#define STRUCT_PRINT_POOL_DEFINE(name, slots, data_bytes, text_bytes) \
+    static StructPrintPoolSlot name##_slots_[slots]; \
+    static u32 name##_items_[STRUCT_PRINT_POOL_MAX_WORKERS * (slots)]; \
+    static uint64_t name##_data_[(slots) * (((data_bytes) + 7u) / 8u)]; \
+    static char name##_text_[(slots) * (text_bytes)]; \
+    static StructPrintPoolState name##_state_; \
+    static StructPrintPool name = { \
+        name##_slots_, \
+        name##_items_, \
+        (u8*)name##_data_, \
+        name##_text_, \
+        (slots), \
+        (((data_bytes) + 7u) / 8u) * 8u, \
+        (text_bytes), \
+        &name##_state_ \
+    }
+
+/**
+ * @brief 取出一个任务：先取自己的队列，为空时依次从其他线程的队列窃取
+ * @return 1 取到，0 所有队列为空
+ */
+static inline int pool_take(StructPrintPool* pool, StructPrintPoolWorker* worker, u32* seq) {
+    StructPrintPoolState* st = pool->state;
+    u32 i;
+    
+    for (i = 0; i < st->worker_count; i++) {
+        StructPrintPoolQueue* q = &st->queues[(worker->index + i) % st->worker_count];
+        int found = 0;
+        
+        pthread_mutex_lock(&q->lock);
+        if (q->head != q->tail) {
+            *seq = q->items[q->head++ & (pool->slot_count - 1)];
+            found = 1;
+        }
+        pthread_mutex_unlock(&q->lock);
+        if (found) {
+            if (i > 0) STRUCT_PRINT_ATOMIC_STORE(&worker->steals, worker->steals + 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 待取走的记录数加 delta（取走时为 (u32)-1，工作线程不需要加 st->lock）
+ */
+static inline void pool_queued_add(StructPrintPoolState* st, u32 delta) {
+    u32 queued = STRUCT_PRINT_ATOMIC_LOAD(&st->queued);
+    while (!STRUCT_PRINT_ATOMIC_CAS(&st->queued, &queued, queued + delta)) {
+    }
+}
+
+/*
+ * 工作线程的格式化 sink 直接写入槽的文本区：第一次刷新就是记录的全部文本（或文本区写满），
+ * 之后改写到 scratch，只用来判断是否截断
+ */
+typedef struct {
+    StructPrintSink* sink;
+    size_t* len;
+    int truncated;
+    char scratch[64];
+} StructPrintPoolText;
+
+static inline void pool_text_flush(void* ctx, const char* data, size_t len) {
+    StructPrintPoolText* t = (StructPrintPoolText*)ctx;
+    
+    if (data != t->scratch) {
+        *t->len = len;
+        t->sink->buf = t->scratch;
+        t->sink->capacity = sizeof(t->scratch) - 1;
+    } else {
+        t->truncated = 1;
+    }
+}
+
+/**
+ * @brief 输出阶段的下一条记录是否已完成格式化
+ */
+static inline int pool_output_ready(StructPrintPool* pool) {
+    u32 next = STRUCT_PRINT_ATOMIC_LOAD(&pool->state->out_next);
+    StructPrintPoolSlot* slot = &pool->slots[next & (pool->slot_count - 1)];
+    
+    return STRUCT_PRINT_ATOMIC_LOAD(&slot->done) && slot->seq == next;
+}
+
+/**
+ * @brief 输出阶段：把从 output 开始已完成的连续记录按序交给输出回调
+ * @note 由完成格式化的工作线程顺带执行，不需要单独的输出线程；
+ *       其他线程正在输出时不等待 out_lock（输出回调可能很慢），由持锁线程解锁后重新检查，
+ *       输出本线程刚完成的记录（pthread 互斥锁操作保证内存同步，done 的写入和解锁后的检查至少一方可见）
+ */
+static inline void pool_output(StructPrintPool* pool) {
+    StructPrintPoolState* st = pool->state;
+    
+    while (pool_output_ready(pool)) {
+        u32 next, count = 0;
+        
+        if (pthread_mutex_trylock(&st->out_lock) != 0) return;
+        next = st->out_next;
+        for (;;) {
+            size_t index = next & (pool->slot_count - 1);
+            StructPrintPoolSlot* slot = &pool->slots[index];
+            char* text = pool->text + index * pool->text_size;
+            
+            if (!STRUCT_PRINT_ATOMIC_LOAD(&slot->done) || slot->seq != next) break;
+            text[slot->text_len] = '\0';
+            if (st->out_fn != NULL && slot->text_len > 0) {
+                st->out_fn(st->out_ctx, text, slot->text_len);
+            }
+            STRUCT_PRINT_ATOMIC_STORE(&slot->done, 0);
+            next++;
+            count++;
+        }
+        STRUCT_PRINT_ATOMIC_STORE(&st->out_next, next);
+        if (count > 0) {
+            pthread_mutex_lock(&st->lock);
+            st->output = next;
+            /* 等待者只在在途记录降到一半以下时唤醒，避免每条记录都切换一次线程 */
+            if (st->waiters > 0 && st->submitted - st->output <= pool->slot_count / 2) {
+                pthread_cond_broadcast(&st->space_cond);
+            }
+            pthread_mutex_unlock(&st->lock);
+        }
+        pthread_mutex_unlock(&st->out_lock);
+    }
+}
+
+/**
+ * @brief 格式化一条记录（输出与同步调用 STRUCT_PRINT 完全相同，Address 显示提交时的原始地址）
+ */
+static inline void pool_format(StructPrintPool* pool, u32 seq) {
+    size_t index = seq & (pool->slot_count - 1);
+    StructPrintPoolSlot* slot = &pool->slots[index];
+    const u8* data = pool->data + index * pool->data_size;
+    StructPrintPoolText text;
+    StructPrintSink sink;
+    StructPrintContext ctx;
+    
+    slot->text_len = 0;
+    text.sink = &sink;
+    text.len = &slot->text_len;
+    text.truncated = 0;
+    struct_print_sink_init(&sink, pool->text + index * pool->text_size, pool->text_size,
+                           pool_text_flush, &text, STRUCT_PRINT_SINK_FLUSH_FULL);
+    struct_print_context_init(&ctx, &sink);
+    ctx.addr_bias = slot->address - (uintptr_t)data;
+    struct_print_record(&ctx, slot->var_name, data, slot->desc);
+    
+    if (text.truncated) {
+        pthread_mutex_lock(&pool->state->lock);
+        pool->state->truncated++;
+        pthread_mutex_unlock(&pool->state->lock);
+    }
+    STRUCT_PRINT_ATOMIC_STORE(&slot->done, 1);
+}
+
+static inline void* pool_worker_main(void* arg) {
+    StructPrintPoolWorker* worker = (StructPrintPoolWorker*)arg;
+    StructPrintPool* pool = worker->pool;
+    StructPrintPoolState* st = pool->state;
+    
+    for (;;) {
+        u32 seq;
+        
+        if (pool_take(pool, worker, &seq)) {
+            pool_queued_add(st, (u32)-1);
+            pool_format(pool, seq);
+            STRUCT_PRINT_ATOMIC_STORE(&worker->done, worker->done + 1);
+            pool_output(pool);
+            continue;
+        }
+        
+        /* 队列为空：等待新任务（queued 在入队之前增加，可能短暂为正而队列为空，此时重试）*/
+        pthread_mutex_lock(&st->lock);
+        while (STRUCT_PRINT_ATOMIC_LOAD(&st->queued) == 0 && !st->stop) {
+            st->idle++;
+            pthread_cond_wait(&st->work_cond, &st->lock);
+            st->idle--;
+        }
+        if (STRUCT_PRINT_ATOMIC_LOAD(&st->queued) == 0 && st->stop) {
+            pthread_mutex_unlock(&st->lock);
+            break;
+        }
+        pthread_mutex_unlock(&st->lock);
+    }
+    return NULL;
+}
+
+/**
+ * @brief 启动工作池
+ * @param pool 工作池（STRUCT_PRINT_POOL_DEFINE 定义）
+ * @param workers 工作线程数（1 ~ STRUCT_PRINT_POOL_MAX_WORKERS）
+ * @param out_fn 输出回调：每条记录按提交顺序调用一次，调用是串行的
+ * @param out_ctx 输出回调上下文
+ * @return 0 成功，-1 参数错误或创建线程失败
+ */
+static inline int struct_print_pool_start(StructPrintPool* pool, u32 workers,
+                                          StructPrintFlushFunc out_fn, void* out_ctx) {
+    StructPrintPoolState* st = pool->state;
+    u32 i;
+    
+    if (workers == 0 || workers > STRUCT_PRINT_POOL_MAX_WORKERS ||
+        pool->slot_count == 0 || (pool->slot_count & (pool->slot_count - 1)) != 0) {
+        return -1;
+    }
+    memset(st, 0, sizeof(*st));
+    memset(pool->slots, 0, pool->slot_count * sizeof(StructPrintPoolSlot));
+    pthread_mutex_init(&st->lock, NULL);
+    pthread_mutex_init(&st->out_lock, NULL);
+    pthread_cond_init(&st->work_cond, NULL);
+    pthread_cond_init(&st->space_cond, NULL);
+    st->out_fn = out_fn;
+    st->out_ctx = out_ctx;
+    
+    for (i = 0; i < workers; i++) {
+        pthread_mutex_init(&st->queues[i].lock, NULL);
+        st->queues[i].items = pool->queue_items + (size_t)i * pool->slot_count;
+        st->workers[i].pool = pool;
+        st->workers[i].index = i;
+    }
+    st->worker_count = workers;
+    for (i = 0; i < workers; i++) {
+        if (pthread_create(&st->workers[i].thread, NULL, pool_worker_main, &st->workers[i]) != 0) {
+            /* 已创建的线程在 stop 中退出 */
+            pthread_mutex_lock(&st->lock);
+            st->stop = 1;
+            pthread_cond_broadcast(&st->work_cond);
+            pthread_mutex_unlock(&st->lock);
+            while (i > 0) pthread_join(st->workers[--i].thread, NULL);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 提交一条记录（拷贝结构体数据后立即返回）
+ * @param pool 工作池
+ * @param var_name 变量名（字符串常量，输出时才使用）
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @return 0 成功，-1 参数错误或结构体超过槽数据区
+ *
+ * @note 在途记录达到槽数时等待输出阶段空出一半槽位（背压）
+ * @note 可以从多个线程提交；同一线程提交的记录按提交顺序输出
+ */
+static inline int struct_print_pool_submit(StructPrintPool* pool, const char* var_name,
+                                           const void* struct_data, const StructDescriptor* desc) {
+    StructPrintPoolState* st = pool->state;
+    StructPrintPoolSlot* slot;
+    StructPrintPoolQueue* q;
+    size_t index;
+    u32 seq;
+    int wake;
+    
+    if (struct_data == NULL || desc == NULL) return -1;
+    
+    pthread_mutex_lock(&st->lock);
+    if (desc->struct_size > pool->data_size) {
+        st->oversize++;
+        pthread_mutex_unlock(&st->lock);
+        return -1;
+    }
+    if (st->submitted - st->output >= pool->slot_count) {
+        st->waiters++;
+        while (st->submitted - st->output > pool->slot_count / 2) {
+            pthread_cond_wait(&st->space_cond, &st->lock);
+        }
+        st->waiters--;
+    }
+    seq = st->submitted++;
+    pool_queued_add(st, 1u);    /* 在 st->lock 内增加：等待任务的线程在同一把锁内检查 queued */
+    wake = (st->idle > 0);      /* queued 已增加，此后不会再有线程进入等待 */
+    pthread_mutex_unlock(&st->lock);
+    
+    index = seq & (pool->slot_count - 1);
+    slot = &pool->slots[index];
+    slot->desc = desc;
+    slot->var_name = var_name;
+    slot->address = (uintptr_t)struct_data;
+    slot->seq = seq;
+    memcpy(pool->data + index * pool->data_size, struct_data, desc->struct_size);
+    
+    /* 轮流放入各线程的队列，空闲线程会从其他队列窃取 */
+    q = &st->queues[seq % st->worker_count];
+    pthread_mutex_lock(&q->lock);
+    q->items[q->tail++ & (pool->slot_count - 1)] = seq;
+    pthread_mutex_unlock(&q->lock);
+    
+    if (wake) {
+        pthread_cond_signal(&st->work_cond);
+    }
+    return 0;
+}
+
+/**
+ * @brief 等待已提交的记录全部输出
+ */
+static inline void struct_print_pool_flush(StructPrintPool* pool) {
+    StructPrintPoolState* st = pool->state;
+    
+    pthread_mutex_lock(&st->lock);
+    st->waiters++;
+    while (st->output != st->submitted) {
+        pthread_cond_wait(&st->space_cond, &st->lock);
+    }
+    st->waiters--;
+    pthread_mutex_unlock(&st->lock);
+}
+
+/**
+ * @brief 输出剩余记录后停止全部工作线程
+ */
+static inline void struct_print_pool_stop(StructPrintPool* pool) {
+    StructPrintPoolState* st = pool->state;
+    u32 i;
+    
+    struct_print_pool_flush(pool);
+    pthread_mutex_lock(&st->lock);
+    st->stop = 1;
+    pthread_cond_broadcast(&st->work_cond);
+    pthread_mutex_unlock(&st->lock);
+    
+    /* 先等全部线程退出：退出前的线程仍可能窃取其他队列，加锁 queues[j].lock */
+    for (i = 0; i < st->worker_count; i++) {
+        pthread_join(st->workers[i].thread, NULL);
+    }
+    for (i = 0; i < st->worker_count; i++) {
+        pthread_mutex_destroy(&st->queues[i].lock);
+    }
+    pthread_cond_destroy(&st->space_cond);
+    pthread_cond_destroy(&st->work_cond);
+    pthread_mutex_destroy(&st->out_lock);
+    pthread_mutex_destroy(&st->lock);
+    st->worker_count = 0;
+}
+
+/**
+ * @brief 读取工作池统计信息
+ */
+static inline void struct_print_pool_get_stats(StructPrintPool* pool, StructPrintPoolStats* stats) {
+    StructPrintPoolState* st = pool->state;
+    u32 i;
+    
+    pthread_mutex_lock(&st->lock);
+    stats->submitted = st->submitted;
+    stats->output = st->output;
+    stats->oversize = st->oversize;
+    stats->truncated = st->truncated;
+    pthread_mutex_unlock(&st->lock);
+    stats->steals = 0;
+    for (i = 0; i < st->worker_count; i++) {
+        stats->steals += STRUCT_PRINT_ATOMIC_LOAD(&st->workers[i].steals);
+    }
+}
+
+#endif /* STRUCT_PRINT_POOL */
+
+
+/* ============================================================================
+ *                    结构体差异打印（STRUCT_PRINT_DIFF）
+ * ============================================================================ */
+
+/**
+ * @brief 差异比较状态
+ */
+typedef struct {
+    StructPrintSink* sink;                      /**< 输出缓冲区 */
+    const char* var_name;                       /**< 变量名 */
+    const StructDescriptor* root;               /**< 顶层描述符 */
+    size_t changes;                             /**< 已发现的变化字段数 */
+    StructPrintPath path;                       /**< 当前字段路径 */
+} StructDiffState;
+
+/**
+ * @brief 输出一行变化记录的前缀：[+0xOFFS] path
+ */
+static inline void diff_emit_prefix(StructDiffState* st, size_t offset) {
+    StructPrintSink* sink = st->sink;
+    
+    if (st->changes == 0) {
+        sink_puts(sink, "Diff: ");
+        if (st->var_name != NULL && st->var_name[0] != '\0') {
+            sink_puts(sink, st->var_name);
+            sink_putc(sink, ' ');
+        }
+        sink_putc(sink, '[');
+        sink_puts(sink, st->root->struct_name);
+        sink_putc(sink, ']');
+        sink_endline(sink);
+    }
+    st->changes++;
+    
+    sink_puts(sink, "  [+0x");
+    sink_put_hex(sink, (u32)offset, 4);
+    sink_puts(sink, "] ");
+    sink_write(sink, st->path.buf, st->path.len);
+}
+
+/**
+ * @brief 递归比较两个结构体实例（只对不同的字节区间深入）
+ * @param st 比较状态
+ * @param old_base 旧实例基地址
+ * @param new_base 新实例基地址
+ * @param desc 结构体描述符
+ * @param base_offset 当前结构体相对顶层结构体的偏移
+ */
+static void struct_diff_internal(StructDiffState* st, const u8* old_base, const u8* new_base,
+                                 const StructDescriptor* desc, size_t base_offset) {
+    StructPrintSink* sink = st->sink;
+    size_t i;
+    
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        const u8* old_addr = old_base + field->offset;
+        const u8* new_addr = new_base + field->offset;
+        size_t count = (field->array_count > 0) ? field->array_count : 1;
+        size_t saved;
+        
+        /* 字段区间完全相同：直接跳过（libc memcmp 按字/SIMD 比较）*/
+        if (memcmp(old_addr, new_addr, field->size * count) == 0) {
+            continue;
+        }
+        
+        saved = struct_path_push(&st->path, field->name, 1);
+        
+        if (field->type == FIELD_TYPE_STRUCT && field->nested_desc != NULL) {
+            /* 结构体数组：只深入变化的元素，路径为 name[j].field */
+            size_t j;
+            for (j = 0; j < count; j++) {
+                size_t elem_off = j * field->size;
+                size_t elem_saved;
+                if (memcmp(old_addr + elem_off, new_addr + elem_off, field->size) == 0) {
+                    continue;
+                }
+                elem_saved = (field->array_count > 0) ? struct_path_push_index(&st->path, j) : st->path.len;
+                struct_diff_internal(st, old_addr + elem_off, new_addr + elem_off, field->nested_desc,
+                                     base_offset + field->offset + elem_off);
+                struct_path_pop(&st->path, elem_saved);
+            }
+        } else if (field_is_string(field, old_addr) || field_is_string(field, new_addr)) {
+            diff_emit_prefix(st, base_offset + field->offset);
+            sink_puts(sink, ": ");
+            print_quoted_string(sink, old_addr, field->array_count);
+            sink_puts(sink, " -> ");
+            print_quoted_string(sink, new_addr, field->array_count);
+            sink_endline(sink);
+        } else if (field->array_count > 0 && field->type != FIELD_TYPE_STRUCT) {
+            /* 数值数组：逐元素比较 */
+            size_t j;
+            for (j = 0; j < field->array_count; j++) {
+                size_t elem_off = j * field->size;
+                if (memcmp(old_addr + elem_off, new_addr + elem_off, field->size) == 0) {
+                    continue;
+                }
+                diff_emit_prefix(st, base_offset + field->offset + elem_off);
+                sink_putc(sink, '[');
+                sink_put_u32(sink, (u32)j);
+                sink_puts(sink, "]: ");
+                print_scalar(sink, field->type, old_addr + elem_off);
+                sink_puts(sink, " -> ");
+                print_scalar(sink, field->type, new_addr + elem_off);
+                sink_endline(sink);
+            }
+        } else {
+            diff_emit_prefix(st, base_offset + field->offset);
+            sink_puts(sink, ": ");
+            if (print_scalar(sink, field->type, old_addr)) {
+                sink_puts(sink, " -> ");
+                print_scalar(sink, field->type, new_addr);
+            } else {
+                sink_puts(sink, "<changed>");
+            }
+            sink_endline(sink);
+        }
+        
+        struct_path_pop(&st->path, saved);
+    }
+}
+
+/**
+ * @brief 打印两个结构体实例之间变化的字段
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param old_data 旧实例
+ * @param new_data 新实例
+ * @param desc 结构体描述符（两个实例必须是同一类型）
+ * @return 变化的字段数（0 表示完全相同，此时不输出任何内容）
+ *
+ * @note 先整体比较，只有不同时才逐字段深入；未变化时开销接近一次 memcmp
+ */
+static inline size_t struct_print_diff_to(StructPrintSink* sink, const char* var_name,
+                                          const void* old_data, const void* new_data,
+                                          const StructDescriptor* desc) {
+    StructDiffState st;
+    
+    if (old_data == NULL || new_data == NULL || desc == NULL) return 0;
+    if (memcmp(old_data, new_data, desc->struct_size) == 0) return 0;
+    
+    st.sink = sink;
+    st.var_name = var_name;
+    st.root = desc;
+    st.changes = 0;
+    struct_path_reset(&st.path);
+    
+    struct_diff_internal(&st, (const u8*)old_data, (const u8*)new_data, desc, 0);
+    struct_print_sink_flush(sink);
+    return st.changes;
+}
+
+/**
+ * @brief 打印两个结构体实例之间变化的字段（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_DIFF 宏
+ */
+static inline size_t struct_print_diff(const char* var_name, const void* old_data,
+                                       const void* new_data, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    size_t result;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    result = struct_print_diff_to(&sink, var_name, old_data, new_data, desc);
+    struct_print_out_end(&sink, &locked);
+    return result;
+}
+
+
+/* ============================================================================
+ *                    变化监视（STRUCT_WATCH）
+ * ============================================================================ */
+
+/**
+ * @brief 配置限速用的毫秒时间函数
+ * @note 未配置时时间恒为 0，限速窗口不会前进（每个监视点最多打印 STRUCT_WATCH_MAX_RATE 次）
+ *
+ * @example
+ * #define STRUCT_WATCH_TIME_MS() HAL_GetTick()
+ */
+#ifndef STRUCT_WATCH_TIME_MS
+#define STRUCT_WATCH_TIME_MS() 0u
+#endif
+
+/* STRUCT_WATCH 宏每秒最多打印次数（0 表示不限速）*/
+#ifndef STRUCT_WATCH_MAX_RATE
+#define STRUCT_WATCH_MAX_RATE           0
+#endif
+
+/* 有影子副本时只打印变化的字段（0 则每次打印完整结构体）*/
+#ifndef STRUCT_WATCH_SHOW_DIFF
+#define STRUCT_WATCH_SHOW_DIFF          1
+#endif
+
+/**
+ * @brief 监视点状态
+ * @note 使用 STRUCT_WATCH_INIT 静态初始化，或清零后设置 shadow/max_per_sec
+ */
+typedef struct {
+    void* shadow;                   /**< 影子副本（NULL 表示只比较哈希）*/
+    size_t shadow_size;             /**< 影子副本大小 */
+    u32 hash;                       /**< 上次打印时的内容哈希 */
+    u32 window_start;               /**< 当前限速窗口起始时间（ms）*/
+    u16 max_per_sec;                /**< 每秒最多打印次数（0 不限速）*/
+    u16 window_count;               /**< 当前窗口内已打印次数 */
+    u8 valid;                       /**< 是否已有基准 */
+    u32 prints;                     /**< 打印次数 */
+    u32 suppressed;                 /**< 因限速跳过的次数 */
+} StructWatch;
+
+/**
+ * @brief 监视点静态初始化
+ * @param shadow 影子副本缓冲区（可为 NULL）
+ * @param size 影子副本大小
+ * @param rate 每秒最多打印次数（0 不限速）
+ */
+#define STRUCT_WATCH_INIT(shadow, size, rate) \
+    { (shadow), (size), 0, 0, (u16)(rate), 0, 0, 0, 0 }
+
+/**
+ * @brief 计算结构体内容哈希（按 4 字节一组处理）
+ * @param data 数据指针
+ * @param len 数据长度（struct_size）
+ */
+static inline u32 struct_watch_hash(const void* data, size_t len) {
+    const u8* p = (const u8*)data;
+    u32 hash = 2166136261u ^ (u32)len;
+    
+    while (len >= 4) {
+        u32 word;
+        memcpy(&word, p, 4);
+        hash = (hash ^ word) * 16777619u;
+        hash ^= hash >> 15;
+        p += 4;
+        len -= 4;
+    }
+    while (len > 0) {
+        hash = (hash ^ *p++) * 16777619u;
+        len--;
+    }
+    return hash;
+}
+
+/**
+ * @brief 检查结构体是否变化，变化时输出
+ * @param watch 监视点状态
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @return 1 已输出，0 未变化，-1 有变化但被限速跳过
+ *
+ * @note 首次调用打印完整结构体；之后有影子副本时只打印变化的字段
+ * @note 被限速跳过时不更新基准，窗口恢复后仍会输出最新内容
+ * @note 没有影子副本时只依赖 32 位哈希，极小概率漏报
+ */
+static inline int struct_watch_to(StructWatch* watch, StructPrintSink* sink, const char* var_name,
+                                  const void* struct_data, const StructDescriptor* desc) {
+    int has_shadow;
+    u32 hash;
+    
+    if (watch == NULL || struct_data == NULL || desc == NULL) return 0;
+    
+    hash = struct_watch_hash(struct_data, desc->struct_size);
+    if (watch->valid && hash == watch->hash) return 0;
+    
+    if (watch->max_per_sec > 0) {
+        u32 now = (u32)STRUCT_WATCH_TIME_MS();
+        if (!watch->valid || (u32)(now - watch->window_start) >= 1000u) {
+            watch->window_start = now;
+            watch->window_count = 0;
+        }
+        if (watch->window_count >= watch->max_per_sec) {
+            watch->suppressed++;
+            return -1;
+        }
+        watch->window_count++;
+    }
+    
+    has_shadow = (watch->shadow != NULL && watch->shadow_size >= desc->struct_size);
+    if (STRUCT_WATCH_SHOW_DIFF && watch->valid && has_shadow) {
+        struct_print_diff_to(sink, var_name, watch->shadow, struct_data, desc);
+    } else {
+        struct_print_to(sink, var_name, struct_data, desc);
+    }
+    
+    if (has_shadow) {
+        memcpy(watch->shadow, struct_data, desc->struct_size);
+    }
+    watch->hash = hash;
+    watch->valid = 1;
+    watch->prints++;
+    return 1;
+}
+
+/**
+ * @brief 检查结构体是否变化，变化时输出（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_WATCH 宏
+ */
+static inline int struct_watch(StructWatch* watch, const char* var_name,
+                               const void* struct_data, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    int result;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    result = struct_watch_to(watch, &sink, var_name, struct_data, desc);
+    struct_print_out_end(&sink, &locked);
+    return result;
+}
+
+/* ============================================================================
+ *                    表格打印（STRUCT_PRINT_TABLE）
+ * ============================================================================ */
+
+/* 表格中字符串列最多显示的字符数（超出部分以 ... 结尾，不小于 4）*/
+#ifndef STRUCT_PRINT_TABLE_STRING_MAX
+#define STRUCT_PRINT_TABLE_STRING_MAX   16
+#endif
+
+/* 表格中数值数组列最多显示的元素个数 */
+#ifndef STRUCT_PRINT_TABLE_ARRAY_MAX
+#define STRUCT_PRINT_TABLE_ARRAY_MAX    4
+#endif
+
+/* 单元格格式化缓冲区大小（可容纳以上两种列以及 "[N x 类型名]"）*/
+#define STRUCT_PRINT_TABLE_CELL_SIZE \
+    (STRUCT_PRINT_TABLE_ARRAY_MAX * (STRUCT_PRINT_FMT_DOUBLE_MAX + 1) + STRUCT_PRINT_TABLE_STRING_MAX + 48)
+
+/**
+ * @brief 表格输出状态
+ */
+typedef struct {
+    StructPrintSink* sink;                      /**< 输出缓冲区 */
+    StructPrintPath path;                       /**< 当前列名（嵌套结构体展开为 a.b）*/
+    size_t pending;                             /**< 上一列左对齐后尚未输出的填充空格 */
+    int header;                                 /**< 1 输出表头，0 输出数据行 */
+} StructTableState;
+
+/**
+ * @brief 列的最小显示宽度（由字段类型决定，保证同一列各行对齐）
+ * @return 宽度；0 表示宽度不固定（数值数组、结构体数组）
+ */
+static inline size_t table_value_width(const FieldDescriptor* field) {
+    if (field->type == FIELD_TYPE_STRUCT) return 0;
+    
+    if (field->array_count > 0) {
+        if (field->type == FIELD_TYPE_STRING || field->type == FIELD_TYPE_U8) {
+            size_t n = (field->array_count < STRUCT_PRINT_TABLE_STRING_MAX) ?
+                       field->array_count : STRUCT_PRINT_TABLE_STRING_MAX;
+            return n + 2;
+        }
+        return 0;
+    }
+    
+    switch (field->type) {
+        case FIELD_TYPE_U8:     return 3;
+        case FIELD_TYPE_S8:     return 4;
+        case FIELD_TYPE_U16:    return 5;
+        case FIELD_TYPE_S16:    return 6;
+        case FIELD_TYPE_U32:    return STRUCT_PRINT_FMT_U32_MAX;
+        case FIELD_TYPE_S32:    return STRUCT_PRINT_FMT_S32_MAX;
+        default:                return 12;
+    }
+}
+
+/**
+ * @brief 格式化单个标量到缓冲区
+ * @return 写入的字符数；类型不是标量时返回 0
+ */
+static inline size_t table_format_scalar(char* out, FieldType type, const void* addr) {
+    switch (type) {
+        case FIELD_TYPE_U8:     return fmt_u32_dec(out, *(const u8*)addr);
+        case FIELD_TYPE_U16:    return fmt_u32_dec(out, *(const u16*)addr);
+        case FIELD_TYPE_U32:    return fmt_u32_dec(out, *(const u32*)addr);
+        case FIELD_TYPE_S8:     return fmt_s32_dec(out, *(const s8*)addr);
+        case FIELD_TYPE_S16:    return fmt_s32_dec(out, *(const s16*)addr);
+        case FIELD_TYPE_S32:    return fmt_s32_dec(out, *(const s32*)addr);
+        case FIELD_TYPE_FLOAT:  return fmt_double(out, *(const float*)addr, STRUCT_PRINT_FLOAT_DECIMALS);
+        case FIELD_TYPE_DOUBLE: return fmt_double(out, *(const double*)addr, STRUCT_PRINT_FLOAT_DECIMALS);
+        default:                return 0;
+    }
+}
+
+/**
+ * @brief 格式化一个单元格
+ * @param out 输出缓冲区（STRUCT_PRINT_TABLE_CELL_SIZE 字节）
+ * @param field 字段描述符
+ * @param addr 字段地址
+ * @return 写入的字符数
+ */
+static inline size_t table_format_cell(char* out, const FieldDescriptor* field, const u8* addr) {
+    size_t len = 0;
+    size_t i;
+    
+    /* 结构体数组（或没有描述符的结构体）只显示概要 */
+    if (field->type == FIELD_TYPE_STRUCT) {
+        if (field->nested_desc == NULL) {
+            out[0] = '?';
+            return 1;
+        }
+        out[len++] = '[';
+        len += fmt_u32_dec(out + len, (u32)field->array_count);
+        memcpy(out + len, " x ", 3);
+        len += 3;
+        i = strlen(field->nested_desc->struct_name);
+        if (i > 32) i = 32;
+        memcpy(out + len, field->nested_desc->struct_name, i);
+        len += i;
+        out[len++] = ']';
+        return len;
+    }
+    
+    if (field_is_string(field, addr)) {
+        size_t n = bounded_strlen(addr, field->array_count);
+        out[len++] = '"';
+        if (n > STRUCT_PRINT_TABLE_STRING_MAX) {
+            memcpy(out + len, addr, STRUCT_PRINT_TABLE_STRING_MAX - 3);
+            len += STRUCT_PRINT_TABLE_STRING_MAX - 3;
+            memcpy(out + len, "...", 3);
+            len += 3;
+        } else {
+            memcpy(out + len, addr, n);
+            len += n;
+        }
+        out[len++] = '"';
+        return len;
+    }
+    
+    if (field->array_count > 0) {
+        size_t shown = (field->array_count < STRUCT_PRINT_TABLE_ARRAY_MAX) ?
+                       field->array_count : STRUCT_PRINT_TABLE_ARRAY_MAX;
+        out[len++] = '[';
+        for (i = 0; i < shown; i++) {
+            size_t n;
+            if (i > 0) out[len++] = ',';
+            n = table_format_scalar(out + len, field->type, addr + i * field->size);
+            if (n == 0) {
+                out[len] = '?';
+                n = 1;
+            }
+            len += n;
+        }
+        if (field->array_count > shown) {
+            memcpy(out + len, ",...", 4);
+            len += 4;
+        }
+        out[len++] = ']';
+        return len;
+    }
+    
+    len = table_format_scalar(out, field->type, addr);
+    if (len == 0) out[len++] = '?';
+    return len;
+}
+
+/**
+ * @brief 输出一列（表头或单元格），数值右对齐，其余左对齐
+ */
+static inline void table_emit_column(StructTableState* st, const char* text, size_t len,
+                                     size_t width, int right_align) {
+    size_t pad = (width > len) ? width - len : 0;
+    
+    /* 左对齐列的填充推迟到下一列之前输出，行尾不留空格 */
+    sink_fill(st->sink, ' ', st->pending + 2);
+    if (right_align) {
+        sink_fill(st->sink, ' ', pad);
+        st->pending = 0;
+    } else {
+        st->pending = pad;
+    }
+    sink_write(st->sink, text, len);
+}
+
+/**
+ * @brief 遍历描述符，输出表头或一行数据（嵌套结构体展开为多列）
+ * @param st 表格状态
+ * @param desc 结构体描述符
+ * @param base 结构体基地址（输出表头时不使用）
+ */
+static void table_walk(StructTableState* st, const StructDescriptor* desc, const u8* base) {
+    char cell[STRUCT_PRINT_TABLE_CELL_SIZE];
+    size_t i;
+    
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        size_t saved = struct_path_push(&st->path, field->name, 1);
+        
+        if (field->type == FIELD_TYPE_STRUCT && field->array_count == 0 && field->nested_desc != NULL) {
+            table_walk(st, field->nested_desc, st->header ? base : base + field->offset);
+        } else {
+            size_t value_width = table_value_width(field);
+            size_t width = (st->path.len > value_width) ? st->path.len : value_width;
+            int right_align = (field->array_count == 0 && field->type != FIELD_TYPE_STRUCT);
+            
+            if (st->header) {
+                table_emit_column(st, st->path.buf, st->path.len, width, right_align);
+            } else {
+                size_t len = table_format_cell(cell, field, base + field->offset);
+                table_emit_column(st, cell, len, width, right_align);
+            }
+        }
+        
+        struct_path_pop(&st->path, saved);
+    }
+}
+
+/**
+ * @brief 以表格形式打印结构体数组（实现）
+ * @note 第一列为元素下标，其余每个字段一列；列宽由字段类型和列名决定，不需要预先扫描数据
+ */
+static void struct_print_table_rows(StructPrintSink* sink, const void* array, size_t count, size_t first_index,
+                                    const StructDescriptor* desc, int indent_level, u16 indent_spaces) {
+    size_t indent = (size_t)indent_level * indent_spaces;
+    StructTableState st;
+    char index_text[STRUCT_PRINT_FMT_U32_MAX];
+    size_t index_width;
+    size_t i;
+    
+    st.sink = sink;
+    struct_path_reset(&st.path);
+    
+    /* 下标列宽度 = 最大下标的位数 */
+    index_width = fmt_u32_dec(index_text, (u32)(first_index + (count > 0 ? count - 1 : 0)));
+    
+    sink_fill(sink, ' ', indent + index_width - 1);
+    sink_putc(sink, '#');
+    st.pending = 0;
+    st.header = 1;
+    table_walk(&st, desc, NULL);
+    sink_endline(sink);
+    
+    st.header = 0;
+    for (i = 0; i < count; i++) {
+        size_t len = fmt_u32_dec(index_text, (u32)(first_index + i));
+        
+        sink_fill(sink, ' ', indent + index_width - len);
+        sink_write(sink, index_text, len);
+        st.pending = 0;
+        table_walk(&st, desc, (const u8*)array + i * desc->struct_size);
+        sink_endline(sink);
+    }
+}
+
+/**
+ * @brief 以表格形式打印结构体数组到指定输出缓冲区
+ * @param sink 输出缓冲区
+ * @param var_name 数组名
+ * @param array 数组首元素地址
+ * @param count 元素个数
+ * @param first_index 首元素显示的下标（打印数组片段时使用，通常为 0）
+ * @param desc 元素的结构体描述符
+ *
+ * @note 输出一行标题、一行列名（嵌套结构体字段展开为 a.b），之后每个元素一行；
+ *       不显示地址、偏移和十六进制内存
+ *
+ * @example
+ * Table: sensors [SensorData] x 2
+ *   #  sensor_id   value  status
+ *   0        100    -273       1
+ *   1        101      25       0
+ */
+static inline void struct_print_table_to(StructPrintSink* sink, const char* var_name, const void* array,
+                                         size_t count, size_t first_index, const StructDescriptor* desc) {
+    if (array == NULL || desc == NULL) {
+        sink_puts(sink, "Error: NULL pointer!");
+        sink_endline(sink);
+        struct_print_sink_flush(sink);
+        return;
+    }
+    
+    sink_puts(sink, "Table: ");
+    if (var_name != NULL && var_name[0] != '\0') {
+        sink_puts(sink, var_name);
+        sink_putc(sink, ' ');
+    }
+    sink_putc(sink, '[');
+    sink_puts(sink, desc->struct_name);
+    sink_puts(sink, "] x ");
+    sink_put_u32(sink, (u32)count);
+    sink_endline(sink);
+    
+    struct_print_table_rows(sink, array, count, first_index, desc, 1, STRUCT_PRINT_INDENT_SPACES);
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 以表格形式打印结构体数组（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_TABLE 宏
+ */
+static inline void struct_print_table(const char* var_name, const void* array, size_t count,
+                                      size_t first_index, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_table_to(&sink, var_name, array, count, first_index, desc);
+    struct_print_out_end(&sink, &locked);
+}
+
+/* ============================================================================
+ *                    JSON / NDJSON 输出（STRUCT_PRINT_JSON）
+ * ============================================================================ */
+
+/**
+ * @brief 输出带引号的 JSON 字符串（一次扫描完成转义）
+ * @param sink 输出缓冲区
+ * @param data 字符数据
+ * @param len 字符数
+ *
+ * @note 不需要转义的连续字符整段写入；'"'、'\\' 和控制字符转义，
+ *       0x80 及以上的字节原样输出（按 UTF-8 处理）
+ */
+static inline void json_put_string(StructPrintSink* sink, const char* data, size_t len) {
+    static const char hex_digits[] = "0123456789abcdef";
+    size_t start = 0;
+    size_t i;
+    
+    sink_putc(sink, '"');
+    for (i = 0; i < len; i++) {
+        u8 c = (u8)data[i];
+        
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        
+        sink_write(sink, data + start, i - start);
+        start = i + 1;
+        switch (c) {
+            case '"':   sink_puts(sink, "\\\""); break;
+            case '\\':  sink_puts(sink, "\\\\"); break;
+            case '\n':  sink_puts(sink, "\\n"); break;
+            case '\r':  sink_puts(sink, "\\r"); break;
+            case '\t':  sink_puts(sink, "\\t"); break;
+            default:
+                sink_puts(sink, "\\u00");
+                sink_putc(sink, hex_digits[c >> 4]);
+                sink_putc(sink, hex_digits[c & 0x0F]);
+                break;
+        }
+    }
+    sink_write(sink, data + start, len - start);
+    sink_putc(sink, '"');
+}
+
+/**
+ * @brief 输出 JSON 数值（NaN/Inf 在 JSON 中没有表示，输出 null）
+ * @param sink 输出缓冲区
+ * @param type 元素类型
+ * @param addr 元素地址
+ */
+static inline void json_put_scalar(StructPrintSink* sink, FieldType type, const void* addr) {
+    double value;
+    
+    if (type == FIELD_TYPE_FLOAT) {
+        value = *(const float*)addr;
+    } else if (type == FIELD_TYPE_DOUBLE) {
+        value = *(const double*)addr;
+    } else {
+        if (!print_scalar(sink, type, addr)) sink_puts(sink, "null");
+        return;
+    }
+    
+    if (value != value || value - value != 0.0) {
+        sink_puts(sink, "null");
+    } else {
+        sink_put_double(sink, value);
+    }
+}
+
+static void json_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc);
+
+/**
+ * @brief 输出单个字段的 JSON 值
+ * @note 字符串 -> JSON 字符串，数值数组 -> JSON 数组（全部元素），
+ *       嵌套结构体 -> 对象，结构体数组 -> 对象数组
+ */
+static void json_write_field(StructPrintSink* sink, const FieldDescriptor* field, const u8* addr) {
+    size_t i;
+    
+    if (field->type == FIELD_TYPE_STRUCT) {
+        if (field->nested_desc == NULL) {
+            sink_puts(sink, "null");
+        } else if (field->array_count > 0) {
+            sink_putc(sink, '[');
+            for (i = 0; i < field->array_count; i++) {
+                if (i > 0) sink_putc(sink, ',');
+                json_write_struct(sink, addr + i * field->size, field->nested_desc);
+            }
+            sink_putc(sink, ']');
+        } else {
+            json_write_struct(sink, addr, field->nested_desc);
+        }
+        return;
+    }
+    
+    if (field_is_string(field, addr)) {
+        json_put_string(sink, (const char*)addr, bounded_strlen(addr, field->array_count));
+        return;
+    }
+    
+    if (field->array_count > 0) {
+        sink_putc(sink, '[');
+        for (i = 0; i < field->array_count; i++) {
+            if (i > 0) sink_putc(sink, ',');
+            json_put_scalar(sink, field->type, addr + i * field->size);
+        }
+        sink_putc(sink, ']');
+        return;
+    }
+    
+    json_put_scalar(sink, field->type, addr);
+}
+
+/**
+ * @brief 输出结构体的 JSON 对象（字段顺序与描述符相同，不含空白）
+ */
+static void json_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc) {
+    size_t i;
+    
+    sink_putc(sink, '{');
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        
+        /* 字段名是 C 标识符，不需要转义 */
+        if (i > 0) sink_putc(sink, ',');
+        sink_putc(sink, '"');
+        sink_puts(sink, field->name);
+        sink_puts(sink, "\":");
+        json_write_field(sink, field, base + field->offset);
+    }
+    sink_putc(sink, '}');
+}
+
+/**
+ * @brief 输出结构体的 JSON 对象（只有字段值，不换行、不刷新）
+ * @param sink 输出缓冲区
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ */
+static inline void struct_json_write(StructPrintSink* sink, const void* struct_data, const StructDescriptor* desc) {
+    if (struct_data == NULL || desc == NULL) {
+        sink_puts(sink, "null");
+        return;
+    }
+    json_write_struct(sink, (const u8*)struct_data, desc);
+}
+
+/**
+ * @brief 输出一条 NDJSON 记录（一行，不刷新）
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ *
+ * @note 格式：{"var":"device","struct":"DeviceInfo","value":{"device_id":5,...}}\n
+ * @note 连续调用即为 NDJSON 流；配合 STRUCT_PRINT_SINK_FLUSH_FULL 的大缓冲区，
+ *       多条记录合并为一次写出
+ */
+static inline void struct_json_record(StructPrintSink* sink, const char* var_name,
+                                      const void* struct_data, const StructDescriptor* desc) {
+    sink_puts(sink, "{\"var\":");
+    json_put_string(sink, var_name != NULL ? var_name : "", var_name != NULL ? strlen(var_name) : 0);
+    sink_puts(sink, ",\"struct\":");
+    if (desc != NULL) {
+        json_put_string(sink, desc->struct_name, strlen(desc->struct_name));
+    } else {
+        sink_puts(sink, "null");
+    }
+    sink_puts(sink, ",\"value\":");
+    struct_json_write(sink, struct_data, desc);
+    sink_putc(sink, '}');
+    sink_endline(sink);
+}
+
+/**
+ * @brief 以 JSON 格式打印结构体到指定输出缓冲区（一行 NDJSON 记录，结束后刷新）
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ */
+static inline void struct_print_json_to(StructPrintSink* sink, const char* var_name,
+                                        const void* struct_data, const StructDescriptor* desc) {
+    struct_json_record(sink, var_name, struct_data, desc);
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 以 JSON 格式打印结构体（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_JSON 宏
+ */
+static inline void struct_print_json(const char* var_name, const void* struct_data, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    struct_print_json_to(&sink, var_name, struct_data, desc);
+    struct_print_out_end(&sink, &locked);
+}
+
+/**
+ * @brief 以 NDJSON 记录输出解码后的日志帧（主机端使用，不刷新）
+ * @param sink 输出缓冲区
+ * @param frame 日志帧
+ * @param desc 描述符（未找到时为 NULL）
+ *
+ * @note 格式：{"t":1000,"struct":"DeviceInfo","addr":"0x20001000","value":{...}}；
+ *       描述符未知或大小不符时 value 为 null，并给出 "id"/"size"
+ */
+static inline void struct_log_json(StructPrintSink* sink, const StructLogFrame* frame, const StructDescriptor* desc) {
+    sink_puts(sink, "{\"t\":");
+    sink_put_u32(sink, frame->timestamp);
+    
+    if (desc == NULL) {
+        sink_puts(sink, (frame->flags & STRUCT_LOG_FLAG_FINGERPRINT) ? ",\"fingerprint\":\"0x" : ",\"id\":\"0x");
+        sink_put_hex(sink, frame->desc_id, 8);
+        sink_putc(sink, '"');
+    } else {
+        sink_puts(sink, ",\"struct\":");
+        json_put_string(sink, desc->struct_name, strlen(desc->struct_name));
+    }
+    
+    sink_puts(sink, ",\"addr\":\"0x");
+    sink_put_hex(sink, frame->address, 8);
+    sink_puts(sink, "\",\"value\":");
+    
+    if (desc != NULL && desc->struct_size == frame->payload_len) {
+        json_write_struct(sink, frame->payload, desc);
+    } else {
+        sink_puts(sink, "null,\"size\":");
+        sink_put_u32(sink, (u32)frame->payload_len);
+    }
+    sink_putc(sink, '}');
+    sink_endline(sink);
+}
+
+/* ============================================================================
+ *                    单行紧凑格式（STRUCT_PRINT_COMPACT）
+ * ============================================================================ */
+
+/* STRUCT_PRINT_COMPACT 使用的栈上缓冲区大小（一条记录不超过它时只调用一次 STRUCT_PRINT_PRINTF）*/
+#ifndef STRUCT_PRINT_COMPACT_BUF_SIZE
+#define STRUCT_PRINT_COMPACT_BUF_SIZE   STRUCT_PRINT_RECORD_BUF_SIZE
+#endif
+
+static void compact_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc);
+
+/**
+ * @brief 输出单个字段的紧凑值
+ * @note 字符串加引号，数值数组 [a,b,...]（全部元素），嵌套结构体 {...}，结构体数组 [{...},{...}]
+ */
+static void compact_write_field(StructPrintSink* sink, const FieldDescriptor* field, const u8* addr) {
+    FieldType type = (field->type == FIELD_TYPE_STRING) ? FIELD_TYPE_U8 : field->type;
+    size_t i;
+    
+    if (field->type == FIELD_TYPE_STRUCT) {
+        if (field->nested_desc == NULL) {
+            sink_putc(sink, '?');
+        } else if (field->array_count > 0) {
+            sink_putc(sink, '[');
+            for (i = 0; i < field->array_count; i++) {
+                if (i > 0) sink_putc(sink, ',');
+                compact_write_struct(sink, addr + i * field->size, field->nested_desc);
+            }
+            sink_putc(sink, ']');
+        } else {
+            compact_write_struct(sink, addr, field->nested_desc);
+        }
+        return;
+    }
+    
+    if (field_is_string(field, addr)) {
+        print_quoted_string(sink, addr, field->array_count);
+        return;
+    }
+    
+    if (field->array_count > 0) {
+        sink_putc(sink, '[');
+        for (i = 0; i < field->array_count; i++) {
+            if (i > 0) sink_putc(sink, ',');
+            if (!print_scalar(sink, type, addr + i * field->size)) sink_putc(sink, '?');
+        }
+        sink_putc(sink, ']');
+        return;
+    }
+    
+    if (!print_scalar(sink, type, addr)) sink_putc(sink, '?');
+}
+
+/**
+ * @brief 输出 {name=value,...}（不含空白）
+ */
+static void compact_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc) {
+    size_t i;
+    
+    sink_putc(sink, '{');
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        
+        if (i > 0) sink_putc(sink, ',');
+        sink_puts(sink, field->name);
+        sink_putc(sink, '=');
+        compact_write_field(sink, field, base + field->offset);
+    }
+    sink_putc(sink, '}');
+}
+
+/**
+ * @brief 输出一条紧凑记录（一行，不刷新）
+ * @param sink 输出缓冲区
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ *
+ * @note 格式：SystemStatus{timestamp=123,device={device_id=1,...},error_code=0}\n
+ * @note 一次遍历直接写入 sink 缓冲区；缓冲区能容纳整条记录时，按行刷新模式下只调用一次刷新回调
+ */
+static inline void struct_compact_record(StructPrintSink* sink, const void* struct_data, const StructDescriptor* desc) {
+    if (struct_data == NULL || desc == NULL) {
+        sink_puts(sink, "Error: NULL pointer!");
+    } else {
+        sink_puts(sink, desc->struct_name);
+        compact_write_struct(sink, (const u8*)struct_data, desc);
+    }
+    sink_endline(sink);
+}
+
+/**
+ * @brief 以单行紧凑格式打印结构体到指定输出缓冲区（结束后刷新）
+ * @param sink 输出缓冲区
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ */
+static inline void struct_print_compact_to(StructPrintSink* sink, const void* struct_data, const StructDescriptor* desc) {
+    struct_compact_record(sink, struct_data, desc);
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 以单行紧凑格式打印结构体（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_COMPACT 宏
+ * @note 记录不超过 STRUCT_PRINT_COMPACT_BUF_SIZE - 1 字节时只调用一次 STRUCT_PRINT_PRINTF；
+ *       超过时与线程安全模式相同，从第一次输出起持有 STRUCT_PRINT_LOCK()，整条记录输出完才释放
+ */
+static inline void struct_print_compact(const void* struct_data, const StructDescriptor* desc) {
+    char buf[STRUCT_PRINT_COMPACT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked = 0;
+    
+    struct_print_sink_init(&sink, buf, sizeof(buf), struct_print_locked_flush, &locked, STRUCT_PRINT_SINK_FLUSH_FULL);
+    struct_print_compact_to(&sink, struct_data, desc);
+    struct_print_out_end(&sink, &locked);
+}
+
+/* ============================================================================
+ *                    CBOR 二进制编码（STRUCT_CBOR）
+ * ============================================================================
+ *
+ * 输出为 CBOR 序列（RFC 8949 / RFC 8742），每一项是一个数组：
+ *   名称表：[0, 描述符ID, "结构体名", [字段, ...]]
+ *           字段写作 "name"；嵌套结构体（及结构体数组）字段写作 ["name", 嵌套描述符ID]
+ *   记录：  [1, 描述符ID, 时间戳, {字段序号: 值, ...}]
+ *
+ * 记录中的键是字段在描述符中的序号（小于 24 时只占 1 字节），字段名只在名称表中出现；
+ * 每个会话（连接）开始时发送一次名称表。解码端只依赖数据流中的名称表，
+ * 不需要与固件相同的描述符，固件升级增删字段后依然能还原字段名。
+ *
+ * 值的编码：无符号/有符号整数 -> CBOR 整数（最短形式），float -> float32，double -> float64，
+ *           字符串 -> 文本串，u8 数组（非字符串）-> 字节串，其他数组 -> 数组，
+ *           嵌套结构体 -> map，结构体数组 -> map 数组
+ *
+ * @note 输出包含 0 字节，Sink 的刷新回调必须按长度写出二进制数据（不能使用默认的 printf 适配器）
+ */
+
+/* 数据项类型（数组的第一个元素）*/
+#define STRUCT_CBOR_SCHEMA              0
+#define STRUCT_CBOR_RECORD              1
+
+/* 每个会话最多记录的已发送名称表个数（超出后每条记录都重新发送名称表）*/
+#ifndef STRUCT_CBOR_SESSION_MAX
+#define STRUCT_CBOR_SESSION_MAX         16
+#endif
+
+/**
+ * @brief CBOR 会话：记录本次连接中已经发送过名称表的描述符
+ */
+typedef struct {
+    const StructDescriptor* sent[STRUCT_CBOR_SESSION_MAX]; /**< 已发送名称表的描述符 */
+    size_t count;                               /**< 已发送个数 */
+} StructCborSession;
+
+/**
+ * @brief 会话静态初始化
+ */
+#define STRUCT_CBOR_SESSION_INIT { { NULL }, 0 }
+
+/**
+ * @brief 重置会话（重新连接后调用，下一条记录会重新发送名称表）
+ */
+static inline void struct_cbor_session_reset(StructCborSession* session) {
+    session->count = 0;
+}
+
+/**
+ * @brief 输出 CBOR 数据项头部（主类型 + 参数，使用最短编码）
+ * @param sink 输出缓冲区
+ * @param major 主类型（0~7）
+ * @param value 参数值
+ */
+static inline void cbor_put_head(StructPrintSink* sink, u8 major, u32 value) {
+    char head[5];
+    size_t n;
+    
+    if (value < 24) {
+        head[0] = (char)((major << 5) | value);
+        n = 1;
+    } else if (value <= 0xFF) {
+        head[0] = (char)((major << 5) | 24);
+        head[1] = (char)value;
+        n = 2;
+    } else if (value <= 0xFFFF) {
+        head[0] = (char)((major << 5) | 25);
+        head[1] = (char)(value >> 8);
+        head[2] = (char)value;
+        n = 3;
+    } else {
+        head[0] = (char)((major << 5) | 26);
+        head[1] = (char)(value >> 24);
+        head[2] = (char)(value >> 16);
+        head[3] = (char)(value >> 8);
+        head[4] = (char)value;
+        n = 5;
+    }
+    sink_write(sink, head, n);
+}
+
+/**
+ * @brief 输出 CBOR 文本串
+ */
+static inline void cbor_put_text(StructPrintSink* sink, const char* text, size_t len) {
+    cbor_put_head(sink, 3, (u32)len);
+    sink_write(sink, text, len);
+}
+
+/**
+ * @brief 输出单个标量值
+ * @param sink 输出缓冲区
+ * @param type 元素类型
+ * @param addr 元素地址
+ */
+static inline void cbor_put_scalar(StructPrintSink* sink, FieldType type, const void* addr) {
+    char out[9];
+    s32 value;
+    
+    switch (type) {
+        case FIELD_TYPE_U8:     cbor_put_head(sink, 0, *(const u8*)addr); return;
+        case FIELD_TYPE_U16:    cbor_put_head(sink, 0, *(const u16*)addr); return;
+        case FIELD_TYPE_U32:    cbor_put_head(sink, 0, *(const u32*)addr); return;
+        case FIELD_TYPE_S8:     value = *(const s8*)addr; break;
+        case FIELD_TYPE_S16:    value = *(const s16*)addr; break;
+        case FIELD_TYPE_S32:    value = *(const s32*)addr; break;
+        
+        case FIELD_TYPE_FLOAT: {
+            u32 bits;
+            memcpy(&bits, addr, sizeof(bits));
+            out[0] = (char)0xFA;
+            out[1] = (char)(bits >> 24);
+            out[2] = (char)(bits >> 16);
+            out[3] = (char)(bits >> 8);
+            out[4] = (char)bits;
+            sink_write(sink, out, 5);
+            return;
+        }
+        
+        case FIELD_TYPE_DOUBLE: {
+            uint64_t bits;
+            int i;
+            memcpy(&bits, addr, sizeof(bits));
+            out[0] = (char)0xFB;
+            for (i = 0; i < 8; i++) {
+                out[1 + i] = (char)(bits >> (56 - 8 * i));
+            }
+            sink_write(sink, out, 9);
+            return;
+        }
+        
+        default:
+            sink_putc(sink, (char)0xF6);        /* null */
+            return;
+    }
+    
+    /* 负数 n 编码为主类型 1，参数 -1-n */
+    if (value >= 0) {
+        cbor_put_head(sink, 0, (u32)value);
+    } else {
+        cbor_put_head(sink, 1, (u32)(-(value + 1)));
+    }
+}
+
+static void cbor_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc);
+
+/**
+ * @brief 输出单个字段的值
+ */
+static void cbor_write_field(StructPrintSink* sink, const FieldDescriptor* field, const u8* addr) {
+    size_t i;
+    
+    if (field->type == FIELD_TYPE_STRUCT) {
+        if (field->nested_desc == NULL) {
+            sink_putc(sink, (char)0xF6);
+        } else if (field->array_count > 0) {
+            cbor_put_head(sink, 4, (u32)field->array_count);
+            for (i = 0; i < field->array_count; i++) {
+                cbor_write_struct(sink, addr + i * field->size, field->nested_desc);
+            }
+        } else {
+            cbor_write_struct(sink, addr, field->nested_desc);
+        }
+        return;
+    }
+    
+    if (field_is_string(field, addr)) {
+        cbor_put_text(sink, (const char*)addr, bounded_strlen(addr, field->array_count));
+        return;
+    }
+    
+    if (field->array_count > 0) {
+        if (field->type == FIELD_TYPE_U8) {
+            cbor_put_head(sink, 2, (u32)field->array_count);
+            sink_write(sink, (const char*)addr, field->array_count);
+            return;
+        }
+        cbor_put_head(sink, 4, (u32)field->array_count);
+        for (i = 0; i < field->array_count; i++) {
+            cbor_put_scalar(sink, field->type, addr + i * field->size);
+        }
+        return;
+    }
+    
+    cbor_put_scalar(sink, field->type, addr);
+}
+
+/**
+ * @brief 输出结构体的 CBOR map（键为字段序号）
+ */
+static void cbor_write_struct(StructPrintSink* sink, const u8* base, const StructDescriptor* desc) {
+    size_t i;
+    
+    cbor_put_head(sink, 5, (u32)desc->field_count);
+    for (i = 0; i < desc->field_count; i++) {
+        cbor_put_head(sink, 0, (u32)i);
+        cbor_write_field(sink, &desc->fields[i], base + desc->fields[i].offset);
+    }
+}
+
+/**
+ * @brief 输出一个结构体的名称表（不含嵌套结构体的名称表）
+ * @param sink 输出缓冲区
+ * @param desc 结构体描述符
+ */
+static inline void struct_cbor_schema(StructPrintSink* sink, const StructDescriptor* desc) {
+    size_t i;
+    
+    cbor_put_head(sink, 4, 4);
+    cbor_put_head(sink, 0, STRUCT_CBOR_SCHEMA);
+    cbor_put_head(sink, 0, struct_desc_id(desc));
+    cbor_put_text(sink, desc->struct_name, strlen(desc->struct_name));
+    cbor_put_head(sink, 4, (u32)desc->field_count);
+    
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        
+        if (field->type == FIELD_TYPE_STRUCT && field->nested_desc != NULL) {
+            cbor_put_head(sink, 4, 2);
+            cbor_put_text(sink, field->name, strlen(field->name));
+            cbor_put_head(sink, 0, struct_desc_id(field->nested_desc));
+        } else {
+            cbor_put_text(sink, field->name, strlen(field->name));
+        }
+    }
+}
+
+/**
+ * @brief 本会话中首次出现的描述符：先发送嵌套结构体的名称表，再发送自身的名称表
+ */
+static void cbor_session_send_schema(StructCborSession* session, StructPrintSink* sink, const StructDescriptor* desc) {
+    size_t i;
+    
+    for (i = 0; i < session->count; i++) {
+        if (session->sent[i] == desc) return;
+    }
+    if (session->count < STRUCT_CBOR_SESSION_MAX) {
+        session->sent[session->count++] = desc;
+    }
+    
+    for (i = 0; i < desc->field_count; i++) {
+        if (desc->fields[i].type == FIELD_TYPE_STRUCT && desc->fields[i].nested_desc != NULL) {
+            cbor_session_send_schema(session, sink, desc->fields[i].nested_desc);
+        }
+    }
+    struct_cbor_schema(sink, desc);
+}
+
+/**
+ * @brief 输出一条 CBOR 记录（不刷新）
+ * @param session 会话（NULL 表示不自动发送名称表）
+ * @param sink 输出缓冲区
+ * @param desc 结构体描述符
+ * @param struct_data 结构体数据指针
+ * @param timestamp 时间戳
+ */
+static inline void struct_cbor_record(StructCborSession* session, StructPrintSink* sink,
+                                      const StructDescriptor* desc, const void* struct_data, u32 timestamp) {
+    if (desc == NULL || struct_data == NULL) return;
+    
+    if (session != NULL) {
+        cbor_session_send_schema(session, sink, desc);
+    }
+    
+    cbor_put_head(sink, 4, 4);
+    cbor_put_head(sink, 0, STRUCT_CBOR_RECORD);
+    cbor_put_head(sink, 0, struct_desc_id(desc));
+    cbor_put_head(sink, 0, timestamp);
+    cbor_write_struct(sink, (const u8*)struct_data, desc);
+}
+
+/**
+ * @brief 输出一条 CBOR 记录并刷新（时间戳取 STRUCT_LOG_TIMESTAMP）
+ * @note 用户请使用 STRUCT_CBOR_TO 宏
+ */
+static inline void struct_cbor_to(StructCborSession* session, StructPrintSink* sink,
+                                  const StructDescriptor* desc, const void* struct_data) {
+    struct_cbor_record(session, sink, desc, struct_data, STRUCT_LOG_TIMESTAMP());
+    struct_print_sink_flush(sink);
+}
+
+/* ============================================================================
+ *                    Schema 导出（描述符指纹）
+ * ============================================================================
+ *
+ * 将描述符表导出为 Schema，主机端据此按固件实际布局解码旧日志：
+ *   CBOR：每个结构体一项 [2, 指纹, "结构体名", 大小, [字段, ...]]
+ *         字段写作 ["name", 类型, 偏移, 大小, 数组元素个数]，
+ *         嵌套结构体字段追加第 6 个元素：嵌套结构体的指纹
+ *   JSON：{"schema":1,"structs":[{"struct":..,"id":..,"fingerprint":..,"size":..,"fields":[..]}, ...]}
+ *         嵌套结构体字段带 "fingerprint"：嵌套结构体的指纹
+ *
+ * 两种格式的嵌套引用都以指纹为键（同名结构体的不同布局可以同时出现在一个 Schema 中）。
+ * 类型取值与 FieldType 相同；嵌套的描述符会自动一并导出（先于引用它的结构体，且只导出一次）。
+ * 配合 STRUCT_LOG_ID_FINGERPRINT，日志帧只携带 4 字节指纹，不携带字段名。
+ */
+
+/* CBOR 数据项类型：布局 Schema（与 STRUCT_CBOR_SCHEMA / STRUCT_CBOR_RECORD 同一编号空间）*/
+#define STRUCT_CBOR_LAYOUT              2
+
+/* 一次导出最多包含的结构体个数（含嵌套），超出部分被忽略 */
+#ifndef STRUCT_SCHEMA_MAX
+#define STRUCT_SCHEMA_MAX               64
+#endif
+
+/**
+ * @brief 字段类型名称（与 FIELD_xxx 宏对应）
+ */
+static inline const char* field_type_name(FieldType type) {
+    switch (type) {
+        case FIELD_TYPE_U8:     return "u8";
+        case FIELD_TYPE_U16:    return "u16";
+        case FIELD_TYPE_U32:    return "u32";
+        case FIELD_TYPE_S8:     return "s8";
+        case FIELD_TYPE_S16:    return "s16";
+        case FIELD_TYPE_S32:    return "s32";
+        case FIELD_TYPE_FLOAT:  return "float";
+        case FIELD_TYPE_DOUBLE: return "double";
+        case FIELD_TYPE_ARRAY:  return "array";
+        case FIELD_TYPE_STRING: return "string";
+        case FIELD_TYPE_STRUCT: return "struct";
+        default:                return "unknown";
+    }
+}
+
+/**
+ * @brief 收集描述符及其嵌套描述符（嵌套在前，去重）
+ * @return 收集后的个数
+ */
+static inline size_t schema_collect(const StructDescriptor* desc, const StructDescriptor** list, size_t count) {
+    size_t i;
+    
+    for (i = 0; i < count; i++) {
+        if (list[i] == desc) return count;
+    }
+    for (i = 0; i < desc->field_count; i++) {
+        if (desc->fields[i].nested_desc != NULL) {
+            count = schema_collect(desc->fields[i].nested_desc, list, count);
+        }
+    }
+    if (count < STRUCT_SCHEMA_MAX) {
+        list[count++] = desc;
+    }
+    return count;
+}
+
+/**
+ * @brief 以 CBOR 序列导出描述符表的 Schema
+ * @param sink 输出缓冲区（刷新回调需按长度写出二进制数据）
+ * @param descs 描述符指针数组
+ * @param count 数组元素个数
+ *
+ * @note 输出可直接追加在 STRUCT_CBOR 数据流之前，或单独保存为 Schema 文件
+ */
+static inline void struct_schema_export_cbor(StructPrintSink* sink, const StructDescriptor* const* descs, size_t count) {
+    const StructDescriptor* list[STRUCT_SCHEMA_MAX];
+    size_t n = 0;
+    size_t i, j;
+    
+    for (i = 0; i < count; i++) {
+        n = schema_collect(descs[i], list, n);
+    }
+    
+    for (i = 0; i < n; i++) {
+        const StructDescriptor* desc = list[i];
+        
+        cbor_put_head(sink, 4, 5);
+        cbor_put_head(sink, 0, STRUCT_CBOR_LAYOUT);
+        cbor_put_head(sink, 0, struct_desc_fingerprint(desc));
+        cbor_put_text(sink, desc->struct_name, strlen(desc->struct_name));
+        cbor_put_head(sink, 0, (u32)desc->struct_size);
+        cbor_put_head(sink, 4, (u32)desc->field_count);
+        for (j = 0; j < desc->field_count; j++) {
+            const FieldDescriptor* field = &desc->fields[j];
+            
+            cbor_put_head(sink, 4, field->nested_desc != NULL ? 6 : 5);
+            cbor_put_text(sink, field->name, strlen(field->name));
+            cbor_put_head(sink, 0, (u32)field->type);
+            cbor_put_head(sink, 0, (u32)field->offset);
+            cbor_put_head(sink, 0, (u32)field->size);
+            cbor_put_head(sink, 0, (u32)field->array_count);
+            if (field->nested_desc != NULL) {
+                cbor_put_head(sink, 0, struct_desc_fingerprint(field->nested_desc));
+            }
+        }
+    }
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 以 JSON 导出描述符表的 Schema（每个结构体一行）
+ * @param sink 输出缓冲区
+ * @param descs 描述符指针数组
+ * @param count 数组元素个数
+ */
+static inline void struct_schema_export_json(StructPrintSink* sink, const StructDescriptor* const* descs, size_t count) {
+    const StructDescriptor* list[STRUCT_SCHEMA_MAX];
+    size_t n = 0;
+    size_t i, j;
+    
+    for (i = 0; i < count; i++) {
+        n = schema_collect(descs[i], list, n);
+    }
+    
+    sink_puts(sink, "{\"schema\":1,\"structs\":[");
+    for (i = 0; i < n; i++) {
+        const StructDescriptor* desc = list[i];
+        
+        sink_puts(sink, (i > 0) ? "," : "");
+        sink_endline(sink);
+        sink_puts(sink, "{\"struct\":");
+        json_put_string(sink, desc->struct_name, strlen(desc->struct_name));
+        sink_puts(sink, ",\"id\":\"0x");
+        sink_put_hex(sink, struct_desc_id(desc), 8);
+        sink_puts(sink, "\",\"fingerprint\":\"0x");
+        sink_put_hex(sink, struct_desc_fingerprint(desc), 8);
+        sink_puts(sink, "\",\"size\":");
+        sink_put_u32(sink, (u32)desc->struct_size);
+        sink_puts(sink, ",\"fields\":[");
+        for (j = 0; j < desc->field_count; j++) {
+            const FieldDescriptor* field = &desc->fields[j];
+            
+            sink_puts(sink, (j > 0) ? ",{\"name\":" : "{\"name\":");
+            json_put_string(sink, field->name, strlen(field->name));
+            sink_puts(sink, ",\"type\":\"");
+            sink_puts(sink, field_type_name(field->type));
+            sink_puts(sink, "\",\"offset\":");
+            sink_put_u32(sink, (u32)field->offset);
+            sink_puts(sink, ",\"size\":");
+            sink_put_u32(sink, (u32)field->size);
+            sink_puts(sink, ",\"count\":");
+            sink_put_u32(sink, (u32)field->array_count);
+            if (field->nested_desc != NULL) {
+                sink_puts(sink, ",\"fingerprint\":\"0x");
+                sink_put_hex(sink, struct_desc_fingerprint(field->nested_desc), 8);
+                sink_putc(sink, '"');
+            }
+            sink_putc(sink, '}');
+        }
+        sink_puts(sink, "]}");
+    }
+    sink_endline(sink);
+    sink_puts(sink, "]}");
+    sink_endline(sink);
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 自动选择描述符的辅助宏（C11 版本）
+ * @param var 变量
+ * @return 对应类型的描述符指针
+ * 
+ * @note 此宏使用 C11 _Generic 实现类型到描述符的自动映射
+ * @note 由描述符生成器自动生成，用户无需手动定义
+ * 
+ * @example 在生成的描述符文件中会包含类似定义：
+ * #define GET_STRUCT_DESC(var) _Generic((var), \
+ *     DeviceInfo: &DeviceInfo_desc, \
+ *     SystemStatus: &SystemStatus_desc, \
+ *     default: NULL \
+ * )
+ */
+#ifndef GET_STRUCT_DESC
+#if STRUCT_PRINT_HAS_CPP17
+#define GET_STRUCT_DESC(var) struct_print_desc_of(&(var))  /* C++：重载决议（见 STRUCT_PRINT_REFLECT）*/
+#else
+#define GET_STRUCT_DESC(var) NULL  /* 未定义时返回 NULL */
+#endif
+#endif
+
+/* ============================================================================
+ *                    字段路径解析
+ * ============================================================================ */
+
+/**
+ * @brief 路径解析结果：字段描述符 + 相对根结构体的绝对偏移
+ * @note 类型取 field->type；嵌套结构体字段可继续用 field->nested_desc 打印
+ */
+typedef struct {
+    const FieldDescriptor* field;               /**< 字段描述符 */
+    size_t offset;                              /**< 相对根结构体起始地址的偏移（含数组下标）*/
+    size_t size;                                /**< 字节数（整个数组，或带下标时的单个元素）*/
+    size_t count;                               /**< 数组元素个数（非数组或带下标时为 0）*/
+} StructFieldRef;
+
+/**
+ * @brief 按路径逐级查找字段
+ * @param desc 根结构体描述符
+ * @param path 字段路径，如 "device.temperature"、"sensors[2].value"、"serial[0]"
+ * @param ref 解析结果
+ * @return 0 成功；-1 字段不存在、下标越界或路径格式错误
+ *
+ * @note 每一级按名称比较；固定的路径可解析一次后缓存 ref，或使用 StructPathIndex 直接散列查找
+ */
+static inline int struct_field_resolve(const StructDescriptor* desc, const char* path, StructFieldRef* ref) {
+    const char* p = path;
+    size_t base = 0;
+    
+    for (;;) {
+        const FieldDescriptor* field = NULL;
+        size_t len = 0;
+        size_t i;
+        
+        while (p[len] != '\0' && p[len] != '.' && p[len] != '[') len++;
+        for (i = 0; i < desc->field_count && len > 0; i++) {
+            if (strncmp(desc->fields[i].name, p, len) == 0 && desc->fields[i].name[len] == '\0') {
+                field = &desc->fields[i];
+                break;
+            }
+        }
+        if (field == NULL) return -1;
+        p += len;
+        
+        ref->field = field;
+        ref->offset = base + field->offset;
+        ref->count = field->array_count;
+        ref->size = field->size * (field->array_count > 0 ? field->array_count : 1);
+        
+        if (*p == '[') {
+            size_t index = 0;
+            
+            p++;
+            if (*p < '0' || *p > '9') return -1;
+            while (*p >= '0' && *p <= '9') {
+                index = index * 10 + (size_t)(*p++ - '0');
+                if (index >= field->array_count) return -1;
+            }
+            if (*p++ != ']') return -1;
+            ref->offset += index * field->size;
+            ref->count = 0;
+            ref->size = field->size;
+        }
+        
+        if (*p == '\0') return 0;
+        if (*p != '.' || field->type != FIELD_TYPE_STRUCT || field->nested_desc == NULL || ref->count > 0) {
+            return -1;
+        }
+        desc = field->nested_desc;
+        base = ref->offset;
+        p++;
+    }
+}
+
+/**
+ * @brief 解析字段路径，返回可缓存的字段句柄
+ * @param desc 根结构体描述符
+ * @param path 字段路径
+ * @return 字段句柄；路径无效时 field 为 NULL
+ *
+ * @note 句柄只与描述符有关，与具体变量无关：解析一次后可用于同类型的任意变量
+ *
+ * @example
+ * static StructFieldRef temp_ref;
+ * if (temp_ref.field == NULL) temp_ref = STRUCT_FIELD_REF(status, "device.temperature");
+ * float t = STRUCT_FIELD_AT(status, temp_ref, float);       // 一次指针加法 + 一次 float 读取
+ */
+static inline StructFieldRef struct_field_ref(const StructDescriptor* desc, const char* path) {
+    StructFieldRef ref;
+    
+    if (desc == NULL || path == NULL || struct_field_resolve(desc, path, &ref) != 0) {
+        memset(&ref, 0, sizeof(ref));
+    }
+    return ref;
+}
+
+/**
+ * @brief 按句柄访问字段（左值，调用者给出 C 类型）
+ * @param var 结构体变量
+ * @param ref 字段句柄（StructFieldRef）
+ * @param ctype 字段的 C 类型，如 float、u16
+ */
+#define STRUCT_FIELD_AT(var, ref, ctype) (*(ctype*)((u8*)&(var) + (ref).offset))
+
+/**
+ * @brief 按句柄读取数值字段（类型由描述符决定，统一转换为 double）
+ * @param struct_data 结构体数据指针
+ * @param ref 字段句柄
+ * @return 字段值；句柄无效、字段为数组（未带下标）或嵌套结构体时返回 0
+ *
+ * @note u8~s32、float、double 转换为 double 均无精度损失
+ */
+static inline double struct_field_get(const void* struct_data, const StructFieldRef* ref) {
+    const u8* addr;
+    
+    if (struct_data == NULL || ref->field == NULL || ref->count > 0) return 0.0;
+    addr = (const u8*)struct_data + ref->offset;
+    
+    switch (ref->field->type) {
+        case FIELD_TYPE_U8:
+        case FIELD_TYPE_STRING:   return *(const u8*)addr;
+        case FIELD_TYPE_U16:      return *(const u16*)addr;
+        case FIELD_TYPE_U32:      return *(const u32*)addr;
+        case FIELD_TYPE_S8:       return *(const s8*)addr;
+        case FIELD_TYPE_S16:      return *(const s16*)addr;
+        case FIELD_TYPE_S32:      return *(const s32*)addr;
+        case FIELD_TYPE_FLOAT:    return *(const float*)addr;
+        case FIELD_TYPE_DOUBLE:   return *(const double*)addr;
+        default:                  return 0.0;
+    }
+}
+
+/**
+ * @brief 按路径读取数值字段（每次调用都解析路径）
+ * @note 用户请使用 STRUCT_GET 宏；频繁读取时用 STRUCT_FIELD_REF 缓存句柄
+ */
+static inline double struct_get(const void* struct_data, const StructDescriptor* desc, const char* path) {
+    StructFieldRef ref = struct_field_ref(desc, path);
+    return struct_field_get(struct_data, &ref);
+}
+
+/**
+ * @brief 输出单个字段
+ * @param sink 输出缓冲区
+ * @param label 显示名称（如 "status.device.temperature"）
+ * @param struct_data 根结构体数据指针
+ * @param ref 字段句柄
+ *
+ * @note 数值字段输出一行 "label = value"；字符串加引号；数组输出 [a, b, ...]；
+ *       嵌套结构体与 STRUCT_PRINT 格式相同，结构体数组以表格输出
+ */
+static inline void struct_print_field_ref_to(StructPrintSink* sink, const char* label, const void* struct_data,
+                                             const StructFieldRef* ref) {
+    const FieldDescriptor* field = ref->field;
+    const u8* data = (const u8*)struct_data + ref->offset;
+    FieldType type = (field->type == FIELD_TYPE_STRING) ? FIELD_TYPE_U8 : field->type;
+    
+    if (field->type == FIELD_TYPE_STRUCT && field->nested_desc == NULL) {
+        sink_puts(sink, label);
+        sink_puts(sink, " = {...}");       /* 没有嵌套描述符，无法展开 */
+        sink_endline(sink);
+        return;
+    }
+    if (field->type == FIELD_TYPE_STRUCT) {
+        StructPrintContext ctx;
+        
+        if (ref->count > 0) {
+            struct_print_table_rows(sink, data, ref->count, 0, field->nested_desc, 0, STRUCT_PRINT_INDENT_SPACES);
+        } else {
+            struct_print_context_init(&ctx, sink);
+            struct_print_internal(&ctx, label, data, field->nested_desc, 0);
+        }
+        return;
+    }
+    
+    sink_puts(sink, label);
+    sink_puts(sink, " = ");
+    if (ref->count > 0 && field_is_string(field, data)) {
+        print_quoted_string(sink, data, ref->count);
+    } else if (ref->count > 0) {
+        size_t i;
+        
+        sink_putc(sink, '[');
+        for (i = 0; i < ref->count; i++) {
+            if (i > 0) sink_puts(sink, ", ");
+            print_scalar(sink, type, data + i * field->size);
+        }
+        sink_putc(sink, ']');
+    } else {
+        print_scalar(sink, type, data);
+    }
+    sink_endline(sink);
+}
+
+/**
+ * @brief 按路径打印单个字段到指定输出缓冲区
+ * @param sink 输出缓冲区
+ * @param var_name 变量名
+ * @param struct_data 结构体数据指针
+ * @param desc 结构体描述符
+ * @param path 字段路径
+ * @return 0 成功，-1 路径无效（输出一行错误信息）
+ *
+ * @note 只格式化该字段，不遍历其他字段
+ */
+static inline int struct_print_field_to(StructPrintSink* sink, const char* var_name, const void* struct_data,
+                                        const StructDescriptor* desc, const char* path) {
+    StructFieldRef ref = struct_field_ref(desc, path);
+    StructPrintPath label;
+    
+    struct_path_reset(&label);
+    struct_path_push(&label, var_name, 0);
+    struct_path_push(&label, path, 1);
+    
+    if (struct_data == NULL || ref.field == NULL) {
+        sink_puts(sink, label.buf);
+        sink_puts(sink, ": Error: field not found!");
+        sink_endline(sink);
+        struct_print_sink_flush(sink);
+        return -1;
+    }
+    struct_print_field_ref_to(sink, label.buf, struct_data, &ref);
+    struct_print_sink_flush(sink);
+    return 0;
+}
+
+/**
+ * @brief 按路径打印单个字段（使用 STRUCT_PRINT_PRINTF）
+ * @note 用户请使用 STRUCT_PRINT_FIELD 宏
+ */
+static inline int struct_print_field(const char* var_name, const void* struct_data,
+                                     const StructDescriptor* desc, const char* path) {
+    char buf[STRUCT_PRINT_OUT_BUF_SIZE];
+    StructPrintSink sink;
+    int locked;
+    int result;
+    
+    struct_print_out_begin(&sink, buf, sizeof(buf), &locked);
+    result = struct_print_field_to(&sink, var_name, struct_data, desc, path);
+    struct_print_out_end(&sink, &locked);
+    return result;
+}
+
+/* ============================================================================
+ *                    路径索引（"类型.路径" 散列表）
+ * ============================================================================ */
+
+/**
+ * @brief 路径索引项
+ */
+typedef struct {
+    u32 hash;                                   /**< "Type.a.b" 的 FNV-1a 哈希 */
+    const StructDescriptor* root;               /**< 根结构体（NULL 为空槽）*/
+    const FieldDescriptor* field;               /**< 叶子字段（NULL 表示哈希冲突，需逐级解析）*/
+    size_t offset;                              /**< 相对根结构体的偏移 */
+    size_t parent;                              /**< 上一级路径的槽号 + 1（0 表示根结构体的直接字段）*/
+} StructPathEntry;
+
+/**
+ * @brief 路径索引：为注册表中每个类型的每条字段路径预先计算偏移
+ * @note 嵌套结构体逐级展开；结构体数组不展开（带下标的路径回退到 struct_field_resolve）
+ * @note 查找只计算一次哈希；命中后沿 parent 逐级比较字段名和类型名（不在描述符中搜索字段），
+ *       哈希相同但路径不同的输入不会命中
+ */
+typedef struct {
+    StructPathEntry* entries;                   /**< 槽数组（调用者提供）*/
+    size_t mask;                                /**< 槽数 - 1（槽数为 2 的幂）*/
+    size_t count;                               /**< 已索引的路径数 */
+    const StructRegistry* registry;             /**< 回退查找使用的注册表 */
+} StructPathIndex;
+
+/**
+ * @brief 定义静态存储的路径索引
+ * @param name 索引变量名
+ * @param capacity 槽数（必须为 2 的幂，建议不少于路径总数的 2 倍）
+ */
+#define STRUCT_PATH_INDEX_DEFINE(name, capacity) \
+    static StructPathEntry name##_entries_[capacity]; \
+    static StructPathIndex name = { name##_entries_, (capacity) - 1, 0, NULL }
+
+/**
+ * @brief FNV-1a 累加字符串（不含结尾 '\0'，可逐段拼接 "Type" "." "a" "." "b"）
+ */
+static inline u32 path_hash_add(u32 hash, const char* p) {
+    while (*p != '\0') {
+        hash ^= (u8)*p++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief 插入一条路径（同一哈希出现两次时标记为冲突）
+ * @param parent 上一级路径的槽号 + 1（0 表示直接字段）
+ * @param slot 返回该路径所在的槽号 + 1（作为下一级路径的 parent）
+ * @return 0 成功，-1 索引已满
+ */
+static inline int path_index_insert(StructPathIndex* index, u32 hash, const StructDescriptor* root,
+                                    const FieldDescriptor* field, size_t offset, size_t parent, size_t* slot) {
+    size_t i = hash & index->mask;
+    size_t probes;
+    
+    if (index->count >= index->mask) return -1;
+    for (probes = 0; probes <= index->mask; probes++) {
+        StructPathEntry* entry = &index->entries[i];
+        
+        *slot = i + 1;
+        if (entry->root == NULL) {
+            entry->hash = hash;
+            entry->root = root;
+            entry->field = field;
+            entry->offset = offset;
+            entry->parent = parent;
+            index->count++;
+            return 0;
+        }
+        if (entry->hash == hash) {
+            entry->field = NULL;        /* 经过此槽的下一级路径也无法校验，回退到逐级解析 */
+            return 0;
+        }
+        i = (i + 1) & index->mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief 递归索引一个结构体的所有字段
+ */
+static inline int path_index_walk(StructPathIndex* index, const StructDescriptor* root, const StructDescriptor* desc,
+                                  u32 prefix_hash, size_t base, size_t parent, int depth) {
+    size_t i;
+    
+    for (i = 0; i < desc->field_count; i++) {
+        const FieldDescriptor* field = &desc->fields[i];
+        u32 hash = path_hash_add(path_hash_add(prefix_hash, "."), field->name);
+        size_t slot;
+        
+        if (path_index_insert(index, hash, root, field, base + field->offset, parent, &slot) != 0) return -1;
+        if (field->type == FIELD_TYPE_STRUCT && field->nested_desc != NULL && field->array_count == 0 &&
+            depth < STRUCT_PRINT_PATH_MAX) {
+            if (path_index_walk(index, root, field->nested_desc, hash, base + field->offset, slot, depth + 1) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 为注册表中的所有类型建立路径索引
+ * @param index 路径索引（槽数组已由 STRUCT_PATH_INDEX_DEFINE 或调用者提供）
+ * @param registry 描述符注册表
+ * @return 0 成功；-1 槽数不足（已插入的路径仍可使用，其余回退到逐级解析）
+ *
+ * @note 注册表新增类型后需要重新调用
+ */
+static inline int struct_path_index_build(StructPathIndex* index, const StructRegistry* registry) {
+    const StructDescriptor* desc;
+    size_t pos = 0;
+    
+    memset(index->entries, 0, (index->mask + 1) * sizeof(StructPathEntry));
+    index->count = 0;
+    index->registry = registry;
+    
+    while ((desc = struct_registry_next(registry, &pos)) != NULL) {
+        if (path_index_walk(index, desc, desc, path_hash_add(2166136261u, desc->struct_name), 0, 0, 0) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief 校验命中的索引项确实是 "类型.路径"：从叶子沿 parent 逐段比较
+ * @return 1 匹配，0 不匹配（或经过冲突的槽）
+ */
+static inline int path_index_match(const StructPathIndex* index, const StructPathEntry* entry,
+                                   const char* type, const char* path) {
+    const char* end = path + strlen(path);
+    
+    for (;;) {
+        const char* seg = end;
+        size_t len;
+        
+        if (entry->field == NULL) return 0;
+        while (seg > path && seg[-1] != '.') seg--;
+        len = (size_t)(end - seg);
+        if (strncmp(entry->field->name, seg, len) != 0 || entry->field->name[len] != '\0') return 0;
+        if (entry->parent == 0) {
+            return seg == path && strcmp(entry->root->struct_name, type) == 0;
+        }
+        if (seg == path) return 0;
+        end = seg - 1;
+        entry = &index->entries[entry->parent - 1];
+    }
+}
+
+/**
+ * @brief 按 "类型" + "路径" 查找字段
+ * @param index 路径索引
+ * @param type 结构体名称
+ * @param path 字段路径（可带数组下标）
+ * @param ref 解析结果
+ * @return 根结构体描述符；类型或字段不存在返回 NULL
+ *
+ * @note 不带下标的路径直接命中索引；带下标、冲突或未索引的路径回退到注册表 + struct_field_resolve
+ */
+static inline const StructDescriptor* struct_path_index_find(const StructPathIndex* index, const char* type,
+                                                             const char* path, StructFieldRef* ref) {
+    const StructDescriptor* root;
+    
+    if (strchr(path, '[') == NULL) {
+        u32 hash = path_hash_add(path_hash_add(path_hash_add(2166136261u, type), "."), path);
+        size_t i = hash & index->mask;
+        size_t probes;
+        
+        for (probes = 0; probes <= index->mask && index->entries[i].root != NULL; probes++) {
+            const StructPathEntry* entry = &index->entries[i];
+            
+            if (entry->hash == hash) {
+                if (!path_index_match(index, entry, type, path)) break;
+                ref->field = entry->field;
+                ref->offset = entry->offset;
+                ref->count = entry->field->array_count;
+                ref->size = entry->field->size * (ref->count > 0 ? ref->count : 1);
+                return entry->root;
+            }
+            i = (i + 1) & index->mask;
+        }
+    }
+    
+    if (index->registry == NULL) return NULL;
+    root = struct_registry_find_name(index->registry, type);
+    if (root == NULL || struct_field_resolve(root, path, ref) != 0) return NULL;
+    return root;
+}
+
+/* ============================================================================
+ *                    检查 Shell（STRUCT_SHELL）
+ * ============================================================================
+ *
+ * 从调用者提供的字节流（串口、RTT、USB CDC、Linux 上的 pty/管道）读取命令：
+ *   list                         列出已注册的类型和符号
+ *   print <type> <addr>          打印地址处的结构体
+ *   get <type>.<path> [addr]     不带地址：显示字段的类型、偏移、大小；带地址：显示字段值
+ *   watch <type> <addr> <hz>     以 hz 频率采样，有变化时输出（有影子缓冲区时只输出变化的字段）
+ *   watch off                    停止监视
+ *   hex <addr> <len>             十六进制转储
+ *   help                         命令列表
+ * 地址可写成 0x 十六进制、十进制，或 struct_shell_set_symbols 注册的符号名。
+ *
+ * @note Shell 按用户给出的地址直接读内存，请用 STRUCT_SHELL_ADDR_VALID 限制可访问的范围
+ */
+
+/* 命令行最大长度（超出部分丢弃，整行报错）*/
+#ifndef STRUCT_SHELL_LINE_MAX
+#define STRUCT_SHELL_LINE_MAX           96
+#endif
+
+/* 提示符（每条命令执行完后输出，设为 "" 关闭）*/
+#ifndef STRUCT_SHELL_PROMPT
+#define STRUCT_SHELL_PROMPT             "> "
+#endif
+
+/* hex 命令单次最多转储的字节数 */
+#ifndef STRUCT_SHELL_HEX_MAX
+#define STRUCT_SHELL_HEX_MAX            1024
+#endif
+
+/**
+ * @brief 地址检查钩子：返回 0 时拒绝访问
+ * @note 默认允许任意地址；量产设备上建议限制在 RAM 范围内
+ * @note 调用前 Shell 已拒绝地址 0 和 addr + len 回绕的区间；钩子中仍应避免计算 addr + len，
+ *       用 len 与剩余空间比较
+ *
+ * @example
+ * #define STRUCT_SHELL_ADDR_VALID(addr, len) \
+ *     ((addr) >= 0x20000000u && (addr) <= 0x20020000u && (len) <= 0x20020000u - (addr))
+ */
+#ifndef STRUCT_SHELL_ADDR_VALID
+#define STRUCT_SHELL_ADDR_VALID(addr, len) 1
+#endif
+
+/**
+ * @brief 配置 watch 命令使用的毫秒时间函数（默认与 STRUCT_WATCH 相同）
+ */
+#ifndef STRUCT_SHELL_TIME_MS
+#define STRUCT_SHELL_TIME_MS() STRUCT_WATCH_TIME_MS()
 #endif
+
+/**
+ * @brief 符号：可在命令中代替地址使用的名称
+ */
+typedef struct {
+    const char* name;                           /**< 符号名 */
+    const void* addr;                           /**< 地址 */
+} StructShellSymbol;
+
+/**
+ * @brief Shell 状态
+ */
+typedef struct {
+    const StructRegistry* registry;             /**< 描述符注册表 */
+    const StructPathIndex* index;               /**< 路径索引（可为 NULL，逐级解析）*/
+    StructPrintSink* sink;                      /**< 输出 */
+    const StructShellSymbol* symbols;           /**< 符号表（可为 NULL）*/
+    size_t symbol_count;                        /**< 符号个数 */
+    char line[STRUCT_SHELL_LINE_MAX];           /**< 当前输入行 */
+    size_t line_len;                            /**< 当前输入行长度 */
+    u8 overflow;                                /**< 当前行超长 */
+    u8 last_cr;                                 /**< 上一个字节是 '\r'（"\r\n" 只执行一次）*/
+    const StructDescriptor* watch_desc;         /**< 监视的类型（NULL 表示未监视）*/
+    const void* watch_addr;                     /**< 监视的地址 */
+    u32 watch_period_ms;                        /**< 采样周期 */
+    u32 watch_next_ms;                          /**< 下次采样时间 */
+    StructWatch watch;                          /**< 变化检测状态 */
+    char watch_name[24];                        /**< 监视对象显示名称 */
+} StructShell;
+
+/**
+ * @brief 初始化 Shell
+ * @param shell Shell 状态
+ * @param registry 描述符注册表
+ * @param index 路径索引（可为 NULL）
+ * @param sink 输出缓冲区（建议 STRUCT_PRINT_SINK_FLUSH_LINE）
+ */
+static inline void struct_shell_init(StructShell* shell, const StructRegistry* registry,
+                                     const StructPathIndex* index, StructPrintSink* sink) {
+    memset(shell, 0, sizeof(*shell));
+    shell->registry = registry;
+    shell->index = index;
+    shell->sink = sink;
 }
 
 /**
- * @brief 打印单个字段的值
- * @param field 字段描述符
- * @param struct_base 结构体基地址
- * @param indent_level 缩进层级
+ * @brief 设置符号表
  */
-static void print_field_value(const FieldDescriptor* field, const void* struct_base, int indent_level);
+static inline void struct_shell_set_symbols(StructShell* shell, const StructShellSymbol* symbols, size_t count) {
+    shell->symbols = symbols;
+    shell->symbol_count = count;
+}
 
 /**
- * @brief 打印结构体（递归）
- * @param var_name 变量名
- * @param struct_data 结构体数据指针
- * @param desc 结构体描述符
- * @param indent_level 缩进层级
+ * @brief 设置 watch 命令的影子缓冲区（可选，大小不小于被监视的结构体时只输出变化的字段）
  */
-static void struct_print_internal(const char* var_name, const void* struct_data, 
-                                   const StructDescriptor* desc, int indent_level) {
-    size_t i;
-    
-    if (struct_data == NULL || desc == NULL) {
-        STRUCT_PRINT_PRINTF("Error: NULL pointer!\n");
+static inline void struct_shell_set_watch_buffer(StructShell* shell, void* buffer, size_t size) {
+    shell->watch.shadow = buffer;
+    shell->watch.shadow_size = size;
+}
+
+/**
+ * @brief 输出完整宽度的地址（64 位主机上高位不截断）
+ */
+static inline void shell_put_addr(StructPrintSink* sink, uintptr_t addr) {
+    sink_puts(sink, "0x");
+#if UINTPTR_MAX > 0xFFFFFFFFu
+    if ((addr >> 32) != 0) {
+        sink_put_hex(sink, (u32)(addr >> 32), 1);
+        sink_put_hex(sink, (u32)addr, 8);
         return;
     }
+#endif
+    sink_put_hex(sink, (u32)addr, 8);
+}
+
+/**
+ * @brief 解析无符号数（0x 十六进制或十进制）
+ * @return 0 成功，-1 格式错误或超出 uintptr_t 范围
+ */
+static inline int shell_parse_uint(const char* text, uintptr_t* value) {
+    uintptr_t v = 0;
+    int base = 10;
     
-    /* 打印结构体头部信息 */
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("========================================\n");
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    if (*text == '\0') return -1;
+    for (; *text != '\0'; text++) {
+        int digit;
+        
+        if (*text >= '0' && *text <= '9') digit = *text - '0';
+        else if (base == 16 && *text >= 'a' && *text <= 'f') digit = *text - 'a' + 10;
+        else if (base == 16 && *text >= 'A' && *text <= 'F') digit = *text - 'A' + 10;
+        else return -1;
+        if (v > (UINTPTR_MAX - (uintptr_t)digit) / (uintptr_t)base) return -1;
+        v = v * (uintptr_t)base + (uintptr_t)digit;
+    }
+    *value = v;
+    return 0;
+}
+
+/**
+ * @brief 解析地址：符号名或数值
+ */
+static inline int shell_parse_addr(const StructShell* shell, const char* text, uintptr_t* addr) {
+    size_t i;
     
-    print_indent(indent_level);
-    if (var_name != NULL && var_name[0] != '\0') {
-        STRUCT_PRINT_PRINTF("Struct: %s [%s]\n", var_name, desc->struct_name);
-    } else {
-        STRUCT_PRINT_PRINTF("Struct: [%s]\n", desc->struct_name);
+    for (i = 0; i < shell->symbol_count; i++) {
+        if (strcmp(shell->symbols[i].name, text) == 0) {
+            *addr = (uintptr_t)shell->symbols[i].addr;
+            return 0;
+        }
+    }
+    return shell_parse_uint(text, addr);
+}
+
+/**
+ * @brief 检查 [addr, addr + len) 可以访问：非空、不回绕，并通过 STRUCT_SHELL_ADDR_VALID
+ */
+static inline int shell_addr_ok(uintptr_t addr, uintptr_t len) {
+    return addr != 0 && len <= UINTPTR_MAX - addr && STRUCT_SHELL_ADDR_VALID(addr, len);
+}
+
+/**
+ * @brief 输出一行错误信息
+ */
+static inline void shell_error(StructPrintSink* sink, const char* message, const char* arg) {
+    sink_puts(sink, "error: ");
+    sink_puts(sink, message);
+    if (arg != NULL) {
+        sink_puts(sink, " '");
+        sink_puts(sink, arg);
+        sink_putc(sink, '\'');
     }
+    sink_endline(sink);
+}
+
+/**
+ * @brief 解析 "<type> <addr>" 参数
+ * @return 描述符；出错时已输出错误信息并返回 NULL
+ */
+static inline const StructDescriptor* shell_type_at(StructShell* shell, const char* type, const char* addr_text,
+                                                    uintptr_t* addr) {
+    const StructDescriptor* desc;
     
-#if STRUCT_PRINT_SHOW_ADDRESS
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("Address: 0x%08X\n", (unsigned int)(uintptr_t)struct_data);
-#endif
+    if (type == NULL || addr_text == NULL) {
+        shell_error(shell->sink, "missing argument", NULL);
+        return NULL;
+    }
+    desc = struct_registry_find_name(shell->registry, type);
+    if (desc == NULL) {
+        shell_error(shell->sink, "unknown type", type);
+        return NULL;
+    }
+    if (shell_parse_addr(shell, addr_text, addr) != 0) {
+        shell_error(shell->sink, "bad address", addr_text);
+        return NULL;
+    }
+    if (!shell_addr_ok(*addr, desc->struct_size)) {
+        shell_error(shell->sink, "address not accessible", addr_text);
+        return NULL;
+    }
+    return desc;
+}
+
+/**
+ * @brief list：类型与符号
+ */
+static inline void shell_cmd_list(StructShell* shell) {
+    StructPrintSink* sink = shell->sink;
+    const StructDescriptor* desc;
+    size_t pos = 0;
+    size_t i;
     
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("Size: %u bytes\n", (unsigned int)desc->struct_size);
+    while ((desc = struct_registry_next(shell->registry, &pos)) != NULL) {
+        sink_puts(sink, desc->struct_name);
+        sink_puts(sink, " size=");
+        sink_put_u32(sink, (u32)desc->struct_size);
+        sink_puts(sink, " fields=");
+        sink_put_u32(sink, (u32)desc->field_count);
+        sink_puts(sink, " id=0x");
+        sink_put_hex(sink, struct_desc_id(desc), 8);
+        sink_endline(sink);
+    }
+    for (i = 0; i < shell->symbol_count; i++) {
+        sink_puts(sink, shell->symbols[i].name);
+        sink_puts(sink, " = ");
+        shell_put_addr(sink, (uintptr_t)shell->symbols[i].addr);
+        sink_endline(sink);
+    }
+}
+
+/**
+ * @brief get：字段信息或字段值
+ */
+static inline void shell_cmd_get(StructShell* shell, char* type_path, const char* addr_text) {
+    StructPrintSink* sink = shell->sink;
+    char* dot = strchr(type_path, '.');
+    const StructDescriptor* root;
+    const FieldDescriptor* field;
+    StructFieldRef ref;
+    uintptr_t addr;
     
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("========================================\n");
+    if (dot == NULL) {
+        shell_error(sink, "expected <type>.<path>", type_path);
+        return;
+    }
+    *dot = '\0';
+    root = (shell->index != NULL) ? struct_path_index_find(shell->index, type_path, dot + 1, &ref)
+         : struct_registry_find_name(shell->registry, type_path);
+    if (root != NULL && shell->index == NULL && struct_field_resolve(root, dot + 1, &ref) != 0) {
+        root = NULL;
+    }
+    *dot = '.';
+    if (root == NULL) {
+        shell_error(sink, "unknown field", type_path);
+        return;
+    }
+    field = ref.field;
     
-    /* 打印每个字段 */
-    for (i = 0; i < desc->field_count; i++) {
-        const FieldDescriptor* field = &desc->fields[i];
-        
-        print_indent(indent_level);
-        
-#if STRUCT_PRINT_SHOW_OFFSET
-        STRUCT_PRINT_PRINTF("  [+0x%04X] ", (unsigned int)field->offset);
-#else
-        STRUCT_PRINT_PRINTF("  ");
-#endif
-        
-        STRUCT_PRINT_PRINTF("%s: ", field->name);
-        
-        /* 打印字段值 */
-        print_field_value(field, struct_data, indent_level);
-        
-        /* 字段之间空行（嵌套结构体除外） */
-        if (field->type != FIELD_TYPE_STRUCT && i < desc->field_count - 1) {
-            STRUCT_PRINT_PRINTF("\n");
+    if (addr_text == NULL) {
+        sink_puts(sink, type_path);
+        sink_puts(sink, ": ");
+        if (field->type == FIELD_TYPE_STRUCT && field->nested_desc != NULL) {
+            sink_puts(sink, field->nested_desc->struct_name);
+        } else {
+            sink_puts(sink, field_type_name((field->type == FIELD_TYPE_STRING && ref.count == 0) ? FIELD_TYPE_U8 : field->type));
+        }
+        if (ref.count > 0) {
+            sink_putc(sink, '[');
+            sink_put_u32(sink, (u32)ref.count);
+            sink_putc(sink, ']');
         }
+        sink_puts(sink, " offset=0x");
+        sink_put_hex(sink, (u32)ref.offset, 4);
+        sink_puts(sink, " size=");
+        sink_put_u32(sink, (u32)ref.size);
+        sink_endline(sink);
+        return;
     }
     
-    print_indent(indent_level);
-    STRUCT_PRINT_PRINTF("========================================\n");
+    if (shell_parse_addr(shell, addr_text, &addr) != 0) {
+        shell_error(sink, "bad address", addr_text);
+        return;
+    }
+    if (addr == 0 || ref.offset > UINTPTR_MAX - addr || !shell_addr_ok(addr + ref.offset, ref.size)) {
+        shell_error(sink, "address not accessible", addr_text);
+        return;
+    }
+    struct_print_field_ref_to(sink, type_path, (const void*)addr, &ref);
 }
 
 /**
- * @brief 打印单个字段的值（实现）
- * @param field 字段描述符
- * @param struct_base 结构体基地址
- * @param indent_level 缩进层级
+ * @brief hex：每行 16 字节，附 ASCII
  */
-static void print_field_value(const FieldDescriptor* field, const void* struct_base, int indent_level) {
-    const void* field_addr = (const u8*)struct_base + field->offset;
-    size_t i;
+static inline void shell_cmd_hex(StructShell* shell, const char* addr_text, const char* len_text) {
+    StructPrintSink* sink = shell->sink;
+    uintptr_t addr, len, i, j;
     
-    /* 处理数组类型 */
-    if (field->array_count > 0 && field->type != FIELD_TYPE_STRUCT) {
-        /* 字符串类型 */
-        if (field->type == FIELD_TYPE_STRING || 
-            (field->type == FIELD_TYPE_U8 && is_printable_string((const u8*)field_addr, field->array_count))) {
-            STRUCT_PRINT_PRINTF("\"%s\"\n", (const char*)field_addr);
-            print_hex_memory((const u8*)field_addr, field->array_count, STRUCT_PRINT_HEX_BYTES, indent_level);
-        }
-        /* 数值数组 */
-        else {
-            STRUCT_PRINT_PRINTF("[");
-            size_t max_show = (field->array_count > 16) ? 16 : field->array_count;
-            
-            for (i = 0; i < max_show; i++) {
-                const u8* elem_addr = (const u8*)field_addr + i * field->size;
-                
-                switch (field->type) {
-                    case FIELD_TYPE_U8:
-                        STRUCT_PRINT_PRINTF("%u", *(const u8*)elem_addr);
-                        break;
-                    case FIELD_TYPE_U16:
-                        STRUCT_PRINT_PRINTF("%u", *(const u16*)elem_addr);
-                        break;
-                    case FIELD_TYPE_U32:
-                        STRUCT_PRINT_PRINTF("%u", (unsigned int)*(const u32*)elem_addr);
-                        break;
-                    case FIELD_TYPE_S8:
-                        STRUCT_PRINT_PRINTF("%d", *(const s8*)elem_addr);
-                        break;
-                    case FIELD_TYPE_S16:
-                        STRUCT_PRINT_PRINTF("%d", *(const s16*)elem_addr);
-                        break;
-                    case FIELD_TYPE_S32:
-                        STRUCT_PRINT_PRINTF("%d", (int)*(const s32*)elem_addr);
-                        break;
-                    default:
-                        STRUCT_PRINT_PRINTF("?");
-                        break;
-                }
-                
-                if (i < max_show - 1) {
-                    STRUCT_PRINT_PRINTF(", ");
-                }
-            }
-            
-            if (field->array_count > max_show) {
-                STRUCT_PRINT_PRINTF(", ...");
+    if (addr_text == NULL || len_text == NULL) {
+        shell_error(sink, "missing argument", NULL);
+        return;
+    }
+    if (shell_parse_addr(shell, addr_text, &addr) != 0 || shell_parse_uint(len_text, &len) != 0) {
+        shell_error(sink, "bad argument", NULL);
+        return;
+    }
+    if (len > STRUCT_SHELL_HEX_MAX) len = STRUCT_SHELL_HEX_MAX;
+    if (!shell_addr_ok(addr, len)) {
+        shell_error(sink, "address not accessible", addr_text);
+        return;
+    }
+    
+    for (i = 0; i < len; i += 16) {
+        const u8* row = (const u8*)addr + i;
+        uintptr_t n = (len - i < 16) ? len - i : 16;
+        
+        shell_put_addr(sink, addr + i);
+        sink_putc(sink, ':');
+        for (j = 0; j < 16; j++) {
+            if (j < n) {
+                sink_putc(sink, ' ');
+                sink_put_hex(sink, row[j], 2);
+            } else {
+                sink_puts(sink, "   ");
             }
-            
-            STRUCT_PRINT_PRINTF("]\n");
-            print_hex_memory((const u8*)field_addr, field->array_count * field->size, STRUCT_PRINT_HEX_BYTES, indent_level);
         }
+        sink_puts(sink, "  |");
+        for (j = 0; j < n; j++) {
+            sink_putc(sink, (row[j] >= 0x20 && row[j] < 0x7F) ? (char)row[j] : '.');
+        }
+        sink_putc(sink, '|');
+        sink_endline(sink);
+    }
+}
+
+/**
+ * @brief watch：设置或停止监视
+ */
+static inline void shell_cmd_watch(StructShell* shell, const char* type, const char* addr_text, const char* hz_text) {
+    const StructDescriptor* desc;
+    uintptr_t addr, hz;
+    size_t len;
+    
+    if (type == NULL || strcmp(type, "off") == 0) {
+        shell->watch_desc = NULL;
+        sink_puts(shell->sink, "watch off");
+        sink_endline(shell->sink);
+        return;
+    }
+    desc = shell_type_at(shell, type, addr_text, &addr);
+    if (desc == NULL) return;
+    if (hz_text == NULL || shell_parse_uint(hz_text, &hz) != 0 || hz == 0 || hz > 1000) {
+        shell_error(shell->sink, "bad rate (1~1000 Hz)", hz_text);
         return;
     }
     
-    /* 处理单一值类型 */
-    switch (field->type) {
-        case FIELD_TYPE_U8:
-            STRUCT_PRINT_PRINTF("%u (0x%02X)\n", *(const u8*)field_addr, *(const u8*)field_addr);
-            print_hex_memory((const u8*)field_addr, 1, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_U16:
-            STRUCT_PRINT_PRINTF("%u (0x%04X)\n", *(const u16*)field_addr, *(const u16*)field_addr);
-            print_hex_memory((const u8*)field_addr, 2, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_U32:
-            STRUCT_PRINT_PRINTF("%u (0x%08X)\n", (unsigned int)*(const u32*)field_addr, (unsigned int)*(const u32*)field_addr);
-            print_hex_memory((const u8*)field_addr, 4, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_S8:
-            STRUCT_PRINT_PRINTF("%d (0x%02X)\n", *(const s8*)field_addr, *(const u8*)field_addr);
-            print_hex_memory((const u8*)field_addr, 1, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_S16:
-            STRUCT_PRINT_PRINTF("%d (0x%04X)\n", *(const s16*)field_addr, *(const u16*)field_addr);
-            print_hex_memory((const u8*)field_addr, 2, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_S32:
-            STRUCT_PRINT_PRINTF("%d (0x%08X)\n", (int)*(const s32*)field_addr, (unsigned int)*(const u32*)field_addr);
-            print_hex_memory((const u8*)field_addr, 4, STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-            
-        case FIELD_TYPE_FLOAT: {
-            float val = *(const float*)field_addr;
-            STRUCT_PRINT_PRINTF("%.6f\n", val);
-            print_hex_memory((const u8*)field_addr, sizeof(float), STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
-        }
-            
-        case FIELD_TYPE_DOUBLE: {
-            double val = *(const double*)field_addr;
-            STRUCT_PRINT_PRINTF("%.6f\n", val);
-            print_hex_memory((const u8*)field_addr, sizeof(double), STRUCT_PRINT_HEX_BYTES, indent_level);
-            break;
+    len = strlen(addr_text);
+    if (len >= sizeof(shell->watch_name)) len = sizeof(shell->watch_name) - 1;
+    memcpy(shell->watch_name, addr_text, len);
+    shell->watch_name[len] = '\0';
+    
+    shell->watch_desc = desc;
+    shell->watch_addr = (const void*)addr;
+    shell->watch_period_ms = (u32)(1000u / hz);
+    shell->watch_next_ms = (u32)STRUCT_SHELL_TIME_MS();
+    shell->watch.valid = 0;
+}
+
+/**
+ * @brief 执行一条命令
+ * @param shell Shell 状态
+ * @param line 命令行（会被就地切分，执行后内容不再完整）
+ */
+static inline void struct_shell_exec(StructShell* shell, char* line) {
+    StructPrintSink* sink = shell->sink;
+    char* argv[5];
+    int argc = 0;
+    char* p = line;
+    
+    while (*p != '\0' && argc < 5) {
+        while (*p == ' ' || *p == '\t') *p++ = '\0';
+        if (*p == '\0') break;
+        argv[argc++] = p;
+        while (*p != '\0' && *p != ' ' && *p != '\t') p++;
+    }
+    while (argc < 5) argv[argc++] = NULL;
+    
+    if (argv[0] == NULL) {
+        /* 空行 */
+    } else if (strcmp(argv[0], "list") == 0) {
+        shell_cmd_list(shell);
+    } else if (strcmp(argv[0], "print") == 0) {
+        uintptr_t addr;
+        const StructDescriptor* desc = shell_type_at(shell, argv[1], argv[2], &addr);
+        if (desc != NULL) {
+            struct_print_to(sink, argv[2], (const void*)addr, desc);
         }
-            
-        case FIELD_TYPE_STRUCT:
-            if (field->nested_desc != NULL) {
-                STRUCT_PRINT_PRINTF("\n");
-                struct_print_internal("", field_addr, field->nested_desc, indent_level + 1);
+    } else if (strcmp(argv[0], "get") == 0 && argv[1] != NULL) {
+        shell_cmd_get(shell, argv[1], argv[2]);
+    } else if (strcmp(argv[0], "watch") == 0) {
+        shell_cmd_watch(shell, argv[1], argv[2], argv[3]);
+    } else if (strcmp(argv[0], "hex") == 0) {
+        shell_cmd_hex(shell, argv[1], argv[2]);
+    } else if (strcmp(argv[0], "help") == 0) {
+        sink_puts(sink, "list | print <type> <addr> | get <type>.<path> [addr] | watch <type> <addr> <hz> | watch off | hex <addr> <len>");
+        sink_endline(sink);
+    } else {
+        shell_error(sink, "unknown command", argv[0]);
+    }
+    sink_puts(sink, STRUCT_SHELL_PROMPT);
+    struct_print_sink_flush(sink);
+}
+
+/**
+ * @brief 输入字节流（可逐字节或整块调用）
+ * @param shell Shell 状态
+ * @param data 输入数据
+ * @param len 数据长度
+ *
+ * @note 遇到 '\r' 或 '\n' 执行一行；支持退格（0x08 / 0x7F）
+ */
+static inline void struct_shell_feed(StructShell* shell, const char* data, size_t len) {
+    size_t i;
+    
+    for (i = 0; i < len; i++) {
+        char c = data[i];
+        int was_cr = shell->last_cr;
+        
+        shell->last_cr = (c == '\r');
+        if (c == '\n' && was_cr) continue;
+        
+        if (c == '\r' || c == '\n') {
+            shell->line[shell->line_len] = '\0';
+            if (shell->overflow) {
+                shell_error(shell->sink, "line too long", NULL);
+                sink_puts(shell->sink, STRUCT_SHELL_PROMPT);
+                struct_print_sink_flush(shell->sink);
             } else {
-                STRUCT_PRINT_PRINTF("<nested struct, no descriptor>\n");
+                struct_shell_exec(shell, shell->line);
             }
-            break;
-            
-        default:
-            STRUCT_PRINT_PRINTF("<unknown type>\n");
-            break;
+            shell->line_len = 0;
+            shell->overflow = 0;
+        } else if (c == '\b' || c == 0x7F) {
+            if (shell->line_len > 0) shell->line_len--;
+        } else if (shell->line_len + 1 < sizeof(shell->line)) {
+            shell->line[shell->line_len++] = c;
+        } else {
+            shell->overflow = 1;
+        }
     }
 }
 
+/**
+ * @brief 周期调用：处理 watch 命令的采样
+ * @param shell Shell 状态
+ * @return 1 本次有输出，0 无输出
+ *
+ * @note 调用频率应不低于 watch 的采样频率（例如主循环或 1 ms 定时器中调用）
+ */
+static inline int struct_shell_poll(StructShell* shell) {
+    u32 now;
+    int printed;
+    
+    if (shell->watch_desc == NULL) return 0;
+    now = (u32)STRUCT_SHELL_TIME_MS();
+    if ((s32)(now - shell->watch_next_ms) < 0) return 0;
+    
+    shell->watch_next_ms += shell->watch_period_ms;
+    if ((s32)(now - shell->watch_next_ms) >= 0) {
+        shell->watch_next_ms = now + shell->watch_period_ms;   /* 调用间隔过长时不补采 */
+    }
+    printed = struct_watch_to(&shell->watch, shell->sink, shell->watch_name, shell->watch_addr, shell->watch_desc);
+    return printed > 0;
+}
 
 /* ============================================================================
- *                        用户API接口
+ *                    智能自动打印宏（兼容 C99/C11）
  * ============================================================================ */
 
-/**
- * @brief 打印结构体（内部函数）
- * @param var_name 变量名（字符串）
- * @param struct_data 结构体数据指针
- * @param desc 结构体描述符指针
- * 
- * @note 用户请使用 STRUCT_PRINT 宏，不要直接调用此函数
- */
-static inline void struct_print(const char* var_name, const void* struct_data, const StructDescriptor* desc) {
-    struct_print_internal(var_name, struct_data, desc, 0);
-}
+#if STRUCT_PRINT_HAS_CPP17
+
+/* 参数辅助宏：(var) 或 (var, type) */
+#define STRUCT_PRINT_EXPAND_(x) x
+#define STRUCT_PRINT_ARG1_(var, ...) var
+#define STRUCT_PRINT_NAME_(var, ...) #var
+#define STRUCT_PRINT_PICK_(a, b, m, ...) m
+#define STRUCT_PRINT_DESC_V_(var) GET_STRUCT_DESC(var)
+#define STRUCT_PRINT_DESC_T_(var, type) (&type##_desc)
+#define STRUCT_PRINT_DESC_(...) \
+    STRUCT_PRINT_EXPAND_(STRUCT_PRINT_PICK_(__VA_ARGS__, STRUCT_PRINT_DESC_T_, STRUCT_PRINT_DESC_V_, ~)(__VA_ARGS__))
+#define STRUCT_PRINT_VAR_(...) STRUCT_PRINT_ARG1_(__VA_ARGS__, ~)
+#define STRUCT_PRINT_VAR_NAME_(...) STRUCT_PRINT_NAME_(__VA_ARGS__, ~)
 
 /**
- * @brief 自动选择描述符的辅助宏（C11 版本）
- * @param var 变量
- * @return 对应类型的描述符指针
- * 
- * @note 此宏使用 C11 _Generic 实现类型到描述符的自动映射
- * @note 由描述符生成器自动生成，用户无需手动定义
- * 
- * @example 在生成的描述符文件中会包含类似定义：
- * #define GET_STRUCT_DESC(var) _Generic((var), \
- *     DeviceInfo: &DeviceInfo_desc, \
- *     SystemStatus: &SystemStatus_desc, \
- *     default: NULL \
- * )
+ * @brief 打印结构体的宏（C++17 版本）
+ * @note STRUCT_PRINT(var) 通过重载决议选择描述符，STRUCT_PRINT(var, type) 与 C99 写法相同
+ * @note 以下宏的最后一个参数 type 均可省略
  */
-#ifndef GET_STRUCT_DESC
-#define GET_STRUCT_DESC(var) NULL  /* 未定义时返回 NULL */
+#ifdef STRUCT_PRINT_CAPTURE_RING
+#define STRUCT_PRINT(...) \
+    ((void)struct_print_ring_push(&STRUCT_PRINT_CAPTURE_RING, STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                                  &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__)))
+#else
+#define STRUCT_PRINT(...) \
+    struct_print(STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
 #endif
 
-/* ============================================================================
- *                    智能自动打印宏（兼容 C99/C11）
- * ============================================================================ */
+#define STRUCT_PRINT_DIFF(old_var, ...) \
+    ((void)struct_print_diff(STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), &(old_var), \
+                             &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__)))
+
+#define STRUCT_WATCH(...) do { \
+    static union { u8 bytes[sizeof(STRUCT_PRINT_VAR_(__VA_ARGS__))]; double align_d; void* align_p; } sp_watch_shadow_; \
+    static StructWatch sp_watch_ = STRUCT_WATCH_INIT(&sp_watch_shadow_, sizeof(sp_watch_shadow_), STRUCT_WATCH_MAX_RATE); \
+    (void)struct_watch(&sp_watch_, STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                       &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__)); \
+} while (0)
+
+#define STRUCT_PRINT_CAPTURE(ring, ...) \
+    struct_print_ring_push((ring), STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                           &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+
+#if STRUCT_PRINT_POOL
+#define STRUCT_PRINT_ASYNC(pool, ...) \
+    struct_print_pool_submit((pool), STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                             &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+#endif
+
+#define STRUCT_PRINT_TO(sink, ...) \
+    struct_print_to((sink), STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                    &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+
+#define STRUCT_LOG(...) \
+    struct_log(STRUCT_PRINT_DESC_(__VA_ARGS__), &(STRUCT_PRINT_VAR_(__VA_ARGS__)))
+
+#define STRUCT_LOG_TO(sink, ...) \
+    struct_log_to((sink), STRUCT_PRINT_DESC_(__VA_ARGS__), &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_LOG_TIMESTAMP())
+
+/* STRUCT_PRINT_TABLE(arr, n) 或 STRUCT_PRINT_TABLE(arr, n, type) */
+#define STRUCT_PRINT_TABLE_DESC_V_(arr, n) GET_STRUCT_DESC((arr)[0])
+#define STRUCT_PRINT_TABLE_DESC_T_(arr, n, type) (&type##_desc)
+#define STRUCT_PRINT_TABLE(arr, ...) \
+    struct_print_table(#arr, (arr), (size_t)(STRUCT_PRINT_VAR_(__VA_ARGS__)), 0, \
+                       STRUCT_PRINT_EXPAND_(STRUCT_PRINT_PICK_(__VA_ARGS__, STRUCT_PRINT_TABLE_DESC_T_, \
+                                                               STRUCT_PRINT_TABLE_DESC_V_, ~)(arr, __VA_ARGS__)))
+
+/* STRUCT_PRINT_BATCH(arr, n) 或 STRUCT_PRINT_BATCH(arr, n, type) */
+#define STRUCT_PRINT_BATCH(arr, ...) \
+    struct_print_batch(#arr, (arr), sizeof((arr)[0]), (size_t)(STRUCT_PRINT_VAR_(__VA_ARGS__)), \
+                       STRUCT_PRINT_EXPAND_(STRUCT_PRINT_PICK_(__VA_ARGS__, STRUCT_PRINT_TABLE_DESC_T_, \
+                                                               STRUCT_PRINT_TABLE_DESC_V_, ~)(arr, __VA_ARGS__)))
+
+#define STRUCT_PRINT_JSON(...) \
+    struct_print_json(STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
 
-#if STRUCT_PRINT_HAS_GENERIC
+#define STRUCT_PRINT_COMPACT(...) \
+    struct_print_compact(&(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+
+#define STRUCT_PRINT_COMPACT_TO(sink, ...) \
+    struct_print_compact_to((sink), &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+
+#define STRUCT_PRINT_JSON_TO(sink, ...) \
+    struct_print_json_to((sink), STRUCT_PRINT_VAR_NAME_(__VA_ARGS__), \
+                         &(STRUCT_PRINT_VAR_(__VA_ARGS__)), STRUCT_PRINT_DESC_(__VA_ARGS__))
+
+#define STRUCT_CBOR_TO(session, sink, ...) \
+    struct_cbor_to((session), (sink), STRUCT_PRINT_DESC_(__VA_ARGS__), &(STRUCT_PRINT_VAR_(__VA_ARGS__)))
+
+/* STRUCT_GET(var, path) 或 STRUCT_GET(var, path, type)；STRUCT_FIELD_REF / STRUCT_PRINT_FIELD / STRUCT_PRINT_FILTERED /
+ * STRUCT_PRINT_WITH 同理 */
+#define STRUCT_FIELD_DESC_V_(var, path) GET_STRUCT_DESC(var)
+#define STRUCT_FIELD_DESC_T_(var, path, type) (&type##_desc)
+#define STRUCT_FIELD_DESC_(var, ...) \
+    STRUCT_PRINT_EXPAND_(STRUCT_PRINT_PICK_(__VA_ARGS__, STRUCT_FIELD_DESC_T_, STRUCT_FIELD_DESC_V_, ~)(var, __VA_ARGS__))
+
+#define STRUCT_GET(var, ...) \
+    struct_get(&(var), STRUCT_FIELD_DESC_(var, __VA_ARGS__), STRUCT_PRINT_VAR_(__VA_ARGS__))
+
+#define STRUCT_FIELD_REF(var, ...) \
+    struct_field_ref(STRUCT_FIELD_DESC_(var, __VA_ARGS__), STRUCT_PRINT_VAR_(__VA_ARGS__))
+
+#define STRUCT_PRINT_FIELD(var, ...) \
+    struct_print_field(#var, &(var), STRUCT_FIELD_DESC_(var, __VA_ARGS__), STRUCT_PRINT_VAR_(__VA_ARGS__))
+
+#define STRUCT_PRINT_FILTERED(var, ...) \
+    struct_print_filtered(#var, &(var), STRUCT_FIELD_DESC_(var, __VA_ARGS__), STRUCT_PRINT_VAR_(__VA_ARGS__))
+
+#define STRUCT_PRINT_WITH(var, ...) \
+    struct_print_options(#var, &(var), STRUCT_FIELD_DESC_(var, __VA_ARGS__), STRUCT_PRINT_VAR_(__VA_ARGS__))
+
+#elif STRUCT_PRINT_HAS_GENERIC
 
 /**
  * @brief 打印结构体的宏（C11 单参数版本）
@@ -723,8 +6660,172 @@ static inline void struct_print(const char* var_name, const void* struct_data, c
  * DeviceInfo device;
  * STRUCT_PRINT(device);   // ✨ 只需一个参数！
  */
+#ifdef STRUCT_PRINT_CAPTURE_RING
+#define STRUCT_PRINT(var) \
+    ((void)struct_print_ring_push(&STRUCT_PRINT_CAPTURE_RING, #var, &(var), GET_STRUCT_DESC(var)))
+#else
 #define STRUCT_PRINT(var) \
     struct_print(#var, &(var), GET_STRUCT_DESC(var))
+#endif
+
+/**
+ * @brief 打印两个同类型结构体之间变化的字段（C11 版本）
+ * @param old_var 旧值
+ * @param new_var 新值
+ */
+#define STRUCT_PRINT_DIFF(old_var, new_var) \
+    ((void)struct_print_diff(#new_var, &(old_var), &(new_var), GET_STRUCT_DESC(new_var)))
+
+/**
+ * @brief 监视结构体，内容变化时才打印（C11 版本）
+ * @param var 结构体变量
+ * @note 每个调用点使用一份静态影子副本；限速见 STRUCT_WATCH_MAX_RATE
+ */
+#define STRUCT_WATCH(var) do { \
+    static union { u8 bytes[sizeof(var)]; double align_d; void* align_p; } sp_watch_shadow_; \
+    static StructWatch sp_watch_ = STRUCT_WATCH_INIT(&sp_watch_shadow_, sizeof(sp_watch_shadow_), STRUCT_WATCH_MAX_RATE); \
+    (void)struct_watch(&sp_watch_, #var, &(var), GET_STRUCT_DESC(var)); \
+} while (0)
+
+/**
+ * @brief 捕获结构体到环形缓冲区（C11 版本，稍后由 struct_print_ring_drain 格式化）
+ * @param ring 环形缓冲区指针
+ * @param var 变量名
+ */
+#define STRUCT_PRINT_CAPTURE(ring, var) \
+    struct_print_ring_push((ring), #var, &(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 提交结构体到异步工作池（C11 版本，需定义 STRUCT_PRINT_POOL 为 1）
+ * @param pool 工作池指针
+ * @param var 变量名
+ * @return 0 成功，-1 失败
+ */
+#if STRUCT_PRINT_POOL
+#define STRUCT_PRINT_ASYNC(pool, var) \
+    struct_print_pool_submit((pool), #var, &(var), GET_STRUCT_DESC(var))
+#endif
+
+/**
+ * @brief 打印结构体到指定输出缓冲区（C11 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ */
+#define STRUCT_PRINT_TO(sink, var) \
+    struct_print_to((sink), #var, &(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 输出结构体的二进制日志帧（C11 版本）
+ * @param var 变量名
+ *
+ * @note 只做 memcpy，由主机端工具 struct_log_decode 还原为文本
+ */
+#define STRUCT_LOG(var) \
+    struct_log(GET_STRUCT_DESC(var), &(var))
+
+/**
+ * @brief 输出结构体的二进制日志帧到指定 Sink（C11 版本）
+ */
+#define STRUCT_LOG_TO(sink, var) \
+    struct_log_to((sink), GET_STRUCT_DESC(var), &(var), STRUCT_LOG_TIMESTAMP())
+
+/**
+ * @brief 以表格形式打印结构体数组（C11 版本）
+ * @param arr 数组（或指向首元素的指针）
+ * @param n 元素个数
+ */
+#define STRUCT_PRINT_TABLE(arr, n) \
+    struct_print_table(#arr, (arr), (size_t)(n), 0, GET_STRUCT_DESC((arr)[0]))
+
+/**
+ * @brief 批量打印结构体数组的每个元素（C11 版本，输出与逐个 STRUCT_PRINT 相同）
+ * @param arr 数组（或指向首元素的指针）
+ * @param n 元素个数
+ */
+#define STRUCT_PRINT_BATCH(arr, n) \
+    struct_print_batch(#arr, (arr), sizeof((arr)[0]), (size_t)(n), GET_STRUCT_DESC((arr)[0]))
+
+/**
+ * @brief 以 JSON 格式打印结构体（C11 版本，输出一行 NDJSON 记录）
+ * @param var 变量名
+ */
+#define STRUCT_PRINT_JSON(var) \
+    struct_print_json(#var, &(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 以单行紧凑格式打印结构体（C11 版本）
+ * @param var 变量名
+ *
+ * @note 输出 SystemStatus{timestamp=123,device={device_id=1,...},error_code=0}
+ */
+#define STRUCT_PRINT_COMPACT(var) \
+    struct_print_compact(&(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 以单行紧凑格式打印结构体到指定输出缓冲区（C11 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ */
+#define STRUCT_PRINT_COMPACT_TO(sink, var) \
+    struct_print_compact_to((sink), &(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 以 JSON 格式打印结构体到指定输出缓冲区（C11 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ */
+#define STRUCT_PRINT_JSON_TO(sink, var) \
+    struct_print_json_to((sink), #var, &(var), GET_STRUCT_DESC(var))
+
+/**
+ * @brief 以 CBOR 记录输出结构体（C11 版本，首次出现的类型先发送名称表）
+ * @param session CBOR 会话指针（NULL 表示不发送名称表）
+ * @param sink 输出缓冲区指针（刷新回调需按长度写出二进制数据）
+ * @param var 变量名
+ */
+#define STRUCT_CBOR_TO(session, sink, var) \
+    struct_cbor_to((session), (sink), GET_STRUCT_DESC(var), &(var))
+
+/**
+ * @brief 按路径读取数值字段（C11 版本）
+ * @param var 变量名
+ * @param path 字段路径字符串，如 "device.temperature"、"sensors[2].value"
+ * @return double；路径无效或字段不是数值时为 0
+ */
+#define STRUCT_GET(var, path) \
+    struct_get(&(var), GET_STRUCT_DESC(var), (path))
+
+/**
+ * @brief 解析字段路径，返回可缓存的句柄（C11 版本，配合 STRUCT_FIELD_AT / struct_field_get 使用）
+ * @param var 变量名（只用于选择描述符）
+ * @param path 字段路径字符串
+ */
+#define STRUCT_FIELD_REF(var, path) \
+    struct_field_ref(GET_STRUCT_DESC(var), (path))
+
+/**
+ * @brief 只打印一个字段（C11 版本）
+ * @param var 变量名
+ * @param path 字段路径字符串
+ */
+#define STRUCT_PRINT_FIELD(var, path) \
+    struct_print_field(#var, &(var), GET_STRUCT_DESC(var), (path))
+
+/**
+ * @brief 按过滤条件打印结构体（C11 版本）
+ * @param var 变量名
+ * @param filter 过滤条件指针（const StructPrintFilter*）
+ */
+#define STRUCT_PRINT_FILTERED(var, filter) \
+    struct_print_filtered(#var, &(var), GET_STRUCT_DESC(var), (filter))
+
+/**
+ * @brief 按指定选项打印结构体（C11 版本）
+ * @param var 变量名
+ * @param options 输出选项指针，如 &struct_print_options_terse
+ */
+#define STRUCT_PRINT_WITH(var, options) \
+    struct_print_options(#var, &(var), GET_STRUCT_DESC(var), (options))
 
 #else
 
@@ -741,10 +6842,186 @@ static inline void struct_print(const char* var_name, const void* struct_data, c
  * DeviceInfo device;
  * STRUCT_PRINT(device, DeviceInfo);  // 需要两个参数
  */
+#ifdef STRUCT_PRINT_CAPTURE_RING
+#define STRUCT_PRINT(var, type) \
+    ((void)struct_print_ring_push(&STRUCT_PRINT_CAPTURE_RING, #var, &(var), &type##_desc))
+#else
 #define STRUCT_PRINT(var, type) \
     struct_print(#var, &(var), &type##_desc)
+#endif
+
+/**
+ * @brief 打印两个同类型结构体之间变化的字段（C99 版本）
+ * @param old_var 旧值
+ * @param new_var 新值
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_DIFF(old_var, new_var, type) \
+    ((void)struct_print_diff(#new_var, &(old_var), &(new_var), &type##_desc))
+
+/**
+ * @brief 监视结构体，内容变化时才打印（C99 版本）
+ * @param var 结构体变量
+ * @param type 结构体类型名
+ */
+#define STRUCT_WATCH(var, type) do { \
+    static type sp_watch_shadow_; \
+    static StructWatch sp_watch_ = STRUCT_WATCH_INIT(&sp_watch_shadow_, sizeof(sp_watch_shadow_), STRUCT_WATCH_MAX_RATE); \
+    (void)struct_watch(&sp_watch_, #var, &(var), &type##_desc); \
+} while (0)
+
+/**
+ * @brief 捕获结构体到环形缓冲区（C99 版本）
+ * @param ring 环形缓冲区指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_CAPTURE(ring, var, type) \
+    struct_print_ring_push((ring), #var, &(var), &type##_desc)
+
+/**
+ * @brief 提交结构体到异步工作池（C99 版本，需定义 STRUCT_PRINT_POOL 为 1）
+ * @param pool 工作池指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ * @return 0 成功，-1 失败
+ */
+#if STRUCT_PRINT_POOL
+#define STRUCT_PRINT_ASYNC(pool, var, type) \
+    struct_print_pool_submit((pool), #var, &(var), &type##_desc)
+#endif
+
+/**
+ * @brief 打印结构体到指定输出缓冲区（C99 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_TO(sink, var, type) \
+    struct_print_to((sink), #var, &(var), &type##_desc)
+
+/**
+ * @brief 输出结构体的二进制日志帧（C99 版本）
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_LOG(var, type) \
+    struct_log(&type##_desc, &(var))
+
+/**
+ * @brief 输出结构体的二进制日志帧到指定 Sink（C99 版本）
+ */
+#define STRUCT_LOG_TO(sink, var, type) \
+    struct_log_to((sink), &type##_desc, &(var), STRUCT_LOG_TIMESTAMP())
+
+/**
+ * @brief 以表格形式打印结构体数组（C99 版本）
+ * @param arr 数组（或指向首元素的指针）
+ * @param n 元素个数
+ * @param type 元素的结构体类型名
+ */
+#define STRUCT_PRINT_TABLE(arr, n, type) \
+    struct_print_table(#arr, (arr), (size_t)(n), 0, &type##_desc)
+
+/**
+ * @brief 批量打印结构体数组的每个元素（C99 版本，输出与逐个 STRUCT_PRINT 相同）
+ * @param arr 数组（或指向首元素的指针）
+ * @param n 元素个数
+ * @param type 元素的结构体类型名
+ */
+#define STRUCT_PRINT_BATCH(arr, n, type) \
+    struct_print_batch(#arr, (arr), sizeof((arr)[0]), (size_t)(n), &type##_desc)
+
+/**
+ * @brief 以 JSON 格式打印结构体（C99 版本，输出一行 NDJSON 记录）
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_JSON(var, type) \
+    struct_print_json(#var, &(var), &type##_desc)
+
+/**
+ * @brief 以单行紧凑格式打印结构体（C99 版本）
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_COMPACT(var, type) \
+    struct_print_compact(&(var), &type##_desc)
+
+/**
+ * @brief 以单行紧凑格式打印结构体到指定输出缓冲区（C99 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_COMPACT_TO(sink, var, type) \
+    struct_print_compact_to((sink), &(var), &type##_desc)
+
+/**
+ * @brief 以 JSON 格式打印结构体到指定输出缓冲区（C99 版本）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_JSON_TO(sink, var, type) \
+    struct_print_json_to((sink), #var, &(var), &type##_desc)
+
+/**
+ * @brief 以 CBOR 记录输出结构体（C99 版本）
+ * @param session CBOR 会话指针（NULL 表示不发送名称表）
+ * @param sink 输出缓冲区指针
+ * @param var 变量名
+ * @param type 结构体类型名
+ */
+#define STRUCT_CBOR_TO(session, sink, var, type) \
+    struct_cbor_to((session), (sink), &type##_desc, &(var))
+
+/**
+ * @brief 按路径读取数值字段（C99 版本）
+ * @param var 变量名
+ * @param path 字段路径字符串
+ * @param type 结构体类型名
+ */
+#define STRUCT_GET(var, path, type) \
+    struct_get(&(var), &type##_desc, (path))
+
+/**
+ * @brief 解析字段路径，返回可缓存的句柄（C99 版本）
+ * @param var 变量名（C99 版本中未使用，保持参数形式一致）
+ * @param path 字段路径字符串
+ * @param type 结构体类型名
+ */
+#define STRUCT_FIELD_REF(var, path, type) \
+    struct_field_ref(&type##_desc, (path))
+
+/**
+ * @brief 只打印一个字段（C99 版本）
+ * @param var 变量名
+ * @param path 字段路径字符串
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_FIELD(var, path, type) \
+    struct_print_field(#var, &(var), &type##_desc, (path))
+
+/**
+ * @brief 按过滤条件打印结构体（C99 版本）
+ * @param var 变量名
+ * @param filter 过滤条件指针（const StructPrintFilter*）
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_FILTERED(var, filter, type) \
+    struct_print_filtered(#var, &(var), &type##_desc, (filter))
+
+/**
+ * @brief 按指定选项打印结构体（C99 版本）
+ * @param var 变量名
+ * @param options 输出选项指针，如 &struct_print_options_terse
+ * @param type 结构体类型名
+ */
+#define STRUCT_PRINT_WITH(var, options, type) \
+    struct_print_options(#var, &(var), &type##_desc, (options))
 
-#endif /* STRUCT_PRINT_HAS_GENERIC */
+#endif /* STRUCT_PRINT_HAS_CPP17 / STRUCT_PRINT_HAS_GENERIC */
 
 
 #else /* STRUCT_PRINT_ENABLE 未定义 */
@@ -767,13 +7044,97 @@ static inline void struct_print(const char* var_name, const void* struct_data, c
 #define FIELD_STRING(struct_type, field_name)
 #define FIELD_ARRAY(struct_type, field_name, element_type)
 #define FIELD_STRUCT(struct_type, field_name, nested_desc)
+#define FIELD_STRUCT_ARRAY(struct_type, field_name, nested_desc)
 #define END_STRUCT_DESC(struct_type, desc_name)
+#define STRUCT_DESC_SPECIALIZED(struct_type, desc_name, FIELDS)
+#define STRUCT_DESC_REGISTER(desc_name)
+#define STRUCT_PRINT_STATS_DEFINE(name, capacity)
+#define STRUCT_PRINT_STATS_DUMP() ((void)0)
+#define STRUCT_PRINT_POOL_DEFINE(name, slots, data_bytes, text_bytes)
+#define STRUCT_PRINT_TEMPLATES_DEFINE(name, entries, arena_bytes)
+
+/* 字段句柄：STRUCT_FIELD_REF 返回空句柄（field 为 NULL），STRUCT_FIELD_AT 与 STRUCT_GET 一样得到 0，
+ * 不按空句柄读取内存；缓存句柄的代码照常编译（通过 STRUCT_FIELD_AT 写入字段的代码需要 #ifdef） */
+typedef struct {
+    const void* field;
+    size_t offset;
+    size_t size;
+    size_t count;
+} StructFieldRef;
+
+static inline StructFieldRef struct_field_ref_none(void) {
+    StructFieldRef ref = { NULL, 0, 0, 0 };
+    return ref;
+}
+
+#define STRUCT_FIELD_AT(var, ref, ctype) ((void)sizeof(var), (void)(ref), (ctype)0)
 
 /* STRUCT_PRINT 支持可变参数（C99/C11 兼容）*/
-#if STRUCT_PRINT_HAS_GENERIC
+#if STRUCT_PRINT_HAS_CPP17
+    #define STRUCT_PRINT(...) ((void)0)
+    #define STRUCT_PRINT_TO(sink, ...) ((void)0)
+    #define STRUCT_LOG(...) ((void)0)
+    #define STRUCT_LOG_TO(sink, ...) ((void)0)
+    #define STRUCT_PRINT_CAPTURE(ring, ...) 0
+    #define STRUCT_PRINT_ASYNC(pool, ...) 0
+    #define STRUCT_PRINT_DIFF(old_var, ...) ((void)0)
+    #define STRUCT_WATCH(...) ((void)0)
+    #define STRUCT_PRINT_TABLE(arr, ...) ((void)0)
+    #define STRUCT_PRINT_BATCH(arr, ...) ((void)0)
+    #define STRUCT_PRINT_JSON(...) ((void)0)
+    #define STRUCT_PRINT_COMPACT(...) ((void)0)
+    #define STRUCT_PRINT_COMPACT_TO(sink, ...) ((void)0)
+    #define STRUCT_PRINT_JSON_TO(sink, ...) ((void)0)
+    #define STRUCT_CBOR_TO(session, sink, ...) ((void)0)
+    #define STRUCT_GET(var, ...) 0.0
+    #define STRUCT_FIELD_REF(var, ...) struct_field_ref_none()
+    #define STRUCT_PRINT_FIELD(var, ...) ((void)0)
+    #define STRUCT_PRINT_FILTERED(var, ...) ((void)0)
+    #define STRUCT_PRINT_WITH(var, ...) ((void)0)
+    #define STRUCT_PRINT_REFLECT(type, ...)
+    #define STRUCT_PRINT_REGISTER(type, desc_name)
+#elif STRUCT_PRINT_HAS_GENERIC
     #define STRUCT_PRINT(var) ((void)0)
+    #define STRUCT_PRINT_TO(sink, var) ((void)0)
+    #define STRUCT_LOG(var) ((void)0)
+    #define STRUCT_LOG_TO(sink, var) ((void)0)
+    #define STRUCT_PRINT_CAPTURE(ring, var) 0
+    #define STRUCT_PRINT_ASYNC(pool, var) 0
+    #define STRUCT_PRINT_DIFF(old_var, new_var) ((void)0)
+    #define STRUCT_WATCH(var) ((void)0)
+    #define STRUCT_PRINT_TABLE(arr, n) ((void)0)
+    #define STRUCT_PRINT_BATCH(arr, n) ((void)0)
+    #define STRUCT_PRINT_JSON(var) ((void)0)
+    #define STRUCT_PRINT_COMPACT(var) ((void)0)
+    #define STRUCT_PRINT_COMPACT_TO(sink, var) ((void)0)
+    #define STRUCT_PRINT_JSON_TO(sink, var) ((void)0)
+    #define STRUCT_CBOR_TO(session, sink, var) ((void)0)
+    #define STRUCT_GET(var, path) 0.0
+    #define STRUCT_FIELD_REF(var, path) struct_field_ref_none()
+    #define STRUCT_PRINT_FIELD(var, path) ((void)0)
+    #define STRUCT_PRINT_FILTERED(var, filter) ((void)0)
+    #define STRUCT_PRINT_WITH(var, options) ((void)0)
 #else
     #define STRUCT_PRINT(var, type) ((void)0)
+    #define STRUCT_PRINT_TO(sink, var, type) ((void)0)
+    #define STRUCT_LOG(var, type) ((void)0)
+    #define STRUCT_LOG_TO(sink, var, type) ((void)0)
+    #define STRUCT_PRINT_CAPTURE(ring, var, type) 0
+    #define STRUCT_PRINT_ASYNC(pool, var, type) 0
+    #define STRUCT_PRINT_DIFF(old_var, new_var, type) ((void)0)
+    #define STRUCT_WATCH(var, type) ((void)0)
+    #define STRUCT_PRINT_TABLE(arr, n, type) ((void)0)
+    #define STRUCT_PRINT_BATCH(arr, n, type) ((void)0)
+    #define STRUCT_PRINT_JSON(var, type) ((void)0)
+    #define STRUCT_PRINT_COMPACT(var, type) ((void)0)
+    #define STRUCT_PRINT_COMPACT_TO(sink, var, type) ((void)0)
+    #define STRUCT_PRINT_JSON_TO(sink, var, type) ((void)0)
+    #define STRUCT_CBOR_TO(session, sink, var, type) ((void)0)
+    #define STRUCT_GET(var, path, type) 0.0
+    #define STRUCT_FIELD_REF(var, path, type) struct_field_ref_none()
+    #define STRUCT_PRINT_FIELD(var, path, type) ((void)0)
+    #define STRUCT_PRINT_FILTERED(var, filter, type) ((void)0)
+    #define STRUCT_PRINT_WITH(var, options, type) ((void)0)
 #endif
 
 #endif /* STRUCT_PRINT_ENABLE */
@@ -783,5 +7144,219 @@ static inline void struct_print(const char* var_name, const void* struct_data, c
 }
 #endif
 
+
+/* ============================================================================
+ *                    C++17 编译期描述符（STRUCT_PRINT_REFLECT）
+ * ============================================================================ */
+
+#if defined(STRUCT_PRINT_ENABLE) && STRUCT_PRINT_HAS_CPP17
+
+#include <type_traits>
+
+namespace struct_print_cpp {
+
+template <typename T>
+struct dependent_false : std::false_type {};
+
+/**
+ * @brief 由成员类型推导字段类型（整数按大小和符号，枚举按底层类型）
+ */
+template <typename T>
+constexpr FieldType scalar_type() {
+    if constexpr (std::is_enum_v<T>) {
+        return scalar_type<std::underlying_type_t<T>>();
+    } else if constexpr (std::is_same_v<T, float>) {
+        return FIELD_TYPE_FLOAT;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return FIELD_TYPE_DOUBLE;
+    } else if constexpr (std::is_integral_v<T>) {
+        static_assert(sizeof(T) <= 4, "struct_print: 不支持 64 位整数字段");
+        if constexpr (sizeof(T) == 1) return std::is_signed_v<T> ? FIELD_TYPE_S8 : FIELD_TYPE_U8;
+        else if constexpr (sizeof(T) == 2) return std::is_signed_v<T> ? FIELD_TYPE_S16 : FIELD_TYPE_U16;
+        else return std::is_signed_v<T> ? FIELD_TYPE_S32 : FIELD_TYPE_U32;
+    } else {
+        static_assert(dependent_false<T>::value, "struct_print: 不支持的字段类型（指针、long double 等）");
+        return FIELD_TYPE_U8;
+    }
+}
+
+/**
+ * @brief 两种字段类型的内存表示是否一致（只比较宽度和浮点/整数，不比较符号）
+ */
+constexpr int scalar_class(FieldType t) {
+    switch (t) {
+        case FIELD_TYPE_U8:  case FIELD_TYPE_S8:  return 1;
+        case FIELD_TYPE_U16: case FIELD_TYPE_S16: return 2;
+        case FIELD_TYPE_U32: case FIELD_TYPE_S32: return 4;
+        case FIELD_TYPE_FLOAT:  return 5;
+        case FIELD_TYPE_DOUBLE: return 6;
+        default: return 0;
+    }
+}
+
+/**
+ * @brief FIELD_* 宏类型与成员类型是否匹配
+ */
+template <FieldType T, typename M>
+constexpr bool field_matches() {
+    if constexpr (T == FIELD_TYPE_STRUCT) {
+        return std::is_class_v<std::remove_all_extents_t<M>>;
+    } else if constexpr (T == FIELD_TYPE_STRING) {
+        using E = std::remove_cv_t<std::remove_extent_t<M>>;
+        return std::rank_v<M> == 1 && std::is_integral_v<E> && sizeof(E) == 1;
+    } else if constexpr (std::is_class_v<M> || std::is_array_v<M> || std::is_pointer_v<M>) {
+        return false;
+    } else {
+        return scalar_class(T) != 0 && scalar_class(T) == scalar_class(scalar_type<M>());
+    }
+}
+
+/**
+ * @brief 检查普通字段，返回字段大小
+ */
+template <FieldType T, typename Member>
+constexpr size_t checked_size(size_t size) {
+    using M = std::remove_cv_t<std::remove_reference_t<Member>>;
+    static_assert(field_matches<T, M>(), "struct_print: FIELD_* 宏与成员类型不匹配");
+    return size;
+}
+
+/**
+ * @brief 检查数组/字符串字段，返回元素大小
+ */
+template <FieldType T, typename Member>
+constexpr size_t checked_elem_size(size_t size) {
+    using M = std::remove_cv_t<std::remove_reference_t<Member>>;
+    static_assert(std::rank_v<M> == 1, "struct_print: FIELD_ARRAY/FIELD_STRING/FIELD_STRUCT_ARRAY 只能用于一维数组");
+    if constexpr (T == FIELD_TYPE_STRING) {
+        static_assert(field_matches<T, M>(), "struct_print: FIELD_STRING 只能用于单字节字符数组");
+    } else {
+        static_assert(field_matches<T, std::remove_cv_t<std::remove_extent_t<M>>>(),
+                      "struct_print: FIELD_ARRAY 元素类型与成员类型不匹配");
+    }
+    return size;
+}
+
+/**
+ * @brief 由成员类型生成字段描述符（编译期）
+ * @param name 字段名
+ * @param offset 字段偏移
+ */
+template <typename Member>
+constexpr FieldDescriptor make_field(const char* name, size_t offset) {
+    using M = std::remove_cv_t<Member>;
+    
+    if constexpr (std::is_array_v<M>) {
+        using E = std::remove_cv_t<std::remove_extent_t<M>>;
+        static_assert(std::rank_v<M> == 1, "struct_print: 不支持多维数组");
+        if constexpr (std::is_class_v<E>) {
+            /* 结构体数组：与 FIELD_STRUCT_ARRAY 相同（size 为元素大小）*/
+            return FieldDescriptor{ name, FIELD_TYPE_STRUCT, offset, sizeof(E), std::extent_v<M>,
+                                    struct_print_desc_of(static_cast<const E*>(nullptr)) };
+        } else {
+            /* u8/char 数组按字符串处理，与描述符生成器一致 */
+            constexpr bool is_text = std::is_same_v<E, char> || std::is_same_v<E, unsigned char>;
+            return FieldDescriptor{ name, is_text ? FIELD_TYPE_STRING : scalar_type<E>(), offset,
+                                    sizeof(E), std::extent_v<M>, nullptr };
+        }
+    } else if constexpr (std::is_class_v<M>) {
+        /* 嵌套结构体：描述符同样通过重载决议查找（需先注册） */
+        return FieldDescriptor{ name, FIELD_TYPE_STRUCT, offset, sizeof(M), 0,
+                                struct_print_desc_of(static_cast<const M*>(nullptr)) };
+    } else {
+        return FieldDescriptor{ name, scalar_type<M>(), offset, sizeof(M), 0, nullptr };
+    }
+}
+
+} /* namespace struct_print_cpp */
+
+/* 逐字段展开（最多 32 个字段，STRUCT_PRINT_EXPAND_ 兼容 MSVC 传统预处理器）*/
+#define STRUCT_PRINT_FE_1_(m, t, x) m(t, x)
+#define STRUCT_PRINT_FE_2_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_1_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_3_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_2_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_4_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_3_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_5_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_4_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_6_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_5_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_7_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_6_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_8_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_7_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_9_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_8_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_10_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_9_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_11_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_10_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_12_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_11_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_13_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_12_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_14_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_13_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_15_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_14_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_16_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_15_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_17_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_16_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_18_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_17_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_19_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_18_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_20_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_19_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_21_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_20_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_22_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_21_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_23_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_22_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_24_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_23_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_25_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_24_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_26_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_25_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_27_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_26_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_28_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_27_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_29_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_28_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_30_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_29_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_31_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_30_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_32_(m, t, x, ...) m(t, x) STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_31_(m, t, __VA_ARGS__))
+#define STRUCT_PRINT_FE_N_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, n, ...) n
+#define STRUCT_PRINT_FOR_EACH_(m, t, ...) \
+    STRUCT_PRINT_EXPAND_(STRUCT_PRINT_FE_N_(__VA_ARGS__, \
+    STRUCT_PRINT_FE_32_, STRUCT_PRINT_FE_31_, STRUCT_PRINT_FE_30_, STRUCT_PRINT_FE_29_, STRUCT_PRINT_FE_28_, STRUCT_PRINT_FE_27_, STRUCT_PRINT_FE_26_, STRUCT_PRINT_FE_25_, \
+    STRUCT_PRINT_FE_24_, STRUCT_PRINT_FE_23_, STRUCT_PRINT_FE_22_, STRUCT_PRINT_FE_21_, STRUCT_PRINT_FE_20_, STRUCT_PRINT_FE_19_, STRUCT_PRINT_FE_18_, STRUCT_PRINT_FE_17_, \
+    STRUCT_PRINT_FE_16_, STRUCT_PRINT_FE_15_, STRUCT_PRINT_FE_14_, STRUCT_PRINT_FE_13_, STRUCT_PRINT_FE_12_, STRUCT_PRINT_FE_11_, STRUCT_PRINT_FE_10_, STRUCT_PRINT_FE_9_, \
+    STRUCT_PRINT_FE_8_, STRUCT_PRINT_FE_7_, STRUCT_PRINT_FE_6_, STRUCT_PRINT_FE_5_, STRUCT_PRINT_FE_4_, STRUCT_PRINT_FE_3_, STRUCT_PRINT_FE_2_, STRUCT_PRINT_FE_1_)(m, t, __VA_ARGS__))
+
+#define STRUCT_PRINT_REFLECT_FIELD_(type, field) \
+    struct_print_cpp::make_field<decltype(type::field)>(#field, offsetof(type, field)),
+
+/**
+ * @brief 一行注册结构体（C++17），在编译期生成描述符
+ * @param type 结构体类型名
+ * @param ... 字段名列表（最多 32 个，字段类型由成员类型自动推导）
+ *
+ * @note 生成 constexpr 的 type##_desc（位于只读数据段，无运行时初始化），
+ *       并注册重载 struct_print_desc_of(const type*)，STRUCT_PRINT(var) 由此选择描述符
+ * @note 嵌套结构体成员需要先注册
+ *
+ * @example
+ * STRUCT_PRINT_REFLECT(DeviceInfo, device_id, firmware_version, serial_number, temperature, voltage)
+ * STRUCT_PRINT(device);
+ */
+#define STRUCT_PRINT_REFLECT(type, ...) \
+    static constexpr FieldDescriptor type##_desc_fields[] = { \
+        STRUCT_PRINT_FOR_EACH_(STRUCT_PRINT_REFLECT_FIELD_, type, __VA_ARGS__) \
+    }; \
+    static constexpr StructDescriptor type##_desc = { \
+        #type, \
+        sizeof(type), \
+        sizeof(type##_desc_fields) / sizeof(FieldDescriptor), \
+        type##_desc_fields, \
+        nullptr, \
+        struct_layout_fingerprint(#type, sizeof(type), type##_desc_fields, \
+                                  sizeof(type##_desc_fields) / sizeof(FieldDescriptor)), \
+        nullptr \
+    }; \
+    STRUCT_PRINT_AUTO_REGISTER_(type##_desc) \
+    [[maybe_unused]] static constexpr const StructDescriptor* struct_print_desc_of(const type*) noexcept { \
+        return &type##_desc; \
+    }
+
+/**
+ * @brief 为已有的 C 描述符（BEGIN_STRUCT_DESC 定义）注册重载，使 STRUCT_PRINT(var) 可用
+ * @param type 结构体类型名
+ * @param desc_name 描述符变量名
+ */
+#define STRUCT_PRINT_REGISTER(type, desc_name) \
+    [[maybe_unused]] static constexpr const StructDescriptor* struct_print_desc_of(const type*) noexcept { \
+        return &desc_name; \
+    }
+
+#endif /* STRUCT_PRINT_ENABLE && STRUCT_PRINT_HAS_CPP17 */
+
 #endif /* __STRUCT_PRINT_H */
 
@@ -0,0 +1,138 @@
+/**
+ * @file struct_shell_demo.c
+ * @brief 检查 Shell 演示（Linux，标准输入/输出模拟串口）
+ * @author xingleixu@gmail.com
+ * @date 2025-10-18
+ *
+ * 程序模拟一个持续更新的设备状态，从标准输入读取 Shell 命令。
+ * 可交互运行，也可用管道或 pty 驱动（便于脚本测试）：
+ *   ./struct_shell_demo
+ *   printf 'list\nget SystemStatus.device.temperature status\n' | ./struct_shell_demo
+ *   (printf 'watch SystemStatus status 5\n'; sleep 1) | ./struct_shell_demo
+ *
+ * 标准输入结束（EOF 或 Ctrl-D）后退出。
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+
+static uint32_t demo_time_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000);
+}
+
+#define STRUCT_PRINT_ENABLE
+#define STRUCT_WATCH_TIME_MS() demo_time_ms()
+#include "struct_print.h"
+
+#include "test_structs.h"
+#include "test_structs_desc.h"
+
+/* ============================================================================
+ *                          模拟的设备数据
+ * ============================================================================ */
+
+static SystemStatus g_status;
+static ConfigParams g_config;
+
+static const StructShellSymbol g_symbols[] = {
+    { "status", &g_status },
+    { "device", &g_status.device },
+    { "config", &g_config },
+};
+
+static void demo_init_data(void)
+{
+    g_status.timestamp = 0;
+    g_status.device.device_id = 7;
+    g_status.device.firmware_version = 0x0102;
+    g_status.device.serial_number = 20251018;
+    g_status.device.temperature = 25.0f;
+    g_status.device.voltage = 3.3;
+    g_status.sensor.sensor_id = 1;
+    g_status.sensor.value = 0;
+    g_status.sensor.status = 1;
+
+    g_config.mode = 2;
+    g_config.interval = 100;
+    g_config.timeout = 5000;
+    g_config.offset = -3;
+    g_config.gain = 1.5f;
+}
+
+/* 每 500 ms 更新一次：时间戳递增，温度和传感器值缓慢变化 */
+static void demo_update_data(uint32_t now)
+{
+    static uint32_t last;
+    if (now - last < 500u) return;
+    last = now;
+
+    g_status.timestamp++;
+    g_status.device.temperature += 0.5f;
+    g_status.sensor.value = (s16)(g_status.sensor.value + 3);
+}
+
+/* ============================================================================
+ *                          主循环
+ * ============================================================================ */
+
+static void stdout_flush(void* ctx, const char* data, size_t len)
+{
+    fwrite(data, 1, len, (FILE*)ctx);
+    fflush((FILE*)ctx);
+}
+
+STRUCT_REGISTRY_DEFINE(g_registry, 16);
+STRUCT_PATH_INDEX_DEFINE(g_index, 64);
+
+int main(void)
+{
+    static const StructDescriptor* const descs[] = { TEST_STRUCTS_DESC_LIST };
+    static u8 watch_shadow[sizeof(stCircuitMqttCmdData)];
+    char out_buf[256];
+    StructPrintSink sink;
+    StructShell shell;
+    size_t i;
+
+    demo_init_data();
+    for (i = 0; i < sizeof(descs) / sizeof(descs[0]); i++) {
+        struct_registry_add(&g_registry, descs[i]);
+    }
+    struct_path_index_build(&g_index, &g_registry);
+
+    struct_print_sink_init(&sink, out_buf, sizeof(out_buf), stdout_flush, stdout, STRUCT_PRINT_SINK_FLUSH_LINE);
+    struct_shell_init(&shell, &g_registry, &g_index, &sink);
+    struct_shell_set_symbols(&shell, g_symbols, sizeof(g_symbols) / sizeof(g_symbols[0]));
+    struct_shell_set_watch_buffer(&shell, watch_shadow, sizeof(watch_shadow));
+
+    sink_puts(&sink, "struct shell, type 'help' for commands");
+    sink_endline(&sink);
+    sink_puts(&sink, STRUCT_SHELL_PROMPT);
+    struct_print_sink_flush(&sink);
+
+    for (;;) {
+        struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+        int ready = poll(&pfd, 1, 10);
+
+        if (ready > 0) {
+            char in[64];
+            ssize_t n = read(STDIN_FILENO, in, sizeof(in));
+            if (n <= 0) break;
+            struct_shell_feed(&shell, in, (size_t)n);
+        }
+        demo_update_data(demo_time_ms());
+        struct_shell_poll(&shell);
+    }
+
+    sink_endline(&sink);
+    struct_print_sink_flush(&sink);
+    return 0;
+}
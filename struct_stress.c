@@ -0,0 +1,342 @@
+/**
+ * @file struct_stress.c
+ * @brief 多线程打印压力测试（Linux，pthread）
+ * @author xingleixu@gmail.com
+ * @date 2025-10-18
+ *
+ * N 个线程同时对各自的 SystemStatus 调用 STRUCT_PRINT，输出函数模拟一个串口驱动：
+ * 每次调用在锁内把数据追加到共享的输出区（单次调用本身是原子的）。
+ * 全部线程结束后检查输出是否由完整的记录首尾相接组成（没有交错），并给出 1/2/4/8 线程的吞吐量。
+ *
+ * 第二部分测试异步工作池（STRUCT_PRINT_POOL）：一个线程提交记录，1/2/4/8 个工作线程并行格式化，
+ * 检查输出顺序与提交顺序一致，并给出每秒记录数。
+ *
+ *   make stress                                            （线程安全模式，应无交错）
+ *   make stress STRESS_FLAGS=-DSTRUCT_PRINT_THREAD_SAFE=0  （默认逐行输出，对比交错情况）
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define STRESS_MAX_THREADS      8
+#define STRESS_RECORDS          16000       /* 每组的记录总数（平均分给各线程）*/
+#define STRESS_RECORD_MAX       4096
+
+/* ============================================================================
+ *                          模拟的串口驱动
+ * ============================================================================ */
+
+static char* g_out;
+static size_t g_out_len;
+static size_t g_out_size;
+static size_t g_out_calls;
+static pthread_mutex_t g_device_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_print_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief STRUCT_PRINT_PRINTF 实现：一次调用的数据整体写入输出区
+ */
+static void stress_printf(const char* format, ...)
+{
+    char tmp[256];
+    const char* data = tmp;
+    size_t len;
+    va_list args;
+
+    va_start(args, format);
+    if (strcmp(format, "%s") == 0) {
+        data = va_arg(args, const char*);
+    } else {
+        vsnprintf(tmp, sizeof(tmp), format, args);
+    }
+    va_end(args);
+    len = strlen(data);
+
+    pthread_mutex_lock(&g_device_lock);
+    if (g_out_len + len <= g_out_size) {
+        memcpy(g_out + g_out_len, data, len);
+        g_out_len += len;
+    }
+    g_out_calls++;
+    pthread_mutex_unlock(&g_device_lock);
+}
+
+#ifndef STRUCT_PRINT_THREAD_SAFE
+#define STRUCT_PRINT_THREAD_SAFE 1
+#endif
+#define STRUCT_PRINT_PRINTF stress_printf
+#define STRUCT_PRINT_LOCK() pthread_mutex_lock(&g_print_lock)
+#define STRUCT_PRINT_UNLOCK() pthread_mutex_unlock(&g_print_lock)
+#define STRUCT_PRINT_POOL 1
+#define STRUCT_PRINT_ENABLE
+#include "struct_print.h"
+
+#include "test_structs.h"
+#include "test_structs_desc.h"
+
+/* ============================================================================
+ *                          打印线程
+ * ============================================================================ */
+
+typedef struct {
+    int id;
+    int records;
+    SystemStatus status;
+    char expected[STRESS_RECORD_MAX];      /* 该线程一条记录的完整输出 */
+    size_t expected_len;
+    size_t matched;                         /* 校验时匹配到的记录数 */
+} StressThread;
+
+static StressThread g_threads[STRESS_MAX_THREADS];
+
+static void stress_capture_flush(void* ctx, const char* data, size_t len)
+{
+    StressThread* t = (StressThread*)ctx;
+
+    if (t->expected_len + len <= sizeof(t->expected)) {
+        memcpy(t->expected + t->expected_len, data, len);
+        t->expected_len += len;
+    }
+}
+
+static void* stress_thread(void* arg)
+{
+    StressThread* t = (StressThread*)arg;
+    int i;
+
+    for (i = 0; i < t->records; i++) {
+        STRUCT_PRINT(t->status, SystemStatus);
+    }
+    return NULL;
+}
+
+/* ============================================================================
+ *                          校验与统计
+ * ============================================================================ */
+
+static double stress_now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief 输出必须是各线程完整记录的首尾拼接
+ * @return 无法匹配的位置个数（0 表示没有交错）
+ */
+static size_t stress_verify(int threads)
+{
+    size_t pos = 0;
+    size_t bad = 0;
+    int i;
+
+    for (i = 0; i < threads; i++) g_threads[i].matched = 0;
+
+    while (pos < g_out_len) {
+        for (i = 0; i < threads; i++) {
+            StressThread* t = &g_threads[i];
+            if (pos + t->expected_len <= g_out_len &&
+                memcmp(g_out + pos, t->expected, t->expected_len) == 0) {
+                t->matched++;
+                pos += t->expected_len;
+                break;
+            }
+        }
+        if (i == threads) {
+            /* 跳到下一条记录的开头继续匹配 */
+            const char* next = strstr(g_out + pos + 1, "========================================\nStruct: ");
+            bad++;
+            pos = (next != NULL) ? (size_t)(next - g_out) : g_out_len;
+        }
+    }
+    for (i = 0; i < threads; i++) {
+        if (g_threads[i].matched != (size_t)g_threads[i].records) bad++;
+    }
+    return bad;
+}
+
+static int stress_run(int threads)
+{
+    pthread_t tid[STRESS_MAX_THREADS];
+    double t0, elapsed;
+    size_t bad;
+    int i;
+
+    for (i = 0; i < threads; i++) {
+        StressThread* t = &g_threads[i];
+        StructPrintSink sink;
+        char buf[STRUCT_PRINT_LINE_BUF_SIZE];
+
+        t->id = i;
+        t->records = STRESS_RECORDS / threads;
+        memset(&t->status, 0, sizeof(t->status));
+        t->status.timestamp = 1000u + (u32)i;
+        t->status.device.device_id = (u8)i;
+        t->status.device.serial_number = 20251018u + (u32)i;
+        t->status.device.temperature = 25.0f + (float)i;
+        t->status.device.voltage = 3.3;
+        t->status.sensor.sensor_id = (u16)(100 + i);
+        t->status.sensor.value = (s16)(-i);
+        t->status.error_code = (u8)i;
+
+        t->expected_len = 0;
+        struct_print_sink_init(&sink, buf, sizeof(buf), stress_capture_flush, t, STRUCT_PRINT_SINK_FLUSH_LINE);
+        struct_print_to(&sink, "t->status", &t->status, &SystemStatus_desc);
+    }
+
+    g_out_len = 0;
+    g_out_calls = 0;
+    t0 = stress_now_s();
+    for (i = 0; i < threads; i++) {
+        pthread_create(&tid[i], NULL, stress_thread, &g_threads[i]);
+    }
+    for (i = 0; i < threads; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    elapsed = stress_now_s() - t0;
+
+    bad = stress_verify(threads);
+    printf("%8d %10d %12.0f %14.2f %12lu %12s\n",
+           threads, (threads * (STRESS_RECORDS / threads)),
+           (threads * (STRESS_RECORDS / threads)) / elapsed,
+           (double)g_out_calls / (threads * (STRESS_RECORDS / threads)),
+           (unsigned long)bad, bad == 0 ? "OK" : "INTERLEAVED");
+    return bad == 0;
+}
+
+/* ============================================================================
+ *                          异步工作池
+ * ============================================================================ */
+
+#define POOL_RECORDS            100000
+
+STRUCT_PRINT_POOL_DEFINE(g_pool, 256, sizeof(SystemStatus), 2048);
+
+static void pool_out(void* ctx, const char* data, size_t len)
+{
+    (void)ctx;
+    if (g_out_len + len <= g_out_size) {
+        memcpy(g_out + g_out_len, data, len);
+        g_out_len += len;
+    }
+    g_out_calls++;
+}
+
+/**
+ * @brief 输出中的 timestamp 必须依次为 0, 1, 2, ...（与提交顺序一致）
+ * @return 乱序或缺失的记录数
+ */
+static size_t pool_verify(u32 records)
+{
+    const char* p = g_out;
+    const char* end = g_out + g_out_len;
+    size_t bad = 0;
+    u32 expect = 0;
+
+    while (p < end && (p = strstr(p, "timestamp: ")) != NULL) {
+        unsigned long v = strtoul(p + 11, NULL, 10);
+        if (v != expect) bad++;
+        expect = (u32)v + 1;
+        p += 11;
+    }
+    if (expect != records) bad++;
+    return bad;
+}
+
+static int pool_run(u32 workers, double sync_rate)
+{
+    StructPrintPoolStats stats;
+    SystemStatus status;
+    double t0, elapsed;
+    size_t bad;
+    u32 i;
+
+    memset(&status, 0, sizeof(status));
+    status.device.device_id = 7;
+    status.device.temperature = 25.5f;
+    status.device.voltage = 3.3;
+    status.sensor.sensor_id = 100;
+
+    g_out_len = 0;
+    g_out_calls = 0;
+    if (struct_print_pool_start(&g_pool, workers, pool_out, NULL) != 0) {
+        printf("struct_print_pool_start failed\n");
+        return 0;
+    }
+    t0 = stress_now_s();
+    for (i = 0; i < POOL_RECORDS; i++) {
+        status.timestamp = i;
+        STRUCT_PRINT_ASYNC(&g_pool, status, SystemStatus);
+    }
+    struct_print_pool_flush(&g_pool);
+    elapsed = stress_now_s() - t0;
+    struct_print_pool_get_stats(&g_pool, &stats);
+    struct_print_pool_stop(&g_pool);
+
+    bad = pool_verify(POOL_RECORDS);
+    printf("%8u %10u %12.0f %10.2fx %12lu %12lu %12s\n",
+           (unsigned)workers, (unsigned)POOL_RECORDS, POOL_RECORDS / elapsed, POOL_RECORDS / elapsed / sync_rate,
+           (unsigned long)stats.steals, (unsigned long)bad, bad == 0 ? "OK" : "OUT OF ORDER");
+    return bad == 0;
+}
+
+/**
+ * @brief 同步格式化到内存的每秒记录数（工作池的对比基准）
+ */
+static double pool_sync_rate(void)
+{
+    SystemStatus status;
+    char buf[512];
+    StructPrintSink sink;
+    double t0;
+    u32 i;
+
+    memset(&status, 0, sizeof(status));
+    g_out_len = 0;
+    struct_print_sink_init(&sink, buf, sizeof(buf), pool_out, NULL, STRUCT_PRINT_SINK_FLUSH_FULL);
+    t0 = stress_now_s();
+    for (i = 0; i < POOL_RECORDS; i++) {
+        status.timestamp = i;
+        struct_print_to(&sink, "status", &status, &SystemStatus_desc);
+    }
+    return POOL_RECORDS / (stress_now_s() - t0);
+}
+
+int main(void)
+{
+    static const int counts[] = { 1, 2, 4, 8 };
+    double sync_rate;
+    int ok = 1;
+    size_t i;
+
+    g_out_size = (size_t)POOL_RECORDS * 2048;
+    g_out = (char*)malloc(g_out_size);
+    if (g_out == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    printf("多线程打印（SystemStatus，STRUCT_PRINT_THREAD_SAFE=%d，记录缓冲区 %d 字节）\n",
+           STRUCT_PRINT_THREAD_SAFE, STRUCT_PRINT_OUT_BUF_SIZE);
+    printf("%8s %10s %12s %14s %12s %12s\n", "threads", "records", "records/s", "calls/record", "bad", "result");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        ok &= stress_run(counts[i]);
+    }
+
+    sync_rate = pool_sync_rate();
+    printf("\n异步工作池（SystemStatus，单线程提交；同步格式化基准 %.0f 记录/秒）\n", sync_rate);
+    printf("%8s %10s %12s %11s %12s %12s %12s\n", "workers", "records", "records/s", "vs sync", "steals", "bad", "result");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+        ok &= pool_run((u32)counts[i], sync_rate);
+    }
+
+    free(g_out);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file test_structs_desc.h
+ * @brief test_structs.h 的结构体描述符
+ * @note 由 gen_descriptor.py 自动生成，请勿手工修改
+ * @note 使用前需先包含 struct_print.h（定义 STRUCT_PRINT_ENABLE）和 test_structs.h
+ */
+
+#ifndef __TEST_STRUCTS_DESC_H
+#define __TEST_STRUCTS_DESC_H
+
+/* 描述符：stCircuitMqttCmdData */
+BEGIN_STRUCT_DESC(stCircuitMqttCmdData, stCircuitMqttCmdData_desc)
+    FIELD_STRING(stCircuitMqttCmdData, type),
+    FIELD_U8(stCircuitMqttCmdData, ProtocolType),
+    FIELD_STRING(stCircuitMqttCmdData, Imei),
+    FIELD_STRING(stCircuitMqttCmdData, MsgType),
+    FIELD_S32(stCircuitMqttCmdData, MsgData),
+    FIELD_STRING(stCircuitMqttCmdData, MsgDataString),
+    FIELD_U32(stCircuitMqttCmdData, MeterAdr)
+END_STRUCT_DESC(stCircuitMqttCmdData, stCircuitMqttCmdData_desc)
+
+/* 描述符：DeviceInfo */
+BEGIN_STRUCT_DESC(DeviceInfo, DeviceInfo_desc)
+    FIELD_U8(DeviceInfo, device_id),
+    FIELD_U16(DeviceInfo, firmware_version),
+    FIELD_U32(DeviceInfo, serial_number),
+    FIELD_FLOAT(DeviceInfo, temperature),
+    FIELD_DOUBLE(DeviceInfo, voltage)
+END_STRUCT_DESC(DeviceInfo, DeviceInfo_desc)
+
+/* 描述符：SensorData */
+BEGIN_STRUCT_DESC(SensorData, SensorData_desc)
+    FIELD_U16(SensorData, sensor_id),
+    FIELD_S16(SensorData, value),
+    FIELD_U8(SensorData, status)
+END_STRUCT_DESC(SensorData, SensorData_desc)
+
+/* 描述符：SystemStatus */
+BEGIN_STRUCT_DESC(SystemStatus, SystemStatus_desc)
+    FIELD_U32(SystemStatus, timestamp),
+    FIELD_STRUCT(SystemStatus, device, DeviceInfo_desc),
+    FIELD_STRUCT(SystemStatus, sensor, SensorData_desc),
+    FIELD_U8(SystemStatus, error_code)
+END_STRUCT_DESC(SystemStatus, SystemStatus_desc)
+
+/* 描述符：ConfigParams */
+BEGIN_STRUCT_DESC(ConfigParams, ConfigParams_desc)
+    FIELD_U8(ConfigParams, mode),
+    FIELD_U16(ConfigParams, interval),
+    FIELD_U32(ConfigParams, timeout),
+    FIELD_S32(ConfigParams, offset),
+    FIELD_FLOAT(ConfigParams, gain),
+    FIELD_U8(ConfigParams, enable)
+END_STRUCT_DESC(ConfigParams, ConfigParams_desc)
+
+/**
+ * @brief 本文件中全部描述符的列表（用于主机端工具等需要遍历描述符的场景）
+ */
+#define TEST_STRUCTS_DESC_LIST \
+    &stCircuitMqttCmdData_desc, \
+    &DeviceInfo_desc, \
+    &SensorData_desc, \
+    &SystemStatus_desc, \
+    &ConfigParams_desc
+
+#endif /* __TEST_STRUCTS_DESC_H */